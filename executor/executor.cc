@@ -64,14 +64,11 @@ Executor::execute(const Job &job)
   _LOG_DEBUG ("Add to job queue");
 
   Lock lock(m_mutex);
-  bool queueWasEmpty = m_queue.empty ();
   m_queue.push_back(job);
 
-  // notify working threads if the queue was empty
-  if (queueWasEmpty)
-  {
-    m_cond.notify_one ();
-  }
+  // notify a working thread for every job: with several threads, notifying only when the
+  // queue was empty leaves idle threads sleeping while jobs are waiting in the queue
+  m_cond.notify_one ();
 }
 
 int
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "strand.h"
+
+#include <boost/bind.hpp>
+
+Strand::Strand ()
+  : m_scheduled (false)
+{
+}
+
+void
+Strand::execute (const ExecutorPtr &executor, const Job &job)
+{
+  {
+    Lock lock(m_mutex);
+    m_queue.push_back (job);
+    m_executor = executor;
+
+    if (m_scheduled)
+      return; // will be executed by the job that is already draining the queue
+
+    m_scheduled = true;
+  }
+
+  executor->execute (boost::bind (&Strand::run, shared_from_this ()));
+}
+
+int
+Strand::jobQueueSize ()
+{
+  Lock lock(m_mutex);
+  return m_queue.size ();
+}
+
+void
+Strand::run ()
+{
+  for (int i = 0; i < MAX_BATCH; i++)
+    {
+      Job job;
+      {
+        Lock lock(m_mutex);
+        if (m_queue.empty ())
+          {
+            m_scheduled = false;
+            return;
+          }
+
+        job = m_queue.front ();
+        m_queue.pop_front ();
+      }
+
+      job ();
+    }
+
+  // let jobs of other strands run, the rest of the queue is drained later
+  ExecutorPtr executor;
+  {
+    Lock lock(m_mutex);
+    if (m_queue.empty ())
+      {
+        m_scheduled = false;
+        return;
+      }
+    executor = m_executor;
+  }
+  executor->execute (boost::bind (&Strand::run, shared_from_this ()));
+}
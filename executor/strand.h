@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef STRAND_H
+#define STRAND_H
+
+#include "executor.h"
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+
+/* Serial sub-queue of an executor: jobs submitted to the same strand
+ * are executed one at a time and in the submission order, while jobs of
+ * different strands run in parallel on the threads of the executor.
+ *
+ * A strand occupies at most one executor thread at a time, and gives
+ * the thread back after MAX_BATCH jobs, so busy strands do not starve others
+ */
+
+class Strand : public boost::enable_shared_from_this<Strand>, boost::noncopyable
+{
+public:
+  typedef Executor::Job Job;
+
+  static const int MAX_BATCH = 16;
+
+  Strand();
+
+  // execute the job on the executor after all jobs previously submitted to the strand
+  void
+  execute(const ExecutorPtr &executor, const Job &job);
+
+// only for test
+  int
+  jobQueueSize();
+
+private:
+  void
+  run();
+
+private:
+  typedef boost::mutex Mutex;
+  typedef boost::unique_lock<Mutex> Lock;
+
+  std::deque<Job> m_queue;
+  Mutex m_mutex;
+  bool m_scheduled; // a job draining the queue is submitted to the executor
+  ExecutorPtr m_executor;
+};
+
+typedef boost::shared_ptr<Strand> StrandPtr;
+#endif // STRAND_H
@@ -119,11 +119,10 @@ inline TimeInterval Microseconds (int musecs) { return boost::posix_time::micros
 
 inline TimeInterval Seconds (double fractionalSeconds)
 {
-  double seconds, microseconds;
-  seconds = std::modf (fractionalSeconds, &microseconds);
-  microseconds *= 1000000;
+  double seconds, fraction;
+  fraction = std::modf (fractionalSeconds, &seconds);
 
-  return time::Seconds((int)seconds) + time::Microseconds((int)microseconds);
+  return time::Seconds((int)seconds) + time::Microseconds((int)(fraction * 1000000));
 }
 
 inline Time Now () { return boost::posix_time::microsec_clock::universal_time (); }
@@ -11,15 +11,18 @@
 #include "data.h"
 
 #include "wire/ndnb/wire-ndnb-data.h"
+#include "wire/ndnb/ndnb-writer.h"
+#include "wire/iovec-list.h"
+#include "wire/format.h"
 
 #include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/error.h"
 
 #include "logging.h"
 
 INIT_LOGGER ("ndn.Data");
 
 namespace ndn {
-  const int MAGIC_SIGNED_BLOB_OFFSET = 2 + (2 + (2 + (2 + 256) + 1) + 1);
   const int LAST_CLOSER_SIZE = 1;
 
   Data::Data ()
@@ -30,69 +33,279 @@ namespace ndn {
   {
   }
 
+  void
+  Data::setWireFormat (Ptr<const wire::Format> format)
+  {
+    if (format == wire::Format::ndnb ())
+      format.reset ();
+    if (format == m_format)
+      return;
+
+    m_format = format;
+    m_wire.reset ();
+    m_cachedWire.reset ();
+  }
+
+  Ptr<const wire::Format>
+  Data::getWireFormat () const
+  {
+    if (m_format)
+      return m_format;
+    return wire::Format::ndnb ();
+  }
+
   Ptr<Blob>
   Data::encodeToUnsignedWire () const
   {
-    blob_stream blobStream;
-  
-    wire::ndnb::Data::SerializeUnsigned (*this, reinterpret_cast<OutputIterator &> (blobStream));
+    Ptr<const SignedBlob> encoded = m_cachedWire;
+    if (!encoded && m_format)
+      encoded = m_format->encodeData (*this);
+    if (encoded)
+      return Ptr<Blob> (new Blob (encoded->signed_begin (), encoded->signed_end ()));
 
-    return blobStream.buf ();
+    Ptr<Blob> blob = Ptr<Blob>::Create ();
+    blob->resize (wire::ndnb::Writer::EstimateUnsignedData (*this));
+
+    unsigned char *p = reinterpret_cast<unsigned char *> (&(*blob)[0]);
+    wire::ndnb::Writer::AppendUnsignedData (p, *this);
+
+    return blob;
   }
 
-    void
+  void
   Data::encodeToUnsignedWire (std::ostream &os) const
   {
+    Ptr<const SignedBlob> encoded = m_cachedWire;
+    if (!encoded && m_format)
+      encoded = m_format->encodeData (*this);
+    if (encoded)
+      {
+        os.write (encoded->signed_buf (), encoded->signed_size ());
+        return;
+      }
     wire::ndnb::Data::SerializeUnsigned (*this, reinterpret_cast<OutputIterator &> (os));  
   }
 
+  Ptr<SignedBlob>
+  Data::encode () const
+  {
+    if (m_format)
+      return m_format->encodeData (*this);
+
+    Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+    encoded->resize (wire::ndnb::Writer::EstimateData (*this));
+
+    unsigned char *p = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+    wire::ndnb::Writer::AppendData (p, *this);
+
+    // signed portion is followed only by the closer of the ContentObject
+    size_t signedSize = m_wire ? m_wire->signed_size () : wire::ndnb::Writer::EstimateUnsignedData (*this);
+    encoded->setSignedPortion (encoded->size () - LAST_CLOSER_SIZE - signedSize, signedSize);
+    return encoded;
+  }
+
+  Ptr<Blob>
+  Data::encodeToWire ()
+  {
+    if (!m_cachedWire)
+      m_cachedWire = encode ();
+
+    return Ptr<Blob> (new Blob (m_cachedWire->begin (), m_cachedWire->end ()));
+  }
+
   Ptr<Blob>
   Data::encodeToWire () const
   {
-    blob_stream blobStream;
-  
-    wire::ndnb::Data::Serialize (*this, reinterpret_cast<OutputIterator &> (blobStream));
+    Ptr<const SignedBlob> encoded = m_cachedWire;
+    if (!encoded)
+      encoded = encode ();
 
-    return blobStream.buf ();
+    return Ptr<Blob> (new Blob (encoded->begin (), encoded->end ()));
   }
 
   void
   Data::encodeToWire (std::ostream &os) const
   {
+    Ptr<const SignedBlob> encoded = m_cachedWire;
+    if (!encoded && m_format)
+      encoded = m_format->encodeData (*this);
+    if (encoded)
+      {
+        os.write (encoded->buf (), encoded->size ());
+        return;
+      }
     wire::ndnb::Data::Serialize (*this, reinterpret_cast<OutputIterator &> (os));  
   }
+
+  void
+  Data::encodeToWire (wire::IovecList &list) const
+  {
+    if (m_cachedWire)
+      {
+        list.appendReference (m_cachedWire->buf (), m_cachedWire->size ());
+        return;
+      }
+    if (m_format)
+      {
+        Ptr<const SignedBlob> encoded = m_format->encodeData (*this);
+        list.appendReference (encoded->buf (), encoded->size ());
+        list.keepAlive (encoded);
+        return;
+      }
+    wire::ndnb::Data::Serialize (*this, list);
+  }
+
+  void
+  Data::encodeToUnsignedWire (wire::IovecList &list) const
+  {
+    if (m_cachedWire)
+      {
+        list.appendReference (m_cachedWire->signed_buf (), m_cachedWire->signed_size ());
+        return;
+      }
+    if (m_format)
+      {
+        Ptr<const SignedBlob> encoded = m_format->encodeData (*this);
+        list.appendReference (encoded->signed_buf (), encoded->signed_size ());
+        list.keepAlive (encoded);
+        return;
+      }
+    wire::ndnb::Data::SerializeUnsigned (*this, list);
+  }
   
+  void
+  Data::signInPlace (const SignCallback &sign, size_t signatureSize)
+  {
+    Ptr<signature::Sha256WithRsa> signature = DynamicCast<signature::Sha256WithRsa> (m_signature);
+    if (!signature)
+      BOOST_THROW_EXCEPTION (error::Data () << error::msg ("Only Sha256WithRsa signature can be signed in place"));
+
+    m_wire.reset ();
+    m_cachedWire.reset ();
+
+    if (m_format)
+      {
+        signInPlace (m_format, sign, signatureSize, *signature);
+        return;
+      }
+
+    Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+    encoded->resize (wire::ndnb::Writer::EstimateDataForSigning (*this, signatureSize));
+
+    unsigned char *begin = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+    unsigned char *p = begin;
+    unsigned char *signatureBits;
+    unsigned char *signedPortion;
+    wire::ndnb::Writer::AppendDataForSigning (p, *this, signatureSize, signatureBits, signedPortion);
+    encoded->setSignedPortion (signedPortion - begin, p - signedPortion - LAST_CLOSER_SIZE);
+
+    wire::IovecList list;
+    list.appendReference (encoded->signed_buf (), encoded->signed_size ());
+    Ptr<Blob> bits = sign (list);
+    if (!bits)
+      BOOST_THROW_EXCEPTION (error::Data () << error::msg ("Signing failed"));
+
+    signature->setSignatureBits (*bits);
+
+    // reserved space holds max (signatureSize, 16) bytes, shorter bits are padded with zeros
+    size_t reserved = signedPortion - signatureBits - 2; // </SignatureBits></Signature>
+    if (bits->size () > reserved || (bits->size () < reserved && reserved > 16))
+      {
+        _LOG_DEBUG ("Signature (" << bits->size () << " bytes) does not fit reserved " << reserved
+                    << " bytes, data is encoded again");
+        m_cachedWire = encode ();
+        return;
+      }
+
+    if (!bits->empty ())
+      memcpy (signatureBits, bits->buf (), bits->size ());
+    m_cachedWire = encoded;
+  }
+
+  void
+  Data::signInPlace (Ptr<const wire::Format> format, const SignCallback &sign, size_t signatureSize,
+                     signature::Sha256WithRsa &signature)
+  {
+    size_t signatureBits;
+    Ptr<SignedBlob> encoded = format->encodeDataForSigning (*this, signatureSize, signatureBits);
+
+    wire::IovecList list;
+    list.appendReference (encoded->signed_buf (), encoded->signed_size ());
+    Ptr<Blob> bits = sign (list);
+    if (!bits)
+      BOOST_THROW_EXCEPTION (error::Data () << error::msg ("Signing failed"));
+
+    signature.setSignatureBits (*bits);
+
+    // length of the signature is a part of the encoding, bits of another size cannot be patched in
+    if (bits->size () != signatureSize)
+      {
+        _LOG_DEBUG ("Signature (" << bits->size () << " bytes) does not match reserved " << signatureSize
+                    << " bytes, data is encoded again");
+        m_cachedWire = encode ();
+        return;
+      }
+
+    if (!bits->empty ())
+      memcpy (&(*encoded)[signatureBits], bits->buf (), bits->size ());
+    m_cachedWire = encoded;
+  }
+
   Ptr<ndn::Data>
   Data::decodeFromWire (Ptr<const Blob> buffer)
   {
-    boost::iostreams::stream
-      <boost::iostreams::array_source> is (buffer->buf (), buffer->size ());
-
-    Ptr<ndn::Data> data = Create<ndn::Data> ();
-    
-    Ptr<SignedBlob> signedBlob = Ptr<SignedBlob>(new SignedBlob(buffer->buf (), buffer->size ()));
+    return decodeFromWire (buffer->buf (), buffer->size ());
+  }
 
-    signedBlob->setSignedPortion(MAGIC_SIGNED_BLOB_OFFSET, buffer->size() - MAGIC_SIGNED_BLOB_OFFSET - LAST_CLOSER_SIZE);
+  Ptr<ndn::Data>
+  Data::decodeFromWire (const void *buf, size_t length)
+  {
+    Ptr<ndn::Data> data = Ptr<ndn::Data>::Create ();
 
-    data->setSignedBlob(signedBlob);
+    // fields are copied out of the buffer, the receive buffer can be reused right after the call
+    wire::ndnb::Data::Range signedPortion;
+    wire::ndnb::Data::Decode (*data, buf, length, signedPortion);
 
-    data->setSignature(Create<signature::Sha256WithRsa> ());
+    // the only copy of the packet: the signed portion is verified straight from it (whatever the
+    // signature size is), and the packet is re-sent from it as the cached encoding
+    Ptr<SignedBlob> signedBlob = Ptr<SignedBlob> (boost::make_shared<SignedBlob> (buf, length));
+    signedBlob->setSignedPortion(signedPortion.m_offset, signedPortion.m_size);
 
-    wire::ndnb::Data::Deserialize (data, reinterpret_cast<InputIterator &> (is)); // crazy, but safe
+    data->setSignedBlob(signedBlob);
+    data->m_cachedWire = signedBlob;
 
     return data;
   }
   
   Ptr<ndn::Data>
-  Data::decodeFromWire (std::istream &is)
+  Data::decodeFromWire (const void *buf, size_t length, Ptr<const wire::Format> format)
   {
+    if (!format || format == wire::Format::ndnb ())
+      return decodeFromWire (buf, length);
 
-    Ptr<ndn::Data> data = Create<ndn::Data> ();
-    data->setSignature(Create<signature::Sha256WithRsa> ());
+    Ptr<ndn::Data> data = Ptr<ndn::Data>::Create ();
 
-    wire::ndnb::Data::Deserialize (data, reinterpret_cast<InputIterator &> (is)); // crazy, but safe
+    size_t signedOffset;
+    size_t signedSize;
+    format->decodeData (*data, buf, length, signedOffset, signedSize);
+
+    Ptr<SignedBlob> signedBlob = Ptr<SignedBlob> (boost::make_shared<SignedBlob> (buf, length));
+    signedBlob->setSignedPortion (signedOffset, signedSize);
+
+    data->m_format = format;
+    data->setSignedBlob (signedBlob);
+    data->m_cachedWire = signedBlob;
 
     return data;
   }
+  
+  Ptr<ndn::Data>
+  Data::decodeFromWire (std::istream &is)
+  {
+    Blob packet;
+    wire::Format::ndnb ()->readPacket (is, packet);
+
+    return decodeFromWire (packet.buf (), packet.size ());
+  }
 
 } // namespace ndn
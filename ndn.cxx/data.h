@@ -20,12 +20,32 @@
 
 namespace ndn {
 
+namespace wire { class IovecList; class Format; }
+namespace signature { class Sha256WithRsa; }
+
 /**
  * @brief Class implementing abstractions to work with NDN Data packets
+ *
+ * Data keeps the most recent complete wire encoding (created by signInPlace, the non-const
+ * encodeToWire, or received by decodeFromWire), so repeated encodings and re-sends of unchanged
+ * data are served from it.  Const methods only read the cached encoding and never fill it, so
+ * the same Data can be encoded by several threads at once.
+ *
+ * The cached encoding is dropped by setName, setContent, setSignature, and setWireFormat.
+ * Modifications through the references returned by the accessors (getName, getContent,
+ * content, getSignature) are not tracked, and resetWire should be called after them.
+ *
+ * Data is encoded in NDNB, unless another wire format is set with setWireFormat (data decoded
+ * from NDN-TLV keeps the format it came in).
  */
 class Data
 {
 public:
+  /**
+   * @brief Callback producing signature bits for the signed portion of the encoded data
+   */
+  typedef boost::function<Ptr<Blob> (const wire::IovecList &signedPortion)> SignCallback;
+
   /**
    * @brief Create an empty Data with empty payload
    **/
@@ -145,40 +165,142 @@ public:
     return m_wire;
   }
 
+  /**
+   * @brief Drop the cached encoding (e.g., after a field is modified through getContent)
+   */
+  inline void
+  resetWire ();
+
   ///////////////////////////////////////////////////////////////////////
   //                         Wire format                               //
   ///////////////////////////////////////////////////////////////////////
 
+  /**
+   * @brief Set wire format data is encoded and signed in (NDNB by default)
+   *
+   * If the format changes, the cached encoding and the signed blob are dropped, as the signed
+   * portion in another format is different (i.e., data should be signed again)
+   */
+  void
+  setWireFormat (Ptr<const wire::Format> format);
+
+  /**
+   * @brief Get wire format of the data
+   */
+  Ptr<const wire::Format>
+  getWireFormat () const;
+
+  /**
+   * @brief Encode unsigned portion of data (taken from the cached encoding, if there is one)
+   *
+   * The encoding is not cached, as signature bits are usually set right after signing the
+   * unsigned portion.
+   */
   Ptr<Blob>
   encodeToUnsignedWire () const;
 
   void
   encodeToUnsignedWire (std::ostream &os) const;
 
+  /**
+   * @brief Encode data, the encoding is cached in the data
+   *
+   * The returned blob is a copy of the cached encoding and can be freely modified
+   */
+  Ptr<Blob>
+  encodeToWire ();
+
+  /**
+   * @brief Encode data (taken from the cached encoding, if there is one, but never cached)
+   */
   Ptr<Blob>
   encodeToWire () const;
 
   void
   encodeToWire (std::ostream &os) const;
+
+  /**
+   * @brief Encode data into the list of buffers without copying payload and signature bits
+   *
+   * The list references memory owned by this Data, so the Data should not be modified or
+   * destroyed while the list is used (see wire::IovecList::keepAlive).  If data has the cached
+   * encoding, the list references only it.
+   */
+  void
+  encodeToWire (wire::IovecList &list) const;
+
+  /**
+   * @brief Encode unsigned portion of data into the list of buffers without copying payload
+   *        (same lifetime requirements as for encodeToWire (wire::IovecList &))
+   */
+  void
+  encodeToUnsignedWire (wire::IovecList &list) const;
+
+  /**
+   * @brief Sign data and encode it in one serialization pass
+   *
+   * Data is serialized once into the final buffer, with signatureSize bytes reserved for the
+   * signature bits.  The signed portion is signed in place (sign gets a reference to it, not a
+   * copy), and the resulting bits are patched into the reserved space and set in the signature.
+   * The buffer becomes the cached encoding of the data, so the following encodeToWire calls
+   * are served from it.  If the bits do not fit the reserved space, data is encoded again.
+   *
+   * Signature of the data should already be set (Sha256WithRsa with KeyLocator and publisher
+   * key digest), its signature bits are ignored.  Signed blob of the data is reset.
+   */
+  void
+  signInPlace (const SignCallback &sign, size_t signatureSize);
   
   static Ptr<ndn::Data>
   decodeFromWire (Ptr<const Blob> blob);
+
+  /**
+   * @brief Decode data directly from the receive buffer
+   *
+   * The only copy of the packet is the signed blob kept by the decoded data.  Its signed portion
+   * is located by the decoder (any signature size), so the verifier hashes it in place, and the
+   * blob is also the cached encoding of the data (see encodeToWire)
+   */
+  static Ptr<ndn::Data>
+  decodeFromWire (const void *buf, size_t length);
   
+  /**
+   * @brief Decode data in the specific wire format (same as decodeFromWire (buf, length) for NDNB)
+   *
+   * Decoded data keeps the format, so it is re-encoded in the same format
+   */
+  static Ptr<ndn::Data>
+  decodeFromWire (const void *buf, size_t length, Ptr<const wire::Format> format);
+
+  /**
+   * @brief Read exactly one NDNB-encoded data packet from the stream and decode it
+   */
   static Ptr<ndn::Data>
   decodeFromWire (std::istream &is);
   
+private:
+  Ptr<SignedBlob>
+  encode () const;
+
+  void
+  signInPlace (Ptr<const wire::Format> format, const SignCallback &sign, size_t signatureSize,
+               signature::Sha256WithRsa &signature);
+
 private:
   Name m_name;
   Ptr<Signature> m_signature; // signature with its parameters "binds" name and content
   Content m_content;
 
-  Ptr<SignedBlob> m_wire;  
+  Ptr<SignedBlob> m_wire;
+  Ptr<SignedBlob> m_cachedWire; // complete encoding, signed portion points inside
+  Ptr<const wire::Format> m_format; // not set for NDNB, which is encoded without virtual calls
 };
 
 inline Data &
 Data::setName (const Name &name)
 {
   m_name = name;
+  m_cachedWire.reset ();
   return *this;
 }
 
@@ -210,6 +332,7 @@ inline void
 Data::setSignature (Ptr<Signature> signature)
 {
   m_signature = signature;
+  m_cachedWire.reset ();
 }
 
 inline const Content &
@@ -228,6 +351,7 @@ inline void
 Data::setContent (const Content &content)
 {
   m_content = content;
+  m_cachedWire.reset ();
 }
 
 inline const Blob &
@@ -242,6 +366,12 @@ Data::content ()
   return getContent ().getContent ();
 }
 
+inline void
+Data::resetWire ()
+{
+  m_cachedWire.reset ();
+}
+
 } // namespace ndn
 
 #endif // NDN_DATA_H
@@ -46,8 +46,11 @@ struct Component       : public virtual boost::exception, public virtual std::ex
 }
 struct Exclude         : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with Exclude
 struct KeyLocator      : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with KeyLocator
+struct Data            : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with Data
 namespace wire {
 struct Ndnb            : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with wire::Ndnb encoding
+struct Tlv             : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with NDN-TLV encoding
+struct Framer          : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with framing of the packet stream (see wire::Framer)
 }
 struct Keychain        : public virtual boost::exception, public virtual std::exception {}; ///< @brief An error with security::Keychain
 
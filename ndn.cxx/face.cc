@@ -17,14 +17,10 @@ Face::sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallbac
 {
   // magic to be done in child class
 
-  sent_interest item = m_sentInterests.find_exact (interest->getName ());
+  sent_interest item = m_sentInterests.try_insert (interest->getName ()).first;
   if (item == m_sentInterests.end ())
-    {
-      std::pair<sent_interest, bool> insertRes =
-        m_sentInterests.insert (interest->getName (), Ptr<sent_interest_container::payload_traits::payload_type>::Create ());
+    return item;
 
-      item = insertRes.first;
-    }
   item->payload ()->push_back (dataCallback);
 
   return item;
@@ -41,14 +37,10 @@ Face::setInterestFilter (Ptr<const Name> prefix, const ExpectedInterestCallback
 {
   // magic to be done in child class
   
-  registered_prefix item = m_registeredPrefixes.find_exact (*prefix);
+  registered_prefix item = m_registeredPrefixes.try_insert (*prefix).first;
   if (item == m_registeredPrefixes.end ())
-    {
-      std::pair<registered_prefix, bool> insertRes =
-        m_registeredPrefixes.insert (*prefix, Ptr<registered_prefix_container::payload_traits::payload_type>::Create ());
+    return item;
 
-      item = insertRes.first;
-    }
   item->payload ()->push_back (interestCallback);
 
   return item;
@@ -44,23 +44,26 @@ public:
 
   typedef sent_interest_container::iterator sent_interest;
   typedef registered_prefix_container::iterator registered_prefix;
+
+  virtual
+  ~Face () { }
   
-  sent_interest
+  virtual sent_interest
   sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallback &dataCallback);
 
-  void
+  virtual void
   clearInterest (sent_interest interest);
   
-  registered_prefix
+  virtual registered_prefix
   setInterestFilter (Ptr<const Name> prefix, const ExpectedInterestCallback &interestCallback);
 
-  void
+  virtual void
   clearInterestFilter (const Name &prefix);
 
-  void
+  virtual void
   clearInterestFilter (registered_prefix filter);
   
-private:
+protected:
   sent_interest_container m_sentInterests;
   registered_prefix_container m_registeredPrefixes;
 };
@@ -19,6 +19,7 @@ const TimeInterval Content::noFreshness;
 const TimeInterval Content::maxFreshness = time::Seconds (2147);
 
 Content::Content ()
+  : m_type (DATA)
 {
 }
 
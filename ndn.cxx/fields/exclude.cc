@@ -151,6 +151,18 @@ Exclude::excludeAfter (const name::Component &from)
   return *this;
 }
 
+void
+Exclude::appendExclude (const name::Component &name, bool any)
+{
+  // components on the wire are in ascending order, so every new term is the largest one
+  if (!m_exclude.empty () && !(name > m_exclude.begin ()->first))
+    BOOST_THROW_EXCEPTION (error::Exclude ()
+                           << error::msg ("Exclude components should be in ascending order")
+                           << error::msg (name.toUri ()));
+
+  m_exclude.insert (std::make_pair (name, any));
+}
+
 
 std::ostream&
 operator << (std::ostream &os, const Exclude &exclude)
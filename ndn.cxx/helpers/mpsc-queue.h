@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_MPSC_QUEUE_H
+#define NDN_MPSC_QUEUE_H
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace ndn
+{
+
+/**
+ * @brief Lock-free multi-producer single-consumer queue
+ *
+ * Producers push items onto an intrusive stack using compare-and-swap.  The consumer takes
+ * the whole stack with one atomic exchange and reverses it, so items are consumed in batches
+ * and in the order they have been pushed.  Because single items are never popped, the queue
+ * is not subject to the ABA problem.
+ */
+template<class T>
+class MpscQueue : boost::noncopyable
+{
+public:
+  MpscQueue ()
+    : m_head (0)
+    , m_remaining (0)
+  {
+  }
+
+  ~MpscQueue ()
+  {
+    std::vector<T> items;
+    popAll (items);
+  }
+
+  /**
+   * @brief Push item to the queue (can be called from any thread)
+   * @returns true if the queue was empty, i.e., the consumer may need to be woken up
+   */
+  bool
+  push (const T &item)
+  {
+    Node *node = new Node (item);
+    Node *head;
+    do
+      {
+        head = m_head;
+        node->m_next = head;
+      }
+    while (!__sync_bool_compare_and_swap (&m_head, head, node));
+
+    return head == 0;
+  }
+
+  /**
+   * @brief Call function for every queued item in the order items have been pushed, and remove
+   *        the items from the queue (should be called only from the consumer thread)
+   * @returns number of items
+   *
+   * If function throws, the item it has been called for is removed and the exception is
+   * propagated; the remaining items of the batch stay in the queue and are consumed first by
+   * the next call.
+   */
+  template<class Function>
+  size_t
+  consumeAll (Function function)
+  {
+    Node *node = __sync_lock_test_and_set (&m_head, static_cast<Node *> (0));
+
+    // reverse the stack to restore the push order
+    Node *reversed = 0;
+    while (node != 0)
+      {
+        Node *next = node->m_next;
+        node->m_next = reversed;
+        reversed = node;
+        node = next;
+      }
+
+    if (m_remaining != 0)
+      {
+        Node *last = m_remaining;
+        while (last->m_next != 0)
+          last = last->m_next;
+        last->m_next = reversed;
+        reversed = m_remaining;
+        m_remaining = 0;
+      }
+
+    size_t count = 0;
+    while (reversed != 0)
+      {
+        Node *next = reversed->m_next;
+        try
+          {
+            function (reversed->m_item);
+          }
+        catch (...)
+          {
+            delete reversed;
+            m_remaining = next;
+            throw;
+          }
+        delete reversed;
+        reversed = next;
+        count ++;
+      }
+    return count;
+  }
+
+  /**
+   * @brief Move all queued items to the end of the container (should be called only from the consumer thread)
+   * @returns number of items
+   */
+  template<class Container>
+  size_t
+  popAll (Container &items)
+  {
+    return consumeAll (Appender<Container> (items));
+  }
+
+  /**
+   * @brief Check if the queue is empty (the result may be outdated by the time it is returned)
+   */
+  bool
+  empty () const
+  {
+    return m_head == 0 && m_remaining == 0;
+  }
+
+private:
+  template<class Container>
+  struct Appender
+  {
+    Appender (Container &items) : m_items (items) { }
+
+    void
+    operator () (const T &item)
+    {
+      m_items.push_back (item);
+    }
+
+    Container &m_items;
+  };
+
+  struct Node
+  {
+    Node (const T &item) : m_item (item), m_next (0) { }
+
+    T m_item;
+    Node *m_next;
+  };
+
+  Node * volatile m_head;
+  Node *m_remaining; // items of a batch left after an exception, accessed only by the consumer
+};
+
+} // ndn
+
+#endif // NDN_MPSC_QUEUE_H
@@ -11,8 +11,11 @@
  */
 
 #include "interest.h"
+#include "data.h"
 #include <boost/lexical_cast.hpp>
 #include "wire/ndnb/wire-ndnb-interest.h"
+#include "wire/ndnb/ndnb-writer.h"
+#include "wire/format.h"
 
 using namespace std;
 
@@ -51,10 +54,37 @@ Interest::Interest (const Interest &other)
   m_interestLifetime = other.m_interestLifetime;
   m_scope = other.m_scope;
   m_childSelector = other.m_childSelector;
+  m_exclude = other.m_exclude;
   m_publisherPublicKeyDigest = other.m_publisherPublicKeyDigest;
 }
 
 
+bool
+Interest::matchesData (const Data &data) const
+{
+  const Name &dataName = data.getName ();
+  if (dataName.size () < m_name.size ())
+    return false;
+
+  for (int i = 0; i < static_cast<int> (m_name.size ()); i++)
+    {
+      if (dataName.get (i) != m_name.get (i))
+        return false;
+    }
+
+  // +1 for the implicit digest component
+  uint32_t suffixComponents = dataName.size () - m_name.size () + 1;
+  if (m_minSuffixComponents != ncomps && suffixComponents < m_minSuffixComponents)
+    return false;
+  if (m_maxSuffixComponents != ncomps && suffixComponents > m_maxSuffixComponents)
+    return false;
+
+  if (dataName.size () > m_name.size () && m_exclude.isExcluded (dataName.get (static_cast<int> (m_name.size ()))))
+    return false;
+
+  return true;
+}
+
   /*
    * !!!
    * Interest::Interest (const ndn_parsed_interest *pi) is for temporary use, should be removed!!
@@ -109,11 +139,13 @@ Interest::operator == (const Interest &other)
 Ptr<Blob>
 Interest::encodeToWire ()
 {
-  blob_stream blobStream;
-  
-  wire::ndnb::Interest::Serialize (*this, reinterpret_cast<OutputIterator &> (blobStream));
+  Ptr<Blob> blob = Ptr<Blob>::Create ();
+  blob->resize (wire::ndnb::Writer::EstimateInterest (*this));
 
-  return blobStream.buf ();
+  unsigned char *p = reinterpret_cast<unsigned char *> (&(*blob)[0]);
+  wire::ndnb::Writer::AppendInterest (p, *this);
+
+  return blob;
 }
 
 void
@@ -125,11 +157,14 @@ Interest::encodeToWire (std::ostream &os)
 Ptr<ndn::Interest>
 Interest::decodeFromWire (Ptr<const Blob> buffer)
 {
-  boost::iostreams::stream
-    <boost::iostreams::array_source> is (buffer->buf (), buffer->size ());
+  return decodeFromWire (buffer->buf (), buffer->size ());
+}
 
-  Ptr<ndn::Interest> interest = Create<ndn::Interest> ();
-  wire::ndnb::Interest::Deserialize (interest, reinterpret_cast<InputIterator &> (is)); // crazy, but safe
+Ptr<ndn::Interest>
+Interest::decodeFromWire (const void *buf, size_t length)
+{
+  Ptr<ndn::Interest> interest = Ptr<ndn::Interest>::Create ();
+  wire::ndnb::Interest::Decode (*interest, buf, length);
 
   return interest;
 }
@@ -137,10 +172,10 @@ Interest::decodeFromWire (Ptr<const Blob> buffer)
 Ptr<ndn::Interest>
 Interest::decodeFromWire (std::istream &is)
 {
-  Ptr<ndn::Interest> interest = Create<ndn::Interest> ();
-  wire::ndnb::Interest::Deserialize (interest, reinterpret_cast<InputIterator &> (is)); // crazy, but safe
+  Blob packet;
+  wire::Format::ndnb ()->readPacket (is, packet);
 
-  return interest;
+  return decodeFromWire (packet.buf (), packet.size ());
 }
 
 
@@ -20,6 +20,8 @@
 
 namespace ndn {
 
+class Data;
+
 /**
  * @brief Class abstracting operations with Interests (constructing and getting access to Interest fields)
  */
@@ -278,6 +280,17 @@ public:
   bool
   operator== (const Interest &interest);
 
+  /**
+   * @brief Check if the data can be returned for the interest
+   *
+   * Name of the interest should be a prefix of the data name, and the data name should satisfy
+   * MinSuffixComponents, MaxSuffixComponents, and Exclude (the implicit digest component counts
+   * as the last component of the data name, as in ndnd, but it is not checked against Exclude).
+   * ChildSelector and AnswerOriginKind only choose among matching data and are not checked.
+   */
+  bool
+  matchesData (const Data &data) const;
+
   ///////////////////////////////////////////////////////////////////////
   //                         Wire format                               //
   ///////////////////////////////////////////////////////////////////////
@@ -290,7 +303,16 @@ public:
   
   static Ptr<ndn::Interest>
   decodeFromWire (Ptr<const Blob> blob);
-  
+
+  /**
+   * @brief Decode interest directly from the receive buffer (buffer is not copied)
+   */
+  static Ptr<ndn::Interest>
+  decodeFromWire (const void *buf, size_t length);
+
+  /**
+   * @brief Read exactly one NDNB-encoded interest from the stream and decode it
+   */
   static Ptr<ndn::Interest>
   decodeFromWire (std::istream &is);
   
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "lazy-data.h"
+
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/wire/ndnb/ndnb-parser/common.h"
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.LazyData");
+
+namespace ndn {
+
+LazyData::LazyData (Ptr<SignedBlob> wire)
+  : m_wire (wire)
+{
+  index ();
+}
+
+LazyData::LazyData (const void *buf, size_t length)
+  : m_wire (new SignedBlob (buf, length))
+{
+  index ();
+}
+
+void
+LazyData::index ()
+{
+  m_decoded = 0;
+  m_data = Ptr<Data>::Create ();
+  m_signature = Ptr<signature::Sha256WithRsa>::Create ();
+  m_data->setSignature (m_signature);
+
+  if (m_wire->empty ())
+    throw wire::NdnbParser::NdnbDecodingException ();
+
+  wire::ndnb::Data::Scan (m_layout, m_wire->buf (), m_wire->size ());
+  m_wire->setSignedPortion (m_layout.m_signedPortion.m_offset, m_layout.m_signedPortion.m_size);
+}
+
+const Name &
+LazyData::getName () const
+{
+  if (!(m_decoded & NAME))
+    {
+      if (m_layout.m_name.m_size > 0)
+        {
+          // decoded into a temporary, so a failed attempt does not leave partial name behind
+          Name name;
+          wire::ndnb::Data::DecodeName (name, at (m_layout.m_name), m_layout.m_name.m_size);
+          m_data->setName (name);
+        }
+      m_decoded |= NAME;
+    }
+  return m_data->getName ();
+}
+
+void
+LazyData::decodeSignedInfo () const
+{
+  if (m_decoded & SIGNED_INFO)
+    return;
+
+  m_signature->getSignatureBits ().assign (at (m_layout.m_signatureBits),
+                                           at (m_layout.m_signatureBits) + m_layout.m_signatureBits.m_size);
+  if (m_layout.m_signedInfo.m_size > 0)
+    {
+      wire::ndnb::Data::DecodeSignedInfo (*m_data, *m_signature,
+                                          at (m_layout.m_signedInfo), m_layout.m_signedInfo.m_size);
+    }
+  m_decoded |= SIGNED_INFO;
+}
+
+void
+LazyData::decodeKeyLocator () const
+{
+  if (m_decoded & KEY_LOCATOR)
+    return;
+
+  if (m_layout.m_keyLocator.m_size > 0)
+    {
+      KeyLocator keyLocator;
+      wire::ndnb::Data::DecodeKeyLocator (keyLocator, at (m_layout.m_keyLocator), m_layout.m_keyLocator.m_size);
+      m_signature->getKeyLocator () = keyLocator;
+    }
+  m_decoded |= KEY_LOCATOR;
+}
+
+void
+LazyData::decodeContent () const
+{
+  if (m_decoded & CONTENT)
+    return;
+
+  m_data->getContent ().setContent (contentBuf (), contentSize ());
+  m_decoded |= CONTENT;
+}
+
+const Content &
+LazyData::getContent () const
+{
+  decodeSignedInfo ();
+  decodeContent ();
+  return m_data->getContent ();
+}
+
+Ptr<const Signature>
+LazyData::getSignature () const
+{
+  decodeSignedInfo ();
+  decodeKeyLocator ();
+  return m_signature;
+}
+
+const KeyLocator &
+LazyData::getKeyLocator () const
+{
+  decodeKeyLocator ();
+  return m_signature->getKeyLocator ();
+}
+
+Ptr<Data>
+LazyData::toData () const
+{
+  Ptr<Data> data = Ptr<Data>::Create ();
+  data->setName (getName ());
+  data->setContent (getContent ());
+  getSignature ();
+  data->setSignature (Ptr<signature::Sha256WithRsa> (new signature::Sha256WithRsa (*m_signature)));
+  data->setSignedBlob (m_wire);
+
+  _LOG_TRACE ("Fully decoded " << getName ());
+  return data;
+}
+
+} // namespace ndn
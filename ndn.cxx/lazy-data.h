@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_LAZY_DATA_H
+#define NDN_LAZY_DATA_H
+
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/wire/ndnb/wire-ndnb-data.h"
+
+namespace ndn {
+
+namespace signature { class Sha256WithRsa; }
+
+/**
+ * @brief Read-only view of the encoded Data packet, decoding fields on first access
+ *
+ * The constructor records positions of the fields in one pass over the wire (see
+ * wire::ndnb::Data::Scan), and nothing is decoded until requested.  Name, SignedInfo (content
+ * info, publisher key digest, and signature bits), KeyLocator, and Content are decoded
+ * independently on first access.  Content bytes and the wire itself are available without any
+ * decoding, so Data can be inspected or forwarded untouched:
+ *
+ * @code
+ * LazyData data (blob);
+ * if (prefix.isPrefixOf (data.getName ()))
+ *   transport->send (data.getWire ()->buf (), data.getWire ()->size ());
+ * @endcode
+ *
+ * The wire is the source of truth and is never modified.  Decoded fields are cached inside the
+ * object, so LazyData should not be accessed from several threads without synchronization.
+ *
+ * Only NDNB-encoded packets are supported.  Wrapper does not use LazyData for incoming data, as
+ * matching against selectors, verification and closures need fully decoded Data anyway.
+ */
+class LazyData
+{
+public:
+  /**
+   * @brief Index the Data packet, the blob is shared (not copied)
+   *
+   * Signed portion of the blob is set to the one of the packet.  The blob should not be
+   * modified afterwards.
+   *
+   * @throws wire::NdnbParser::NdnbDecodingException if the wire is truncated or malformed
+   */
+  LazyData (Ptr<SignedBlob> wire);
+
+  /**
+   * @brief Index the Data packet, the buffer is copied once
+   * @throws wire::NdnbParser::NdnbDecodingException if the wire is truncated or malformed
+   */
+  LazyData (const void *buf, size_t length);
+
+  /**
+   * @brief Get the original wire of the Data packet
+   */
+  inline Ptr<const Blob>
+  getWire () const;
+
+  /**
+   * @brief Get name of the data packet (decoded on first access)
+   */
+  const Name &
+  getName () const;
+
+  /**
+   * @brief Get content object (SignedInfo and content decoded on first access)
+   */
+  const Content &
+  getContent () const;
+
+  /**
+   * @brief Get signature object (SignedInfo and KeyLocator decoded on first access)
+   */
+  Ptr<const Signature>
+  getSignature () const;
+
+  /**
+   * @brief Get KeyLocator of the signature (decoded on first access, SignedInfo is not decoded)
+   */
+  const KeyLocator &
+  getKeyLocator () const;
+
+  /**
+   * @brief Get pointer to the content bytes inside the wire (nothing is decoded)
+   */
+  inline const char *
+  contentBuf () const;
+
+  /**
+   * @brief Get size of the content bytes (nothing is decoded)
+   */
+  inline size_t
+  contentSize () const;
+
+  /**
+   * @brief Get fully decoded Data packet
+   *
+   * Every call returns a new Data, which can be modified independently of this view.  Its
+   * signed blob is the wire of this view (shared, not copied), so the signature can be
+   * verified without re-encoding.
+   */
+  Ptr<Data>
+  toData () const;
+
+private:
+  void
+  index ();
+
+  void
+  decodeSignedInfo () const;
+
+  void
+  decodeContent () const;
+
+  void
+  decodeKeyLocator () const;
+
+  inline const char *
+  at (const wire::ndnb::Data::Range &range) const;
+
+private:
+  enum
+    {
+      NAME = 1,
+      SIGNED_INFO = 2,
+      KEY_LOCATOR = 4,
+      CONTENT = 8
+    };
+
+  Ptr<SignedBlob> m_wire;
+  wire::ndnb::Data::Layout m_layout;
+
+  mutable int m_decoded;
+  Ptr<Data> m_data;
+  Ptr<signature::Sha256WithRsa> m_signature;
+};
+
+inline Ptr<const Blob>
+LazyData::getWire () const
+{
+  return m_wire;
+}
+
+inline const char *
+LazyData::at (const wire::ndnb::Data::Range &range) const
+{
+  return m_wire->buf () + range.m_offset;
+}
+
+inline const char *
+LazyData::contentBuf () const
+{
+  return at (m_layout.m_content);
+}
+
+inline size_t
+LazyData::contentSize () const
+{
+  return m_layout.m_content.m_size;
+}
+
+} // namespace ndn
+
+#endif // NDN_LAZY_DATA_H
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "loopback-face.h"
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.LoopbackFace");
+
+using namespace std;
+using namespace boost;
+
+namespace ndn {
+
+const double LoopbackFace::DEFAULT_INTEREST_LIFETIME = 4.0;
+
+LoopbackFace::LoopbackFace (SchedulerPtr scheduler/* = SchedulerPtr ()*/)
+  : m_scheduler (scheduler)
+  , m_ownScheduler (false)
+  , m_lastGeneration (0)
+{
+  if (m_scheduler == 0)
+    {
+      m_scheduler = make_shared<Scheduler> ();
+      m_scheduler->start ();
+      m_ownScheduler = true;
+    }
+}
+
+LoopbackFace::~LoopbackFace ()
+{
+  {
+    ScopedLock lock (m_mutex);
+    for (map<sent_interest, PendingInterest>::iterator pending = m_pending.begin ();
+         pending != m_pending.end ();
+         pending ++)
+      {
+        m_scheduler->deleteTask (pending->second.m_expiryTag);
+      }
+    m_pending.clear ();
+  }
+
+  if (m_ownScheduler)
+    {
+      m_scheduler->shutdown ();
+    }
+}
+
+Face::sent_interest
+LoopbackFace::sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallback &dataCallback)
+{
+  return sendInterest (interest, dataCallback, TimeoutCallback ());
+}
+
+Face::sent_interest
+LoopbackFace::sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallback &dataCallback,
+                            const TimeoutCallback &timeoutCallback)
+{
+  _LOG_TRACE ("<< I " << interest->getName ());
+
+  list<ExpectedInterestCallback> producers;
+  sent_interest item;
+  {
+    ScopedLock lock (m_mutex);
+
+    // interest is bound to the callback, so it will be reported back exactly as it was sent
+    item = Face::sendInterest (interest, bind (dataCallback, _1, interest));
+    if (item == m_sentInterests.end ())
+      return item;
+
+    PendingInterest &pending = m_pending[item];
+    if (!timeoutCallback.empty ())
+      {
+        pending.m_timeoutCallbacks.push_back (bind (timeoutCallback, interest));
+      }
+
+    // (re-)schedule expiration of the entry
+    if (!pending.m_expiryTag.empty ())
+      {
+        m_scheduler->deleteTask (pending.m_expiryTag);
+      }
+    pending.m_generation = ++m_lastGeneration;
+    pending.m_expiryTag = "loopback-face-" + lexical_cast<string> (this) + "-" + lexical_cast<string> (pending.m_generation);
+
+    double lifetime = DEFAULT_INTEREST_LIFETIME;
+    if (!interest->getInterestLifetime ().is_negative ())
+      {
+        lifetime = interest->getInterestLifetime ().total_microseconds () / 1000000.0;
+      }
+
+    Scheduler::scheduleOneTimeTask (m_scheduler, lifetime,
+                                    bind (&LoopbackFace::onTimeout, this, interest->getName (), pending.m_generation),
+                                    pending.m_expiryTag);
+
+    registered_prefix producer = m_registeredPrefixes.longest_prefix_match (interest->getName ());
+    if (producer != m_registeredPrefixes.end ())
+      {
+        producers = *producer->payload ();
+      }
+  }
+
+  if (producers.empty ())
+    {
+      _LOG_DEBUG ("No producer for " << interest->getName ());
+    }
+
+  BOOST_FOREACH (const ExpectedInterestCallback &producer, producers)
+    {
+      // prefix is bound to the callback in setInterestFilter
+      producer (Ptr<Interest> (new Interest (*interest)), Ptr<const Name> ());
+    }
+
+  return item;
+}
+
+void
+LoopbackFace::clearInterest (sent_interest interest)
+{
+  ScopedLock lock (m_mutex);
+  if (interest == m_sentInterests.end ())
+    return;
+
+  clearPending (interest);
+  Face::clearInterest (interest);
+}
+
+Face::registered_prefix
+LoopbackFace::setInterestFilter (Ptr<const Name> prefix, const ExpectedInterestCallback &interestCallback)
+{
+  ScopedLock lock (m_mutex);
+  return Face::setInterestFilter (prefix, bind (interestCallback, _1, prefix));
+}
+
+void
+LoopbackFace::clearInterestFilter (const Name &prefix)
+{
+  ScopedLock lock (m_mutex);
+  Face::clearInterestFilter (prefix);
+}
+
+void
+LoopbackFace::clearInterestFilter (registered_prefix filter)
+{
+  ScopedLock lock (m_mutex);
+  Face::clearInterestFilter (filter);
+}
+
+size_t
+LoopbackFace::put (Ptr<Data> data)
+{
+  _LOG_TRACE (">> D " << data->getName ());
+
+  list<SatisfiedInterestCallback> consumers;
+  size_t satisfied = 0;
+  {
+    ScopedLock lock (m_mutex);
+
+    sent_interest item = m_sentInterests.longest_prefix_match (data->getName ());
+    while (item != m_sentInterests.end ())
+      {
+        consumers.splice (consumers.end (), *item->payload ());
+        clearPending (item);
+        Face::clearInterest (item);
+        satisfied ++;
+
+        item = m_sentInterests.longest_prefix_match (data->getName ());
+      }
+  }
+
+  BOOST_FOREACH (const SatisfiedInterestCallback &consumer, consumers)
+    {
+      // interest is bound to the callback in sendInterest
+      consumer (data, Ptr<const Interest> ());
+    }
+
+  return satisfied;
+}
+
+void
+LoopbackFace::onTimeout (const Name &name, uint32_t generation)
+{
+  list< function<void ()> > timeouts;
+  {
+    ScopedLock lock (m_mutex);
+
+    sent_interest item = m_sentInterests.find_exact (name);
+    if (item == m_sentInterests.end ())
+      return;
+
+    map<sent_interest, PendingInterest>::iterator pending = m_pending.find (item);
+    if (pending == m_pending.end () || pending->second.m_generation != generation)
+      return; // interest has been satisfied or refreshed in the meantime
+
+    _LOG_TRACE ("Interest expired: " << name);
+    timeouts.swap (pending->second.m_timeoutCallbacks);
+    m_pending.erase (pending);
+    Face::clearInterest (item);
+  }
+
+  BOOST_FOREACH (const function<void ()> &timeout, timeouts)
+    {
+      timeout ();
+    }
+}
+
+void
+LoopbackFace::clearPending (sent_interest interest)
+{
+  map<sent_interest, PendingInterest>::iterator pending = m_pending.find (interest);
+  if (pending == m_pending.end ())
+    return;
+
+  m_scheduler->deleteTask (pending->second.m_expiryTag);
+  m_pending.erase (pending);
+}
+
+} // ndn
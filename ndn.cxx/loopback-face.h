@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_LOOPBACK_FACE_H
+#define NDN_LOOPBACK_FACE_H
+
+#include "ndn.cxx/face.h"
+#include "scheduler/scheduler.h"
+
+#include <boost/thread/recursive_mutex.hpp>
+#include <map>
+
+namespace ndn {
+
+/**
+ * @brief In-process forwarder
+ *
+ * Interests sent through the face are dispatched (using longest prefix match) to callbacks
+ * registered with setInterestFilter, and Data put into the face satisfies all pending
+ * Interests whose names are prefixes of the Data name.  Pending Interests expire after
+ * their lifetime (or DEFAULT_INTEREST_LIFETIME), which is tracked with the Scheduler.
+ *
+ * Only names are used for matching, selectors are ignored.  Callbacks are never called while
+ * the internal lock is held, so producers can put Data directly from the interest callback.
+ */
+class LoopbackFace : public Face
+{
+public:
+  typedef boost::function<void (Ptr<const Interest> timedOutInterest)> TimeoutCallback;
+
+  /**
+   * @brief Interest lifetime used when Interest does not specify one (4 seconds, same as ndnd)
+   */
+  static const double DEFAULT_INTEREST_LIFETIME;
+
+  /**
+   * @brief Create loopback face
+   * @param scheduler scheduler to track Interest lifetimes.  If not set, the face creates and runs its own scheduler
+   */
+  LoopbackFace (SchedulerPtr scheduler = SchedulerPtr ());
+
+  virtual
+  ~LoopbackFace ();
+
+  virtual sent_interest
+  sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallback &dataCallback);
+
+  /**
+   * @brief Send Interest and get notified when it is satisfied or expired
+   * @param interest Interest to send
+   * @param dataCallback callback to call when Data satisfies the Interest
+   * @param timeoutCallback callback to call when Interest expires without being satisfied
+   */
+  sent_interest
+  sendInterest (Ptr<const Interest> interest, const SatisfiedInterestCallback &dataCallback,
+                const TimeoutCallback &timeoutCallback);
+
+  virtual void
+  clearInterest (sent_interest interest);
+
+  virtual registered_prefix
+  setInterestFilter (Ptr<const Name> prefix, const ExpectedInterestCallback &interestCallback);
+
+  virtual void
+  clearInterestFilter (const Name &prefix);
+
+  virtual void
+  clearInterestFilter (registered_prefix filter);
+
+  /**
+   * @brief Satisfy pending Interests with the Data
+   * @param data Data packet
+   * @returns number of pending Interest entries that have been satisfied
+   */
+  size_t
+  put (Ptr<Data> data);
+
+private:
+  void
+  onTimeout (const Name &name, uint32_t generation);
+
+  void
+  clearPending (sent_interest interest);
+
+private:
+  struct PendingInterest
+  {
+    Task::Tag m_expiryTag;
+    uint32_t m_generation;
+    std::list< boost::function<void ()> > m_timeoutCallbacks;
+  };
+
+  typedef boost::recursive_mutex Mutex;
+  typedef boost::unique_lock<Mutex> ScopedLock;
+
+  Mutex m_mutex;
+  SchedulerPtr m_scheduler;
+  bool m_ownScheduler;
+  uint32_t m_lastGeneration;
+  std::map<sent_interest, PendingInterest> m_pending;
+};
+
+} // ndn
+
+#endif // NDN_LOOPBACK_FACE_H
@@ -83,9 +83,9 @@ namespace security
   CREATE INDEX subject ON Certificate(identity_name);          \n \
   ";
 
-  BasicIdentityStorage::BasicIdentityStorage()
+  BasicIdentityStorage::BasicIdentityStorage(const string & dir)
   {
-    fs::path identityDir = fs::path(getenv("HOME")) / ".ndnx";
+    fs::path identityDir = dir.empty() ? fs::path(getenv("HOME")) / ".ndnx" : fs::path(dir);
     fs::create_directories (identityDir);
     
     int res = sqlite3_open((identityDir / "ndnsec-identity.db").c_str (), &m_db);
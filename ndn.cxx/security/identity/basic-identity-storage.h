@@ -30,8 +30,9 @@ namespace security
   public:
     /**
      * @brief constructor
+     * @param dir directory of the identity database, ~/.ndnx if empty
      */
-    BasicIdentityStorage();
+    BasicIdentityStorage(const std::string & dir = "");
 
     /**
      * @brief destructor
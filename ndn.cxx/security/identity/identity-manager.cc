@@ -14,6 +14,7 @@
 #include "ndn.cxx/fields/signature-sha256-with-rsa.h"
 
 #include "ndn.cxx/security/exception.h"
+#include "ndn.cxx/wire/iovec-list.h"
 
 #include "basic-identity-storage.h"
 
@@ -25,6 +26,7 @@
 
 #include <ctime>
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
 #include <fstream>
 
 
@@ -41,6 +43,9 @@ namespace ndn
 
 namespace security
 {
+  // signature of RSA key of the default size (2048 bits), other signatures are encoded again
+  const size_t RESERVED_SIGNATURE_SIZE = 256;
+
   IdentityManager::IdentityManager()
   {
     m_publicStorage = Ptr<BasicIdentityStorage>::Create();
@@ -312,17 +317,10 @@ namespace security
     
     data.setSignature(sha256Sig);
 
-    Ptr<Blob> unsignedData = data.encodeToUnsignedWire();
-    Ptr<SignedBlob> signedBlobPtr = Ptr<SignedBlob>(new SignedBlob(unsignedData->buf(), unsignedData->size()));
-    signedBlobPtr->setSignedPortion(0, unsignedData->size());
-    data.setSignedBlob(signedBlobPtr);
-
-    // DERendec endec;
-    // endec.printBlob(*unsignedData, "");
-    
-    Ptr<Blob> sigBits = m_privateStorage->sign (*unsignedData, keyName);
-
-    sha256Sig->setSignatureBits(*sigBits);
+    // data is encoded once: the signed portion is hashed in the final buffer and the signature
+    // bits are patched into it, the buffer is then sent as the cached encoding of the data
+    Ptr<Blob> (PrivatekeyStorage::*signList) (const wire::IovecList &, const Name &, DigestAlgorithm) = &PrivatekeyStorage::sign;
+    data.signInPlace (boost::bind (signList, m_privateStorage, _1, keyName, DIGEST_SHA256), RESERVED_SIGNATURE_SIZE);
   }
 
   Ptr<IdentityCertificate>
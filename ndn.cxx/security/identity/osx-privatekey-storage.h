@@ -66,6 +66,9 @@ namespace security
      */
     virtual Ptr<Blob> 
     sign(const Blob & pData, const Name & keyName, DigestAlgorithm digestAlgo = DIGEST_SHA256);
+
+    // signing of the list of buffers falls back to the default implementation (buffers are copied)
+    using PrivatekeyStorage::sign;
     
     /**
      * @brief decrypt data
@@ -19,6 +19,7 @@
 #include "ndn.cxx/common.h"
 #include "ndn.cxx/data.h"
 #include "ndn.cxx/fields/blob.h"
+#include "ndn.cxx/wire/iovec-list.h"
 
 
 namespace ndn
@@ -67,6 +68,23 @@ namespace security
      */
     virtual Ptr<Blob> 
     sign(const Blob & blob, const Name & keyName, DigestAlgorithm digestAlgo = DIGEST_SHA256) = 0;
+
+    /**
+     * @brief sign data encoded as a list of buffers
+     *
+     * The default implementation copies the buffers into a single blob, storages should
+     * override it to hash the buffers in place
+     *
+     * @param list the list of buffers to be signed
+     * @param keyName the name of the signing key
+     * @param digestAlgo the digest algorithm
+     * @returns signature, NULL if signing fails
+     */
+    virtual Ptr<Blob>
+    sign(const wire::IovecList & list, const Name & keyName, DigestAlgorithm digestAlgo = DIGEST_SHA256)
+    {
+      return sign(*list.flatten(), keyName, digestAlgo);
+    }
     
     /**
      * @brief decrypt data
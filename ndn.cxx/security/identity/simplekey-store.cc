@@ -132,6 +132,23 @@ SimpleKeyStore::getPublickey(const Name & keyName)
  */
 Ptr<Blob>
 SimpleKeyStore::sign(const Blob & pData, const Name & keyName, DigestAlgorithm digestAlgo)
+{
+  wire::IovecList list;
+  if (!pData.empty())
+    list.appendReference(pData.buf(), pData.size());
+
+  return sign(list, keyName, digestAlgo);
+}
+
+/**
+ * @brief sign data encoded as a list of buffers
+ * @param list the list of buffers, each of them is fed to the signature accumulator in place
+ * @param keyName the name of the signing key
+ * @param digestAlgo the digest algorithm
+ * @returns signature, NULL if signing fails
+ */
+Ptr<Blob>
+SimpleKeyStore::sign(const wire::IovecList & list, const Name & keyName, DigestAlgorithm digestAlgo)
 {
   string keyURI = keyName.toUri();
   if  (!SimpleKeyStore::doesKeyExist(keyName, KEY_CLASS_PRIVATE))
@@ -142,7 +159,6 @@ SimpleKeyStore::sign(const Blob & pData, const Name & keyName, DigestAlgorithm d
   try
     {
       AutoSeededRandomPool rng;
-      string strContents = string(pData.buf(),pData.size());
       //Read private key
       CryptoPP::ByteQueue bytes;
       string privateKeyName = SimpleKeyStore::nameTransform(keyURI, ".pri");
@@ -155,11 +171,17 @@ SimpleKeyStore::sign(const Blob & pData, const Name & keyName, DigestAlgorithm d
       if (digestAlgo == DIGEST_SHA256)
         {
           RSASS<PKCS1v15, SHA256>::Signer signer(privateKey);
-          size_t length = signer.MaxSignatureLength();
-          SecByteBlock signature(length);
-          signer.SignMessage(rng, (const byte*) strContents.c_str(),
-                             strContents.length(), signature);
-          Ptr<Blob> ret = Ptr<Blob>(new Blob(signature, signature.size()));
+          PK_MessageAccumulator *accumulator = signer.NewSignatureAccumulator(rng);
+
+          const std::vector<iovec> &buffers = list.getIovec();
+          for (std::vector<iovec>::const_iterator i = buffers.begin(); i != buffers.end(); i++)
+            {
+              accumulator->Update(reinterpret_cast<const byte*>(i->iov_base), i->iov_len);
+            }
+
+          SecByteBlock signature(signer.MaxSignatureLength());
+          size_t length = signer.Sign(rng, accumulator, signature); // accumulator is deleted by Sign
+          Ptr<Blob> ret = Ptr<Blob>(new Blob(signature, length));
           return ret;
         }
     }
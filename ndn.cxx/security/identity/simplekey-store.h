@@ -47,6 +47,12 @@ public:
   virtual Ptr<Blob>
   sign(const Blob & pData, const Name & keyName, DigestAlgorithm digestAlgo = DIGEST_SHA256);
 
+  /**
+   * @brief sign data encoded as a list of buffers, the buffers are hashed in place
+   */
+  virtual Ptr<Blob>
+  sign(const wire::IovecList & list, const Name & keyName, DigestAlgorithm digestAlgo = DIGEST_SHA256);
+
   /**
    * @brief decrypt data
    * @param keyName the name of the decrypting key
@@ -59,7 +59,21 @@ namespace security
   {
     using namespace CryptoPP;
 
-    Blob unsignedData(data.getSignedBlob()->signed_buf(), data.getSignedBlob()->signed_size());
+    // data signed locally does not keep its unsigned wire, which is encoded again in this case
+    Ptr<const Blob> encodedData;
+    const char *unsignedBuf = 0;
+    size_t unsignedSize = 0;
+    if (data.getSignedBlob() != NULL)
+      {
+        unsignedBuf = data.getSignedBlob()->signed_buf();
+        unsignedSize = data.getSignedBlob()->signed_size();
+      }
+    else
+      {
+        encodedData = data.encodeToUnsignedWire();
+        unsignedBuf = encodedData->buf();
+        unsignedSize = encodedData->size();
+      }
     bool result = false;
     
     DigestAlgorithm digestAlg = DIGEST_SHA256; //For temporary, should be assigned by Signature.getAlgorithm();
@@ -78,7 +92,7 @@ namespace security
             const Blob & sigBits = sigPtr->getSignatureBits();
 
             RSASS<PKCS1v15, SHA256>::Verifier verifier (pubKey);
-            result = verifier.VerifyMessage((const byte*) unsignedData.buf(), unsignedData.size(), (const byte*)sigBits.buf(), sigBits.size());            
+            result = verifier.VerifyMessage((const byte*) unsignedBuf, unsignedSize, (const byte*)sigBits.buf(), sigBits.size());            
             _LOG_DEBUG("Signature verified? " << data.getName() << " " << boolalpha << result);
             
           }
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "ndnx-transport.h"
+
+#include "ndn.cxx/wrapper/charbuf.h"
+#include "ndn.cxx/wire/ndnb/ndnb-writer.h"
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.NdnxTransport");
+
+typedef boost::error_info<struct tag_errmsg, std::string> errmsg_info_str;
+
+namespace ndn {
+
+/**
+ * @brief Encode name in NDNB directly into the charbuf
+ */
+static void
+appendName (Charbuf &charbuf, const Name &name)
+{
+  size_t size = wire::ndnb::Writer::EstimateName (name);
+  unsigned char *p = ndn_charbuf_reserve (charbuf.getBuf (), size);
+  wire::ndnb::Writer::AppendName (p, name);
+  charbuf.getBuf ()->length += size;
+}
+
+static ndn_upcall_res
+incomingPacket (ndn_closure *selfp,
+                ndn_upcall_kind kind,
+                ndn_upcall_info *info)
+{
+  NdnxTransport *transport = reinterpret_cast<NdnxTransport *> (selfp->data);
+
+  switch (kind)
+    {
+    case NDN_UPCALL_FINAL:
+      delete selfp;
+      return NDN_UPCALL_RESULT_OK;
+
+    case NDN_UPCALL_INTEREST:
+      transport->onReceive (info->interest_ndnb, info->pi->offset[NDN_PI_E]);
+      // all filters are served by the same receive callback, other filters should not get the same interest
+      return NDN_UPCALL_RESULT_INTEREST_CONSUMED;
+
+    case NDN_UPCALL_CONTENT:
+    case NDN_UPCALL_CONTENT_BAD:          // intentionally unsigned packets (in Encapsulation case)
+    case NDN_UPCALL_CONTENT_UNVERIFIED:
+      transport->onReceive (info->content_ndnb, info->pco->offset[NDN_PCO_E]);
+      return NDN_UPCALL_RESULT_OK;
+
+    case NDN_UPCALL_INTEREST_TIMED_OUT:   // expiration is handled by the user of the transport
+    default:
+      return NDN_UPCALL_RESULT_OK;
+    }
+}
+
+NdnxTransport::NdnxTransport ()
+  : m_handle (0)
+  , m_connected (false)
+{
+}
+
+NdnxTransport::~NdnxTransport ()
+{
+  disconnect ();
+  if (m_handle != 0)
+    {
+      ndn_destroy (&m_handle); // will finalize all closures
+    }
+}
+
+void
+NdnxTransport::connect (const ReceiveCallback &receiveCallback)
+{
+  if (m_handle == 0)
+    {
+      m_handle = ndn_create ();
+    }
+  else if (m_connected)
+    {
+      disconnect ();
+    }
+
+  m_receiveCallback = receiveCallback;
+  if (ndn_connect (m_handle, NULL) < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("connection to ndnd failed"));
+    }
+  m_connected = true;
+}
+
+void
+NdnxTransport::disconnect ()
+{
+  if (!m_connected)
+    return;
+
+  ndn_disconnect (m_handle);
+  m_connected = false;
+}
+
+void
+NdnxTransport::send (const unsigned char *buf, size_t length)
+{
+  if (!m_connected)
+    return;
+
+  ndn_parsed_interest pi;
+  if (ndn_parse_interest (buf, length, &pi, NULL) >= 0)
+    {
+      // name is taken from the interest, the rest of the interest is used as a template
+      Charbuf name (buf + pi.offset[NDN_PI_B_Name], pi.offset[NDN_PI_E_Name] - pi.offset[NDN_PI_B_Name]);
+      Charbuf interestTemplate (buf, length);
+
+      ndn_closure *dataClosure = new ndn_closure;
+      dataClosure->data = this;
+      dataClosure->p = &incomingPacket;
+
+      if (ndn_express_interest (m_handle, name.getBuf (), dataClosure, interestTemplate.getBuf ()) < 0)
+        {
+          _LOG_ERROR ("ndn_express_interest failed");
+        }
+    }
+  else
+    {
+      if (ndn_put (m_handle, buf, length) < 0)
+        {
+          _LOG_ERROR ("ndn_put failed");
+        }
+    }
+}
+
+void
+NdnxTransport::registerPrefix (const Name &prefix)
+{
+  if (!m_connected)
+    return;
+
+  ndn_closure *interestClosure = new ndn_closure;
+  interestClosure->data = this;
+  interestClosure->p = &incomingPacket;
+
+  Charbuf prefixName;
+  appendName (prefixName, prefix);
+
+  if (ndn_set_interest_filter (m_handle, prefixName.getBuf (), interestClosure) < 0)
+    {
+      _LOG_ERROR ("ndn_set_interest_filter failed for " << prefix);
+    }
+}
+
+void
+NdnxTransport::unregisterPrefix (const Name &prefix)
+{
+  if (!m_connected)
+    return;
+
+  Charbuf prefixName;
+  appendName (prefixName, prefix);
+
+  ndn_set_interest_filter (m_handle, prefixName.getBuf (), 0);
+}
+
+int
+NdnxTransport::getFd () const
+{
+  if (!m_connected)
+    return -1;
+
+  return ndn_get_connection_fd (m_handle);
+}
+
+bool
+NdnxTransport::isOutputPending () const
+{
+  return m_connected && ndn_output_is_pending (m_handle);
+}
+
+void
+NdnxTransport::processEvents ()
+{
+  if (!m_connected)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("not connected to ndnd"));
+    }
+
+  int res = ndn_run (m_handle, 0);
+  if (res < 0)
+    {
+      _LOG_ERROR ("ndn_run returned negative status: " << res);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("ndn_run returned error (probably ndnd got stopped)"));
+    }
+}
+
+void
+NdnxTransport::onReceive (const unsigned char *buf, size_t length)
+{
+  if (!m_receiveCallback.empty ())
+    {
+      m_receiveCallback (buf, length);
+    }
+}
+
+} // ndn
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_NDNX_TRANSPORT_H
+#define NDN_NDNX_TRANSPORT_H
+
+#include "transport.h"
+
+namespace ndn {
+
+/**
+ * @brief Transport over libndnx connection to ndnd (default transport of Wrapper)
+ *
+ * Interests are expressed with ndn_express_interest (the Name and selectors are taken from
+ * the wire-encoded Interest), any other packet is sent with ndn_put.  Expiration of Interests
+ * is left to the user of the transport, libndnx upcalls about timeouts are ignored.
+ */
+class NdnxTransport : public Transport
+{
+public:
+  NdnxTransport ();
+
+  virtual
+  ~NdnxTransport ();
+
+  virtual void
+  connect (const ReceiveCallback &receiveCallback);
+
+  virtual void
+  disconnect ();
+
+  virtual void
+  send (const unsigned char *buf, size_t length);
+
+  // ndn_put copies the packet into the output buffer of the library anyway, so lists of
+  // buffers are simply flattened by the default implementation
+  using Transport::send;
+
+  virtual void
+  registerPrefix (const Name &prefix);
+
+  virtual void
+  unregisterPrefix (const Name &prefix);
+
+  virtual int
+  getFd () const;
+
+  virtual bool
+  isOutputPending () const;
+
+  virtual void
+  processEvents ();
+
+  /// @cond include_hidden
+  void
+  onReceive (const unsigned char *buf, size_t length);
+  /// @endcond
+
+private:
+  ndn_client *m_handle;
+  bool m_connected;
+  ReceiveCallback m_receiveCallback;
+};
+
+} // ndn
+
+#endif // NDN_NDNX_TRANSPORT_H
@@ -0,0 +1,587 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "shm-transport.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.ShmTransport");
+
+typedef boost::error_info<struct tag_errmsg, std::string> errmsg_info_str;
+
+using namespace std;
+
+namespace ndn {
+
+const size_t ShmTransport::DEFAULT_RING_SIZE = 1024 * 1024;
+
+static const uint32_t SEGMENT_MAGIC = 0x4e444e52; // "NDNR"
+static const uint32_t WRAP_MARKER = 0xffffffff;   // rest of the ring is skipped
+static const size_t RECORD_HEADER_SIZE = 8;       // records start at 8-byte boundary
+static const size_t MIN_RING_SIZE = 4096;
+
+/**
+ * @brief Header of the segment, followed by two rings
+ */
+struct SegmentHeader
+{
+  uint32_t m_magic;
+  uint32_t m_reserved;
+  uint64_t m_ringSize;
+  char m_pad[48];
+};
+
+/**
+ * @brief Header of a ring, followed by m_ringSize bytes of records (32-bit length, payload)
+ *
+ * Positions only grow, producer owns m_head, consumer owns m_tail.  Each side sets the
+ * "waiting" flag before going to sleep, and the other side signals the eventfd only if it
+ * has cleared the flag.
+ */
+struct ShmTransport::Ring
+{
+  volatile uint64_t m_head;
+  char m_pad1[56];
+  volatile uint64_t m_tail;
+  char m_pad2[56];
+  volatile uint32_t m_consumerWaiting;
+  volatile uint32_t m_producerWaiting;
+  volatile uint32_t m_closed;
+  char m_pad3[52];
+
+  char *
+  data ()
+  {
+    return reinterpret_cast<char *> (this + 1);
+  }
+};
+
+static inline size_t
+recordSize (size_t length)
+{
+  return (RECORD_HEADER_SIZE + length + RECORD_HEADER_SIZE - 1) & ~(RECORD_HEADER_SIZE - 1);
+}
+
+static void
+closeFds (int *fds, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    {
+      if (fds[i] >= 0)
+        close (fds[i]);
+    }
+}
+
+void
+ShmTransport::createSegment (size_t ringSize, int fds[3])
+{
+  size_t size = MIN_RING_SIZE;
+  while (size < ringSize)
+    size *= 2;
+
+  size_t segmentSize = sizeof (SegmentHeader) + 2 * (sizeof (Ring) + size);
+
+  fds[0] = memfd_create ("ndn-shm-transport", 0);
+  fds[1] = eventfd (0, EFD_NONBLOCK);
+  fds[2] = eventfd (0, EFD_NONBLOCK);
+  if (fds[0] < 0 || fds[1] < 0 || fds[2] < 0 || ftruncate (fds[0], segmentSize) < 0)
+    {
+      closeFds (fds, 3);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot create shared memory segment"));
+    }
+
+  void *segment = mmap (0, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+  if (segment == MAP_FAILED)
+    {
+      closeFds (fds, 3);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot map shared memory segment"));
+    }
+
+  // rings are zeroed by ftruncate, both consumers wait for the first packet
+  SegmentHeader *header = reinterpret_cast<SegmentHeader *> (segment);
+  Ring *first = reinterpret_cast<Ring *> (header + 1);
+  Ring *second = reinterpret_cast<Ring *> (first->data () + size);
+  first->m_consumerWaiting = 1;
+  second->m_consumerWaiting = 1;
+  header->m_ringSize = size;
+  header->m_magic = SEGMENT_MAGIC;
+  munmap (segment, segmentSize);
+}
+
+void
+ShmTransport::createPair (Ptr<ShmTransport> &first, Ptr<ShmTransport> &second, size_t ringSize/* = DEFAULT_RING_SIZE*/)
+{
+  int fds[3];
+  createSegment (ringSize, fds);
+
+  int peerFds[3] = { dup (fds[0]), dup (fds[1]), dup (fds[2]) };
+  try
+    {
+      first = Ptr<ShmTransport> (new ShmTransport (fds[0], fds[1], fds[2], 0));
+    }
+  catch (...)
+    {
+      // descriptors of the first transport are closed by its constructor, but not the duplicates
+      closeFds (peerFds, 3);
+      throw;
+    }
+  second = Ptr<ShmTransport> (new ShmTransport (peerFds[0], peerFds[2], peerFds[1], 1));
+}
+
+static int
+createSocket (const std::string &socketPath, sockaddr_un &addr)
+{
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  if (socketPath.size () >= sizeof (addr.sun_path))
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("socket path is too long: " + socketPath));
+    }
+  strncpy (addr.sun_path, socketPath.c_str (), sizeof (addr.sun_path) - 1);
+
+  int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot create socket"));
+    }
+  return fd;
+}
+
+Ptr<ShmTransport>
+ShmTransport::accept (const std::string &socketPath, size_t ringSize/* = DEFAULT_RING_SIZE*/, int timeoutMs/* = -1*/)
+{
+  sockaddr_un addr;
+  int listener = createSocket (socketPath, addr);
+
+  unlink (socketPath.c_str ());
+  if (bind (listener, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)) < 0 || listen (listener, 1) < 0)
+    {
+      close (listener);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot listen on " + socketPath));
+    }
+
+  pollfd fd = { listener, POLLIN, 0 };
+  int peer = poll (&fd, 1, timeoutMs) == 1 ? ::accept (listener, 0, 0) : -1;
+  close (listener);
+  unlink (socketPath.c_str ());
+  if (peer < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("no peer attached to " + socketPath));
+    }
+
+  int fds[3];
+  try
+    {
+      createSegment (ringSize, fds);
+    }
+  catch (Error::ndnOperation &e)
+    {
+      close (peer);
+      throw;
+    }
+
+  // descriptors of the segment and both eventfds are passed to the peer, which becomes side 1
+  char byte = 0;
+  iovec buffer = { &byte, 1 };
+  union { char m_buf[CMSG_SPACE (sizeof (fds))]; cmsghdr m_align; } control;
+  memset (&control, 0, sizeof (control));
+
+  msghdr message;
+  memset (&message, 0, sizeof (message));
+  message.msg_iov = &buffer;
+  message.msg_iovlen = 1;
+  message.msg_control = control.m_buf;
+  message.msg_controllen = sizeof (control.m_buf);
+
+  cmsghdr *cmsg = CMSG_FIRSTHDR (&message);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (fds));
+  memcpy (CMSG_DATA (cmsg), fds, sizeof (fds));
+
+  ssize_t sent = sendmsg (peer, &message, 0);
+  close (peer);
+  if (sent != 1)
+    {
+      closeFds (fds, 3);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot pass shared memory segment to the peer"));
+    }
+
+  return Ptr<ShmTransport> (new ShmTransport (fds[0], fds[1], fds[2], 0));
+}
+
+Ptr<ShmTransport>
+ShmTransport::attach (const std::string &socketPath)
+{
+  sockaddr_un addr;
+  int peer = createSocket (socketPath, addr);
+  if (::connect (peer, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)) < 0)
+    {
+      close (peer);
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("connection to " + socketPath + " failed"));
+    }
+
+  int fds[3] = { -1, -1, -1 };
+  char byte;
+  iovec buffer = { &byte, 1 };
+  union { char m_buf[CMSG_SPACE (sizeof (fds))]; cmsghdr m_align; } control;
+
+  msghdr message;
+  memset (&message, 0, sizeof (message));
+  message.msg_iov = &buffer;
+  message.msg_iovlen = 1;
+  message.msg_control = control.m_buf;
+  message.msg_controllen = sizeof (control.m_buf);
+
+  ssize_t received = recvmsg (peer, &message, 0);
+  close (peer);
+
+  cmsghdr *cmsg = received >= 0 ? CMSG_FIRSTHDR (&message) : 0;
+  if (received != 1 || cmsg == 0 || cmsg->cmsg_level != SOL_SOCKET ||
+      cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN (sizeof (fds)))
+    {
+      // descriptors may have been installed even though the message is not the expected one
+      for (; cmsg != 0; cmsg = CMSG_NXTHDR (&message, cmsg))
+        {
+          if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len < CMSG_LEN (0))
+            continue;
+
+          size_t count = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+          for (size_t i = 0; i < count; i++)
+            {
+              int fd;
+              memcpy (&fd, CMSG_DATA (cmsg) + i * sizeof (int), sizeof (fd));
+              closeFds (&fd, 1);
+            }
+        }
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("shared memory segment has not been received from " + socketPath));
+    }
+  memcpy (fds, CMSG_DATA (cmsg), sizeof (fds));
+
+  return Ptr<ShmTransport> (new ShmTransport (fds[0], fds[2], fds[1], 1));
+}
+
+ShmTransport::ShmTransport (int segmentFd, int notifyFd, int peerNotifyFd, int side)
+  : m_segmentFd (segmentFd)
+  , m_notifyFd (notifyFd)
+  , m_peerNotifyFd (peerNotifyFd)
+  , m_epollFd (-1)
+  , m_segment (MAP_FAILED)
+  , m_segmentSize (0)
+  , m_ringSize (0)
+  , m_out (0)
+  , m_in (0)
+  , m_connected (false)
+{
+  SegmentHeader header;
+  if (pread (m_segmentFd, &header, sizeof (header), 0) != sizeof (header) ||
+      header.m_magic != SEGMENT_MAGIC || header.m_ringSize < MIN_RING_SIZE)
+    {
+      disconnect ();
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("invalid shared memory segment"));
+    }
+
+  m_ringSize = header.m_ringSize;
+  m_segmentSize = sizeof (SegmentHeader) + 2 * (sizeof (Ring) + m_ringSize);
+  m_segment = mmap (0, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_segmentFd, 0);
+  m_epollFd = epoll_create (1);
+
+  epoll_event event;
+  memset (&event, 0, sizeof (event));
+  event.events = EPOLLIN;
+  if (m_segment == MAP_FAILED || m_epollFd < 0 || epoll_ctl (m_epollFd, EPOLL_CTL_ADD, m_notifyFd, &event) < 0)
+    {
+      disconnect ();
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot map shared memory segment"));
+    }
+
+  Ring *first = reinterpret_cast<Ring *> (reinterpret_cast<char *> (m_segment) + sizeof (SegmentHeader));
+  Ring *second = reinterpret_cast<Ring *> (first->data () + m_ringSize);
+  m_out = side == 0 ? first : second;
+  m_in = side == 0 ? second : first;
+  m_connected = true;
+}
+
+ShmTransport::~ShmTransport ()
+{
+  disconnect ();
+}
+
+void
+ShmTransport::connect (const ReceiveCallback &receiveCallback)
+{
+  if (!m_connected || m_in->m_closed)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("shared memory transport is closed"));
+    }
+
+  m_receiveCallback = receiveCallback;
+}
+
+void
+ShmTransport::disconnect ()
+{
+  if (m_connected)
+    {
+      m_out->m_closed = 1;
+      m_in->m_closed = 1;
+      signalPeer ();
+      m_connected = false;
+    }
+
+  if (m_segment != MAP_FAILED)
+    munmap (m_segment, m_segmentSize);
+  m_segment = MAP_FAILED;
+  m_out = m_in = 0;
+
+  int fds[4] = { m_segmentFd, m_notifyFd, m_peerNotifyFd, m_epollFd };
+  closeFds (fds, 4);
+  m_segmentFd = m_notifyFd = m_peerNotifyFd = m_epollFd = -1;
+
+  m_outputQueue.clear ();
+}
+
+void
+ShmTransport::send (const unsigned char *buf, size_t length)
+{
+  if (!m_connected)
+    return;
+
+  iovec buffer = { const_cast<unsigned char *> (buf), length };
+  if (m_outputQueue.empty () && write (&buffer, 1, length))
+    return;
+
+  Ptr<wire::IovecList> packet = Create<wire::IovecList> ();
+  packet->appendCopy (buf, length);
+  m_outputQueue.push_back (packet);
+}
+
+void
+ShmTransport::send (Ptr<const wire::IovecList> packet)
+{
+  if (!m_connected)
+    return;
+
+  if (m_outputQueue.empty () && write (*packet))
+    return;
+
+  m_outputQueue.push_back (packet);
+}
+
+void
+ShmTransport::registerPrefix (const Name &prefix)
+{
+  // there is no forwarder, the peer gets all interests
+}
+
+void
+ShmTransport::unregisterPrefix (const Name &prefix)
+{
+}
+
+int
+ShmTransport::getFd () const
+{
+  return m_epollFd;
+}
+
+bool
+ShmTransport::isOutputPending () const
+{
+  // epoll descriptor never polls writable, the peer signals when there is space in the ring
+  return !m_outputQueue.empty ();
+}
+
+void
+ShmTransport::processEvents ()
+{
+  if (!m_connected)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("not connected"));
+    }
+
+  uint64_t counter;
+  while (::read (m_notifyFd, &counter, sizeof (counter)) > 0)
+    ;
+
+  flush ();
+  receive ();
+
+  if (m_in->m_closed)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("connection closed by the peer"));
+    }
+}
+
+bool
+ShmTransport::write (const iovec *buffers, size_t count, size_t length)
+{
+  if (recordSize (length) > m_ringSize / 2)
+    {
+      _LOG_ERROR ("Packet of " << length << " bytes is too large for the ring, dropping");
+      return true;
+    }
+
+  uint64_t head = m_out->m_head;
+  size_t offset = head & (m_ringSize - 1);
+  size_t required = recordSize (length);
+  if (offset + required > m_ringSize)
+    required += m_ringSize - offset; // record does not fit before the end of the ring
+
+  if (m_ringSize - (head - m_out->m_tail) < required)
+    {
+      // ask the peer to signal when it frees space, in case it has done that just now check once again
+      m_out->m_producerWaiting = 1;
+      __sync_synchronize ();
+      if (m_ringSize - (head - m_out->m_tail) < required)
+        return false;
+      m_out->m_producerWaiting = 0;
+    }
+  __sync_synchronize (); // payload is not written before the consumer has released the space
+
+  char *data = m_out->data ();
+  if (offset + recordSize (length) > m_ringSize)
+    {
+      *reinterpret_cast<uint32_t *> (data + offset) = WRAP_MARKER;
+      head += m_ringSize - offset;
+      offset = 0;
+    }
+
+  *reinterpret_cast<uint32_t *> (data + offset) = length;
+  char *payload = data + offset + RECORD_HEADER_SIZE;
+  for (size_t i = 0; i < count; i++)
+    {
+      memcpy (payload, buffers[i].iov_base, buffers[i].iov_len);
+      payload += buffers[i].iov_len;
+    }
+
+  __sync_synchronize (); // record is complete before it is published
+  m_out->m_head = head + recordSize (length);
+  __sync_synchronize ();
+
+  if (__sync_bool_compare_and_swap (&m_out->m_consumerWaiting, 1, 0))
+    signalPeer ();
+
+  return true;
+}
+
+bool
+ShmTransport::write (const wire::IovecList &packet)
+{
+  const std::vector<iovec> &buffers = packet.getIovec ();
+  return write (buffers.empty () ? 0 : &buffers[0], buffers.size (), packet.size ());
+}
+
+void
+ShmTransport::flush ()
+{
+  while (!m_outputQueue.empty () && write (*m_outputQueue.front ()))
+    {
+      m_outputQueue.pop_front ();
+    }
+}
+
+void
+ShmTransport::receive ()
+{
+  while (true)
+    {
+      m_in->m_consumerWaiting = 0;
+
+      uint64_t tail = m_in->m_tail;
+      uint64_t head = m_in->m_head;
+      __sync_synchronize (); // records are read only after the head that publishes them
+
+      bool released = false;
+      while (tail != head)
+        {
+          size_t offset = tail & (m_ringSize - 1);
+          uint32_t length = *reinterpret_cast<const uint32_t *> (m_in->data () + offset);
+          if (length == WRAP_MARKER)
+            {
+              if (m_ringSize - offset > head - tail)
+                {
+                  BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("corrupted shared memory ring"));
+                }
+              tail += m_ringSize - offset;
+              continue;
+            }
+          if (recordSize (length) > m_ringSize / 2 || offset + recordSize (length) > m_ringSize ||
+              recordSize (length) > head - tail)
+            {
+              BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("corrupted shared memory ring"));
+            }
+
+          // packet is passed straight from the ring, its space is released after the callback
+          try
+            {
+              if (!m_receiveCallback.empty ())
+                m_receiveCallback (reinterpret_cast<const unsigned char *> (m_in->data () + offset + RECORD_HEADER_SIZE), length);
+            }
+          catch (...)
+            {
+              // the record is released anyways, otherwise the same packet would be delivered again and again
+              if (m_connected)
+                release (tail + recordSize (length));
+              throw;
+            }
+
+          if (!m_connected)
+            return; // disconnected from the callback
+
+          tail += recordSize (length);
+          __sync_synchronize ();
+          m_in->m_tail = tail;
+          released = true;
+        }
+
+      if (released)
+        release (tail);
+
+      // going to sleep, the peer will signal the next packet
+      m_in->m_consumerWaiting = 1;
+      __sync_synchronize ();
+      if (m_in->m_head == tail)
+        break;
+    }
+}
+
+void
+ShmTransport::release (uint64_t tail)
+{
+  __sync_synchronize (); // records are read before their space is given back
+  m_in->m_tail = tail;
+  __sync_synchronize ();
+  if (__sync_bool_compare_and_swap (&m_in->m_producerWaiting, 1, 0))
+    signalPeer ();
+}
+
+void
+ShmTransport::signalPeer ()
+{
+  uint64_t one = 1;
+  if (::write (m_peerNotifyFd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+    {
+      _LOG_ERROR ("Cannot signal the peer");
+    }
+}
+
+} // ndn
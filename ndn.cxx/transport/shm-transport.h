@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_SHM_TRANSPORT_H
+#define NDN_SHM_TRANSPORT_H
+
+#include "transport.h"
+
+#include <deque>
+
+namespace ndn {
+
+/**
+ * @brief Transport between two processes (or two wrappers) on the same host over a pair of
+ *        single-producer single-consumer rings in a shared memory segment, without a forwarder
+ *
+ * Every packet is copied once into the ring of the sender and is passed to the receive
+ * callback of the peer directly from the ring.  Each side waits on its own eventfd, which the
+ * peer signals only when the side has drained its ring (or is waiting for space in the
+ * ring of the peer), so a stream of packets does not take a system call per packet.
+ *
+ * The peer gets all Interests (registerPrefix and unregisterPrefix do nothing), Interests
+ * that do not match any filter of the peer wrapper are dropped by the wrapper.  A transport
+ * cannot be reconnected after disconnect () or after the peer has disconnected.
+ *
+ * Linux-only (memfd_create, eventfd, epoll).
+ */
+class ShmTransport : public Transport
+{
+public:
+  /// @brief Default size of each of the two rings (1MB), packets should be smaller than half of the ring
+  static const size_t DEFAULT_RING_SIZE;
+
+  /**
+   * @brief Create two transports connected to each other (e.g., before fork (), or for two wrappers in one process)
+   */
+  static void
+  createPair (Ptr<ShmTransport> &first, Ptr<ShmTransport> &second, size_t ringSize = DEFAULT_RING_SIZE);
+
+  /**
+   * @brief Wait for the peer on Unix socket, create shared memory segment and pass it to the peer
+   * @param socketPath path of the Unix socket to listen on (removed when the peer is attached)
+   * @param timeoutMs how long to wait for the peer, -1 to wait forever
+   * @throws Error::ndnOperation if the peer has not attached
+   */
+  static Ptr<ShmTransport>
+  accept (const std::string &socketPath, size_t ringSize = DEFAULT_RING_SIZE, int timeoutMs = -1);
+
+  /**
+   * @brief Attach to the segment of the peer waiting in accept ()
+   * @throws Error::ndnOperation if the peer cannot be reached
+   */
+  static Ptr<ShmTransport>
+  attach (const std::string &socketPath);
+
+  virtual
+  ~ShmTransport ();
+
+  virtual void
+  connect (const ReceiveCallback &receiveCallback);
+
+  virtual void
+  disconnect ();
+
+  virtual void
+  send (const unsigned char *buf, size_t length);
+
+  /**
+   * @brief Copy the list of buffers into the ring (or queue it while the ring is full)
+   */
+  virtual void
+  send (Ptr<const wire::IovecList> packet);
+
+  virtual void
+  registerPrefix (const Name &prefix);
+
+  virtual void
+  unregisterPrefix (const Name &prefix);
+
+  /**
+   * @brief Get epoll descriptor that becomes readable when the peer signals the eventfd of this side
+   */
+  virtual int
+  getFd () const;
+
+  virtual bool
+  isOutputPending () const;
+
+  virtual void
+  processEvents ();
+
+private:
+  struct Ring;
+
+  /**
+   * @brief Map the segment, the transport takes ownership of the descriptors
+   * @param side 0 or 1, side 0 sends into the first ring and receives from the second one
+   */
+  ShmTransport (int segmentFd, int notifyFd, int peerNotifyFd, int side);
+
+  /**
+   * @brief Create and initialize segment and eventfds (fds[0] segment, fds[1] eventfd of side 0, fds[2] of side 1)
+   */
+  static void
+  createSegment (size_t ringSize, int fds[3]);
+
+  /**
+   * @brief Copy the packet into the outbound ring
+   * @returns false if there is no space in the ring
+   */
+  bool
+  write (const iovec *buffers, size_t count, size_t length);
+
+  bool
+  write (const wire::IovecList &packet);
+
+  void
+  flush ();
+
+  void
+  receive ();
+
+  /**
+   * @brief Give space of the inbound records up to tail back to the peer
+   */
+  void
+  release (uint64_t tail);
+
+  void
+  signalPeer ();
+
+private:
+  int m_segmentFd;
+  int m_notifyFd;
+  int m_peerNotifyFd;
+  int m_epollFd;
+  void *m_segment;
+  size_t m_segmentSize;
+  size_t m_ringSize;
+  Ring *m_out;
+  Ring *m_in;
+  bool m_connected;
+  ReceiveCallback m_receiveCallback;
+
+  std::deque< Ptr<const wire::IovecList> > m_outputQueue; // packets waiting for space in the outbound ring
+};
+
+} // ndn
+
+#endif // NDN_SHM_TRANSPORT_H
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_TRANSPORT_H
+#define NDN_TRANSPORT_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+#include "ndn.cxx/wire/iovec-list.h"
+#include "ndn.cxx/wire/format.h"
+
+#include <boost/exception/all.hpp>
+
+namespace ndn {
+
+/**
+ * @brief Namespace holding all exceptions that can be fired by the library
+ */
+namespace Error
+{
+struct ndnOperation : boost::exception, std::exception { };
+}
+
+/**
+ * @brief Abstract connection to the local NDN forwarder
+ *
+ * Transport only moves wire-encoded packets: Interests and Data are given to send() and
+ * incoming packets are passed to the receive callback from processEvents().  Transport never
+ * blocks: waiting for events on getFd() is up to the user of the transport (Wrapper), as well
+ * as matching of Data to pending Interests and dispatching of Interests to the registered
+ * callbacks.
+ *
+ * Transport is not thread-safe, all calls should be serialized by the user.
+ */
+class Transport
+{
+public:
+  /**
+   * @brief Callback for incoming wire-encoded Interest or Data packet
+   *
+   * The buffer is valid only for the duration of the callback
+   */
+  typedef boost::function<void (const unsigned char *buf, size_t length)> ReceiveCallback;
+
+  virtual
+  ~Transport () { }
+
+  /**
+   * @brief Connect to the forwarder
+   * @param receiveCallback callback that will be called for every incoming packet
+   * @throws Error::ndnOperation if connection cannot be established
+   */
+  virtual void
+  connect (const ReceiveCallback &receiveCallback) = 0;
+
+  /**
+   * @brief Close connection to the forwarder (no-op if not connected)
+   */
+  virtual void
+  disconnect () = 0;
+
+  /**
+   * @brief Send wire-encoded Interest or Data packet
+   *
+   * The packet may be buffered inside the transport and actually sent during processEvents
+   */
+  virtual void
+  send (const unsigned char *buf, size_t length) = 0;
+
+  /**
+   * @brief Send wire-encoded packet given as a list of buffers
+   *
+   * The transport holds the list until the packet is sent, so the buffers referenced by the
+   * list should not be modified by the caller after this call.  The default implementation
+   * copies the list into a single buffer.
+   */
+  virtual void
+  send (Ptr<const wire::IovecList> packet)
+  {
+    Ptr<Blob> wire = packet->flatten ();
+    send (reinterpret_cast<const unsigned char *> (wire->buf ()), wire->size ());
+  }
+
+  /**
+   * @brief Get wire format of the packets sent and received over the transport
+   *
+   * The default implementation returns NDNB
+   */
+  virtual Ptr<const wire::Format>
+  getWireFormat () const
+  {
+    return wire::Format::ndnb ();
+  }
+
+  /**
+   * @brief Request forwarder to deliver Interests under the prefix
+   */
+  virtual void
+  registerPrefix (const Name &prefix) = 0;
+
+  /**
+   * @brief Stop delivery of Interests under the prefix
+   */
+  virtual void
+  unregisterPrefix (const Name &prefix) = 0;
+
+  /**
+   * @brief Get file descriptor of the connection, which the user of the transport should wait on
+   *        (for reading, and for writing if isOutputPending () is true) before calling processEvents ()
+   */
+  virtual int
+  getFd () const = 0;
+
+  /**
+   * @brief Check if there is buffered output that waits for the connection to become writable
+   */
+  virtual bool
+  isOutputPending () const = 0;
+
+  /**
+   * @brief Perform all pending input and output that can be done without blocking
+   * @throws Error::ndnOperation if connection has failed
+   */
+  virtual void
+  processEvents () = 0;
+};
+
+} // ndn
+
+#endif // NDN_TRANSPORT_H
@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "unix-transport.h"
+
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/error.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.UnixTransport");
+
+typedef boost::error_info<struct tag_errmsg, std::string> errmsg_info_str;
+
+using namespace std;
+
+namespace ndn {
+
+const Name UnixTransport::REGISTER_PREFIX ("/%C1.M.S.localhost/reg");
+const Name UnixTransport::UNREGISTER_PREFIX ("/%C1.M.S.localhost/unreg");
+const size_t UnixTransport::DEFAULT_MAX_PACKET_SIZE = 1024 * 1024 + 8800;
+
+UnixTransport::UnixTransport (const std::string &path, Ptr<const wire::Format> format/* = wire::Format::ndnb ()*/,
+                              size_t maxPacketSize/* = DEFAULT_MAX_PACKET_SIZE*/)
+  : m_path (path)
+  , m_format (format)
+  , m_fd (-1)
+  , m_nonce (static_cast<uint32_t> (::time (0)) ^ (static_cast<uint32_t> (getpid ()) << 16))
+  , m_framer (format, maxPacketSize)
+  , m_outputOffset (0)
+{
+}
+
+UnixTransport::~UnixTransport ()
+{
+  disconnect ();
+}
+
+void
+UnixTransport::connect (const ReceiveCallback &receiveCallback)
+{
+  disconnect ();
+
+  m_receiveCallback = receiveCallback;
+
+  sockaddr_un addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  if (m_path.size () >= sizeof (addr.sun_path))
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("socket path is too long: " + m_path));
+    }
+  strncpy (addr.sun_path, m_path.c_str (), sizeof (addr.sun_path) - 1);
+
+  m_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (m_fd < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot create socket"));
+    }
+
+  if (::connect (m_fd, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)) < 0)
+    {
+      close (m_fd);
+      m_fd = -1;
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("connection to " + m_path + " failed"));
+    }
+
+  fcntl (m_fd, F_SETFL, fcntl (m_fd, F_GETFL) | O_NONBLOCK);
+}
+
+void
+UnixTransport::disconnect ()
+{
+  if (m_fd < 0)
+    return;
+
+  close (m_fd);
+  m_fd = -1;
+  m_framer.reset ();
+  m_outputQueue.clear ();
+  m_outputOffset = 0;
+  m_copiedPackets.reset ();
+}
+
+void
+UnixTransport::send (const unsigned char *buf, size_t length)
+{
+  if (m_fd < 0)
+    return;
+
+  // small packets are copied one after another into a buffer owned by the transport, so they
+  // still go out as a single iovec
+  if (!m_outputQueue.empty () && m_outputQueue.back () == m_copiedPackets)
+    {
+      m_copiedPackets->appendCopy (buf, length);
+      return;
+    }
+
+  m_copiedPackets = Create<wire::IovecList> ();
+  m_copiedPackets->appendCopy (buf, length);
+  m_outputQueue.push_back (m_copiedPackets);
+}
+
+void
+UnixTransport::send (Ptr<const wire::IovecList> packet)
+{
+  if (m_fd < 0)
+    return;
+
+  // written out by processEvents, so a batch of packets goes out with a single writev
+  m_outputQueue.push_back (packet);
+}
+
+Ptr<const wire::Format>
+UnixTransport::getWireFormat () const
+{
+  return m_format;
+}
+
+void
+UnixTransport::registerPrefix (const Name &prefix)
+{
+  sendRegistration (REGISTER_PREFIX, prefix);
+}
+
+void
+UnixTransport::unregisterPrefix (const Name &prefix)
+{
+  sendRegistration (UNREGISTER_PREFIX, prefix);
+}
+
+void
+UnixTransport::sendRegistration (const Name &command, const Name &prefix)
+{
+  Name name (command);
+  name.append (prefix);
+
+  Interest interest (name);
+  interest.setScope (Interest::SCOPE_LOCAL_NDND);
+
+  Blob wire;
+  m_format->encodeInterest (interest, ++m_nonce, wire);
+  send (reinterpret_cast<const unsigned char *> (wire.buf ()), wire.size ());
+}
+
+int
+UnixTransport::getFd () const
+{
+  return m_fd;
+}
+
+bool
+UnixTransport::isOutputPending () const
+{
+  return !m_outputQueue.empty ();
+}
+
+void
+UnixTransport::processEvents ()
+{
+  if (m_fd < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("not connected"));
+    }
+
+  flush ();
+  read ();
+}
+
+void
+UnixTransport::flush ()
+{
+  while (!m_outputQueue.empty ())
+    {
+      // gather buffers of as many queued packets as a single writev can take
+      iovec buffers[IOV_MAX];
+      int count = 0;
+      size_t gathered = 0;
+      size_t skip = m_outputOffset;
+      for (std::deque< Ptr<const wire::IovecList> >::const_iterator packet = m_outputQueue.begin ();
+           packet != m_outputQueue.end () && count < IOV_MAX;
+           packet++)
+        {
+          const std::vector<iovec> &packetBuffers = (*packet)->getIovec ();
+          for (std::vector<iovec>::const_iterator buffer = packetBuffers.begin ();
+               buffer != packetBuffers.end () && count < IOV_MAX;
+               buffer++)
+            {
+              if (skip >= buffer->iov_len)
+                {
+                  skip -= buffer->iov_len; // already written
+                  continue;
+                }
+
+              buffers[count].iov_base = reinterpret_cast<char *> (buffer->iov_base) + skip;
+              buffers[count].iov_len = buffer->iov_len - skip;
+              skip = 0;
+              gathered += buffers[count].iov_len;
+              count ++;
+            }
+        }
+
+      ssize_t written = ::writev (m_fd, buffers, count);
+      if (written < 0)
+        {
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            break;
+
+          BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("write to socket failed"));
+        }
+
+      // release packets that have been written completely
+      size_t remaining = m_outputOffset + written;
+      while (!m_outputQueue.empty () && remaining >= m_outputQueue.front ()->size ())
+        {
+          remaining -= m_outputQueue.front ()->size ();
+          m_outputQueue.pop_front ();
+        }
+      if (m_outputQueue.empty ())
+        m_copiedPackets.reset ();
+      m_outputOffset = remaining;
+
+      if (static_cast<size_t> (written) < gathered)
+        break; // socket buffer is full
+    }
+}
+
+void
+UnixTransport::read ()
+{
+  // read directly into the buffer of the framer, complete packets are passed to the callback
+  // without being copied
+  const size_t readSize = 8800;
+  ssize_t received = ::read (m_fd, m_framer.prepare (readSize), readSize);
+  if (received == 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("connection closed by the forwarder"));
+    }
+  if (received < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return;
+
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("read from socket failed"));
+    }
+
+  m_packets.clear ();
+  try
+    {
+      m_framer.commit (received, m_packets);
+    }
+  catch (boost::exception &e)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("invalid packet in the stream: " + diagnostic_information (e)));
+    }
+
+  if (m_receiveCallback.empty ())
+    return;
+
+  for (wire::Framer::PacketList::const_iterator packet = m_packets.begin (); packet != m_packets.end (); packet++)
+    {
+      m_receiveCallback (packet->m_buf, packet->m_size);
+    }
+}
+
+} // ndn
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_UNIX_TRANSPORT_H
+#define NDN_UNIX_TRANSPORT_H
+
+#include "transport.h"
+#include "ndn.cxx/fields/blob.h"
+#include "ndn.cxx/wire/framer.h"
+
+#include <deque>
+
+namespace ndn {
+
+/**
+ * @brief Transport over Unix-domain stream socket
+ *
+ * Packets are sent over the socket as a stream of concatenated elements, NDNB or NDN-TLV
+ * (packets of both formats are framed without being decoded).  Prefix
+ * registration is requested with an Interest for REGISTER_PREFIX (or UNREGISTER_PREFIX)
+ * followed by components of the prefix, which a local (mock) forwarder is expected to
+ * handle.
+ */
+class UnixTransport : public Transport
+{
+public:
+  /// @brief Prefix of Interests requesting prefix registration (/%C1.M.S.localhost/reg)
+  static const Name REGISTER_PREFIX;
+
+  /// @brief Prefix of Interests requesting removal of prefix registration (/%C1.M.S.localhost/unreg)
+  static const Name UNREGISTER_PREFIX;
+
+  /// @brief Default maximum size of a received packet (1MB of payload plus 8800 bytes for the rest of the packet)
+  static const size_t DEFAULT_MAX_PACKET_SIZE;
+
+  /**
+   * @brief Create transport
+   * @param path path of the Unix socket of the forwarder
+   * @param format wire format of the packets (registration requests are sent in the same format)
+   * @param maxPacketSize maximum size of a received packet, larger packets are treated as a
+   *        protocol error and the connection is dropped
+   */
+  UnixTransport (const std::string &path, Ptr<const wire::Format> format = wire::Format::ndnb (),
+                 size_t maxPacketSize = DEFAULT_MAX_PACKET_SIZE);
+
+  virtual
+  ~UnixTransport ();
+
+  virtual void
+  connect (const ReceiveCallback &receiveCallback);
+
+  virtual void
+  disconnect ();
+
+  virtual void
+  send (const unsigned char *buf, size_t length);
+
+  /**
+   * @brief Queue the list of buffers for sending, buffers are written with writev without
+   *        being copied
+   */
+  virtual void
+  send (Ptr<const wire::IovecList> packet);
+
+  virtual Ptr<const wire::Format>
+  getWireFormat () const;
+
+  virtual void
+  registerPrefix (const Name &prefix);
+
+  virtual void
+  unregisterPrefix (const Name &prefix);
+
+  virtual int
+  getFd () const;
+
+  virtual bool
+  isOutputPending () const;
+
+  virtual void
+  processEvents ();
+
+private:
+  void
+  sendRegistration (const Name &command, const Name &prefix);
+
+  void
+  flush ();
+
+  void
+  read ();
+
+private:
+  std::string m_path;
+  Ptr<const wire::Format> m_format;
+  int m_fd;
+  ReceiveCallback m_receiveCallback;
+  uint32_t m_nonce; // nonce of the last registration request
+
+  wire::Framer m_framer;
+  wire::Framer::PacketList m_packets; // packets of the last read
+
+  std::deque< Ptr<const wire::IovecList> > m_outputQueue;
+  size_t m_outputOffset; // bytes of the first packet in the queue that have already been written
+  Ptr<wire::IovecList> m_copiedPackets; // list in the queue that copies of sent buffers are appended to
+};
+
+} // ndn
+
+#endif // NDN_UNIX_TRANSPORT_H
@@ -28,6 +28,9 @@ struct ptr_payload_traits
   typedef Ptr<const BasePayload> const_base_type;
 
   static Ptr<Payload> empty_payload;
+
+  static Ptr<Payload>
+  create_payload () { return Ptr<Payload>::Create (); }
 };
 
 template<typename Payload, typename BasePayload>
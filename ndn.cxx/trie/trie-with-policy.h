@@ -38,7 +38,7 @@ public:
 
   inline
   trie_with_policy (size_t bucketSize = 10, size_t bucketIncrement = 10)
-    : trie_ ("", bucketSize, bucketIncrement)
+    : trie_ (typename parent_trie::Key (), bucketSize, bucketIncrement)
     , policy_ (*this)
   {
   }
@@ -66,6 +66,45 @@ public:
     return item;
   }
 
+  /**
+   * @brief Find exact match for the key or insert a new entry, in a single trie descent
+   * @param key the key
+   * @param factory functor to create a new payload (called only if the entry for the key does not exist yet)
+   *
+   * @returns pair of iterator and flag, which is true if a new entry has been created.
+   *          If policy rejected the new entry, (end (), false) is returned
+   */
+  template<class PayloadFactory>
+  inline std::pair< iterator, bool >
+  try_insert (const FullKey &key, PayloadFactory factory)
+  {
+    iterator item = trie_.find_or_create (key);
+
+    if (item->payload () != PayloadTraits::empty_payload)
+      return std::make_pair (s_iterator_to (item), false);
+
+    item->set_payload (factory ());
+    bool ok = policy_.insert (s_iterator_to (item));
+    if (!ok)
+      {
+        item->erase (); // cannot insert
+        return std::make_pair (end (), false);
+      }
+
+    return std::make_pair (s_iterator_to (item), true);
+  }
+
+  /**
+   * @brief Find exact match for the key or insert a new entry with default-constructed payload
+   *
+   * @see try_insert (const FullKey &key, PayloadFactory factory)
+   */
+  inline std::pair< iterator, bool >
+  try_insert (const FullKey &key)
+  {
+    return try_insert (key, &PayloadTraits::create_payload);
+  }
+
   inline void
   erase (const FullKey &key)
   {
@@ -130,6 +130,26 @@ public:
   inline std::pair<iterator, bool>
   insert (const FullKey &key,
           typename PayloadTraits::insert_type payload)
+  {
+    trie *trieNode = find_or_create (key);
+
+    if (trieNode->payload_ == PayloadTraits::empty_payload)
+      {
+        trieNode->payload_ = payload;
+        return std::make_pair (trieNode, true);
+      }
+    else
+      return std::make_pair (trieNode, false);
+  }
+
+  /**
+   * @brief Find the node for the key, creating all missing nodes on the way (single descent)
+   * @param key the key for which to find or create the node
+   *
+   * @returns node for the key.  Payload of the node is empty if the node did not have payload before
+   */
+  inline iterator
+  find_or_create (const FullKey &key)
   {
     trie *trieNode = this;
 
@@ -161,13 +181,7 @@ public:
           trieNode = &(*item);
       }
 
-    if (trieNode->payload_ == PayloadTraits::empty_payload)
-      {
-        trieNode->payload_ = payload;
-        return std::make_pair (trieNode, true);
-      }
-    else
-      return std::make_pair (trieNode, false);
+    return trieNode;
   }
 
   /**
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "format.h"
+
+#include "ndnb/ndnb-format.h"
+#include "tlv/tlv-format.h"
+
+#include "ndn.cxx/error.h"
+
+#include <istream>
+
+namespace ndn {
+namespace wire {
+
+Ptr<const Format>
+Format::ndnb ()
+{
+  static Ptr<const Format> format (new wire::ndnb::Format ());
+  return format;
+}
+
+Ptr<const Format>
+Format::tlv ()
+{
+  static Ptr<const Format> format (new wire::tlv::Format ());
+  return format;
+}
+
+size_t
+Format::findPacketEnd (const unsigned char *buf, size_t length) const
+{
+  PacketScan scan;
+  return findPacketEnd (buf, length, scan);
+}
+
+void
+Format::readPacket (std::istream &is, Blob &packet) const
+{
+  packet.clear ();
+
+  PacketScan scan;
+  size_t size = 1;
+  while (true)
+    {
+      size_t offset = packet.size ();
+      packet.resize (offset + size);
+      is.read (&packet[offset], size);
+      if (static_cast<size_t> (is.gcount ()) != size)
+        BOOST_THROW_EXCEPTION (error::wire::Framer () << error::msg ("stream ended in the middle of a packet")
+                               << error::pos (offset + is.gcount ()));
+
+      size_t length = findPacketEnd (reinterpret_cast<const unsigned char *> (packet.buf ()), packet.size (), scan);
+      if (length > 0)
+        {
+          BOOST_ASSERT (length == packet.size ());
+          return;
+        }
+
+      // rest of the value whose size is already known, otherwise the next byte of a header
+      size = scan.m_end > packet.size () ? scan.m_end - packet.size () : 1;
+    }
+}
+
+} // wire
+} // ndn
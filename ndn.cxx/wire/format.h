@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_FORMAT_H
+#define NDN_WIRE_FORMAT_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+#include "ndn.cxx/fields/signed-blob.h"
+
+#include <iosfwd>
+
+namespace ndn {
+
+class Interest;
+class Data;
+
+namespace wire {
+
+class InterestTemplate;
+
+/**
+ * @brief Wire format of Interest and Data packets (NDNB or NDN-TLV)
+ *
+ * Format is the common interface of the packet codecs, so the code that moves packets
+ * (transports, Wrapper) does not depend on the encoding.  Formats are stateless, the shared
+ * instances are returned by Format::ndnb () and Format::tlv ().
+ *
+ * Not all fields can be represented by every format.  NDN-TLV has no Timestamp,
+ * PublisherPublicKeyDigest, and AnswerOriginKind: they are not encoded, and decoded packets
+ * have default values of these fields.
+ *
+ * Decoding methods throw error::wire::Ndnb (or NdnbParser::NdnbDecodingException) and
+ * error::wire::Tlv if the buffer is truncated or malformed.
+ */
+class Format
+{
+public:
+  /**
+   * @brief Type of the packet, determined from its first bytes
+   */
+  enum PacketType
+    {
+      UNKNOWN_PACKET, ///< @brief neither Interest nor Data (or the header is malformed)
+      INTEREST_PACKET,
+      DATA_PACKET
+    };
+
+  /**
+   * @brief State of the incremental search for the end of a packet in a growing buffer
+   *
+   * Default-constructed state starts the search from the beginning of the packet.  The state
+   * should be reset after the end of the packet has been found.
+   */
+  struct PacketScan
+  {
+    PacketScan () : m_end (0), m_depth (0) { }
+
+    size_t m_end; ///< @brief bytes of the packet that have been scanned (or skipped, can exceed the buffer)
+    int m_depth;  ///< @brief nesting depth of the element at m_end (format-specific)
+  };
+
+  virtual
+  ~Format () { }
+
+  /**
+   * @brief Get NDNB format (the default format of the library)
+   */
+  static Ptr<const Format>
+  ndnb ();
+
+  /**
+   * @brief Get NDN-TLV format
+   */
+  static Ptr<const Format>
+  tlv ();
+
+  /**
+   * @brief Get name of the format (for logging)
+   */
+  virtual const char *
+  getName () const = 0;
+
+  /**
+   * @brief Find the end of the first complete packet in the buffer (e.g., in the stream received
+   *        from the socket)
+   * @returns size of the packet, 0 if the packet is not complete yet
+   * @throws error::wire::Ndnb or error::wire::Tlv if the buffer does not start with a valid element
+   */
+  size_t
+  findPacketEnd (const unsigned char *buf, size_t length) const;
+
+  /**
+   * @brief Continue the search for the end of the packet after more bytes have been received
+   * @param buf pointer to the first byte of the packet (buffer may be moved between calls)
+   * @param length number of bytes of the packet received so far
+   * @param scan state of the search, updated so bytes are not scanned again on the next call
+   * @returns size of the packet, 0 if the packet is not complete yet
+   *
+   * When 0 is returned, scan.m_end is the lower bound of the packet size, known from the headers
+   * parsed so far, so oversized packets can be rejected before they are received.
+   */
+  virtual size_t
+  findPacketEnd (const unsigned char *buf, size_t length, PacketScan &scan) const = 0;
+
+  /**
+   * @brief Read exactly one packet from the stream
+   * @param packet (out) bytes of the packet (previous content of the blob is replaced)
+   * @throws error::wire::Framer if the stream ends before the packet is complete
+   *
+   * Headers are read byte by byte and values in one read each, so nothing past the end of the
+   * packet is taken from the stream.  The packet can then be decoded from the contiguous buffer.
+   */
+  void
+  readPacket (std::istream &is, Blob &packet) const;
+
+  /**
+   * @brief Get type of the packet without decoding it
+   */
+  virtual PacketType
+  getPacketType (const unsigned char *buf, size_t length) const = 0;
+
+  /**
+   * @brief Extract name of Interest or Data without decoding the packet
+   * @param name (out) name of the packet, components are appended
+   * @returns false if the packet is malformed or does not contain a name
+   */
+  virtual bool
+  parseName (const unsigned char *buf, size_t length, Name &name) const = 0;
+
+  /**
+   * @brief Encode Interest into the blob (previous content of the blob is replaced)
+   * @param nonce value of the Nonce field, if the format encodes it
+   * @returns offset of the Nonce value inside the wire (so it can be replaced before every send),
+   *          0 if the format does not encode Nonce
+   */
+  virtual size_t
+  encodeInterest (const Interest &interest, uint32_t nonce, Blob &wire) const = 0;
+
+  /**
+   * @brief Create pre-encoded Interest template, the name of the interest is the common prefix
+   *        of Interests encoded with the template
+   */
+  virtual Ptr<InterestTemplate>
+  createInterestTemplate (const Interest &interest) const = 0;
+
+  /**
+   * @brief Decode Interest fields from the buffer
+   */
+  virtual void
+  decodeInterest (Interest &interest, const void *buf, size_t length) const = 0;
+
+  /**
+   * @brief Encode Data (signature should be set)
+   * @returns complete encoding with the signed portion set
+   *
+   * If data has the signed blob, its signed portion is written as is.  The signed blob of data
+   * should have been created in the same format (see Data::setWireFormat).
+   */
+  virtual Ptr<SignedBlob>
+  encodeData (const Data &data) const = 0;
+
+  /**
+   * @brief Encode Data with zeroed space reserved for signature bits
+   * @param reserve size of the reserved space
+   * @param signatureBitsOffset (out) offset of the reserved space inside the encoding
+   * @returns complete encoding with the signed portion set
+   *
+   * Signature bits of exactly reserve bytes can be patched into the reserved space after
+   * signing, the result is the same as encodeData would produce for the signed data.  Signature
+   * bits and the signed blob of data are ignored.
+   */
+  virtual Ptr<SignedBlob>
+  encodeDataForSigning (const Data &data, size_t reserve, size_t &signatureBitsOffset) const = 0;
+
+  /**
+   * @brief Decode Data fields from the buffer
+   * @param signedOffset (out) offset of the signed portion inside the buffer
+   * @param signedSize (out) size of the signed portion
+   *
+   * Signature of data is replaced with a new signature::Sha256WithRsa.
+   */
+  virtual void
+  decodeData (Data &data, const void *buf, size_t length, size_t &signedOffset, size_t &signedSize) const = 0;
+};
+
+} // wire
+} // ndn
+
+#endif // NDN_WIRE_FORMAT_H
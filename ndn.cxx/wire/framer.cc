@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "framer.h"
+
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/error.h"
+
+#include <string.h>
+
+namespace ndn {
+namespace wire {
+
+Framer::Framer (Ptr<const Format> format, size_t maxPacketSize)
+  : m_format (format)
+  , m_maxPacketSize (maxPacketSize)
+  , m_begin (0)
+  , m_end (0)
+{
+}
+
+unsigned char *
+Framer::prepare (size_t size)
+{
+  if (m_begin > 0)
+    {
+      // only the beginning of the incomplete packet is moved, complete packets are released
+      memmove (&m_buffer[0], &m_buffer[m_begin], m_end - m_begin);
+      m_end -= m_begin;
+      m_begin = 0;
+    }
+
+  if (m_buffer.size () < m_end + size)
+    m_buffer.resize (m_end + size);
+
+  return reinterpret_cast<unsigned char *> (&m_buffer[m_end]);
+}
+
+void
+Framer::commit (size_t size, PacketList &packets)
+{
+  BOOST_ASSERT (m_end + size <= m_buffer.size ());
+  m_end += size;
+
+  const unsigned char *buf = reinterpret_cast<const unsigned char *> (m_buffer.buf ());
+  while (m_begin < m_end)
+    {
+      size_t length = m_format->findPacketEnd (buf + m_begin, m_end - m_begin, m_scan);
+      if (length == 0)
+        {
+          if (m_scan.m_end > m_maxPacketSize || m_end - m_begin > m_maxPacketSize)
+            BOOST_THROW_EXCEPTION (error::wire::Framer () << error::msg ("packet is too large")
+                                   << error::pos (m_scan.m_end));
+          break;
+        }
+      if (length > m_maxPacketSize)
+        BOOST_THROW_EXCEPTION (error::wire::Framer () << error::msg ("packet is too large")
+                               << error::pos (length));
+
+      Packet packet = { buf + m_begin, length };
+      packets.push_back (packet);
+
+      m_begin += length;
+      m_scan = Format::PacketScan ();
+    }
+
+  if (m_begin == m_end)
+    {
+      // nothing to move on the next prepare
+      m_begin = 0;
+      m_end = 0;
+    }
+}
+
+void
+Framer::append (const void *buf, size_t size, PacketList &packets)
+{
+  memcpy (prepare (size), buf, size);
+  commit (size, packets);
+}
+
+void
+Framer::reset ()
+{
+  m_begin = 0;
+  m_end = 0;
+  m_scan = Format::PacketScan ();
+}
+
+size_t
+Framer::decode (const PacketList &packets,
+                std::vector< Ptr<Interest> > &interests, std::vector< Ptr<Data> > &data) const
+{
+  size_t skipped = 0;
+  for (PacketList::const_iterator packet = packets.begin (); packet != packets.end (); packet++)
+    {
+      switch (m_format->getPacketType (packet->m_buf, packet->m_size))
+        {
+        case Format::INTEREST_PACKET:
+          {
+            Ptr<Interest> interest = Create<Interest> ();
+            m_format->decodeInterest (*interest, packet->m_buf, packet->m_size);
+            interests.push_back (interest);
+            break;
+          }
+        case Format::DATA_PACKET:
+          data.push_back (Data::decodeFromWire (packet->m_buf, packet->m_size, m_format));
+          break;
+        default:
+          skipped ++;
+          break;
+        }
+    }
+  return skipped;
+}
+
+} // wire
+} // ndn
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_FRAMER_H
+#define NDN_WIRE_FRAMER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/blob.h"
+#include "format.h"
+
+#include <vector>
+
+namespace ndn {
+
+class Interest;
+class Data;
+
+namespace wire {
+
+/**
+ * @brief Splits the stream of concatenated packets (e.g., received from a socket) into packets
+ *
+ * Framer owns the receive buffer: bytes are read directly into the space returned by prepare ()
+ * and then committed.  Complete packets are returned as spans of the buffer, without being
+ * copied or decoded.  The end of a packet is searched incrementally (see
+ * Format::findPacketEnd), so bytes of a large packet that arrives in many reads are scanned
+ * only once.
+ *
+ * Packets larger than the limit are rejected as soon as their size is known from the headers,
+ * before the rest of the packet is buffered.
+ *
+ * @code
+ * unsigned char *buf = framer.prepare (8800);
+ * ssize_t received = ::read (fd, buf, 8800);
+ * ...
+ * packets.clear ();
+ * framer.commit (received, packets);
+ * @endcode
+ */
+class Framer
+{
+public:
+  /**
+   * @brief Complete packet inside the buffer of the framer
+   */
+  struct Packet
+  {
+    const unsigned char *m_buf;
+    size_t m_size;
+  };
+
+  typedef std::vector<Packet> PacketList;
+
+  /**
+   * @brief Create framer
+   * @param format wire format of the packets in the stream
+   * @param maxPacketSize maximum size of a single packet
+   */
+  Framer (Ptr<const Format> format, size_t maxPacketSize);
+
+  /**
+   * @brief Get space for the next read into the buffer
+   * @param size number of bytes that will be read
+   *
+   * Packets returned by the previous commit are invalidated.
+   */
+  unsigned char *
+  prepare (size_t size);
+
+  /**
+   * @brief Account bytes read into the space returned by prepare ()
+   * @param size number of bytes that have been read
+   * @param packets (out) list that complete packets are appended to
+   * @throws error::wire::Framer if the packet is too large, error::wire::Ndnb or error::wire::Tlv
+   *         if the stream is malformed (the stream cannot be resynchronized after an error, so
+   *         the framer should be reset or discarded)
+   */
+  void
+  commit (size_t size, PacketList &packets);
+
+  /**
+   * @brief Copy bytes into the buffer and commit them (shortcut for prepare, memcpy, and commit)
+   */
+  void
+  append (const void *buf, size_t size, PacketList &packets);
+
+  /**
+   * @brief Get number of buffered bytes of the incomplete packet
+   */
+  inline size_t
+  getPendingSize () const;
+
+  /**
+   * @brief Discard all buffered bytes (e.g., after the connection has been reestablished)
+   */
+  void
+  reset ();
+
+  /**
+   * @brief Decode a batch of complete packets
+   * @param interests (out) list that decoded Interests are appended to
+   * @param data (out) list that decoded Data packets are appended to
+   * @returns number of packets that are neither Interests nor Data (they are skipped)
+   *
+   * Packets are decoded in the order of arrival, decoding errors are thrown as by
+   * Format::decodeInterest and Data::decodeFromWire.
+   */
+  size_t
+  decode (const PacketList &packets,
+          std::vector< Ptr<Interest> > &interests, std::vector< Ptr<Data> > &data) const;
+
+private:
+  Ptr<const Format> m_format;
+  size_t m_maxPacketSize;
+
+  Blob m_buffer;
+  size_t m_begin; // beginning of the incomplete packet in the buffer
+  size_t m_end;   // end of the received bytes in the buffer
+  Format::PacketScan m_scan; // state of the search for the end of the incomplete packet
+};
+
+inline size_t
+Framer::getPendingSize () const
+{
+  return m_end - m_begin;
+}
+
+} // wire
+} // ndn
+
+#endif // NDN_WIRE_FRAMER_H
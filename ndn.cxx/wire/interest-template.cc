@@ -0,0 +1,30 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "interest-template.h"
+
+namespace ndn {
+namespace wire {
+
+InterestTemplate::InterestTemplate (const Interest &interest)
+  : m_interest (interest)
+{
+}
+
+Ptr<Interest>
+InterestTemplate::createInterest (const Name &suffix) const
+{
+  Ptr<Interest> interest = Ptr<Interest> (new Interest (m_interest));
+  interest->getName ().append (suffix);
+  return interest;
+}
+
+} // wire
+} // ndn
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_INTEREST_TEMPLATE_H
+#define NDN_WIRE_INTEREST_TEMPLATE_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/fields/blob.h"
+
+namespace ndn {
+namespace wire {
+
+/**
+ * @brief Pre-encoded Interest, for sending many Interests that differ only in the name suffix
+ *        (e.g., segment numbers of the same object)
+ *
+ * Template is created by Format::createInterestTemplate from the Interest whose name is the
+ * common prefix.  The prefix and all selectors are encoded once; encode () writes only the
+ * suffix components, the Nonce, and the headers whose lengths depend on the suffix, and copies
+ * the rest.  The result is the same as Format::encodeInterest would give for the full Interest.
+ *
+ * Template is immutable and can be used from several threads at once.
+ */
+class InterestTemplate
+{
+public:
+  virtual
+  ~InterestTemplate () { }
+
+  /**
+   * @brief Get Interest the template was created from (its name is the prefix)
+   */
+  inline const Interest &
+  getInterest () const;
+
+  /**
+   * @brief Encode Interest for the prefix followed by the suffix (previous content of the blob
+   *        is replaced)
+   * @returns offset of the Nonce value inside the wire (as Format::encodeInterest)
+   */
+  virtual size_t
+  encode (const Name &suffix, uint32_t nonce, Blob &wire) const = 0;
+
+  /**
+   * @brief Create Interest with the same selectors for the prefix followed by the suffix
+   */
+  Ptr<Interest>
+  createInterest (const Name &suffix) const;
+
+protected:
+  InterestTemplate (const Interest &interest);
+
+protected:
+  Interest m_interest;
+};
+
+inline const Interest &
+InterestTemplate::getInterest () const
+{
+  return m_interest;
+}
+
+} // wire
+} // ndn
+
+#endif // NDN_WIRE_INTEREST_TEMPLATE_H
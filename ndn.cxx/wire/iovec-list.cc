@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "iovec-list.h"
+
+#include <string.h>
+
+namespace ndn {
+namespace wire {
+
+const size_t IovecList::MIN_REFERENCE_SIZE = 128;
+
+IovecList::IovecList ()
+  : m_copiedMark (0)
+  , m_referencedSize (0)
+  , m_iovecValid (false)
+{
+}
+
+std::ostream &
+IovecList::getStream ()
+{
+  if (!m_stream)
+    {
+      m_stream.reset (new boost::iostreams::stream<iostreams::blob_append_device> (iostreams::blob_append_device (m_copied)));
+    }
+
+  m_iovecValid = false;
+  return *m_stream;
+}
+
+void
+IovecList::appendCopy (const void *buf, size_t length)
+{
+  if (m_stream)
+    m_stream->flush (); // keep the order of bytes written to the stream and copied directly
+
+  m_copied.insert (m_copied.end (),
+                   reinterpret_cast<const char *> (buf), reinterpret_cast<const char *> (buf) + length);
+  m_iovecValid = false;
+}
+
+void
+IovecList::appendReference (const void *buf, size_t length)
+{
+  if (length < MIN_REFERENCE_SIZE)
+    {
+      appendCopy (buf, length);
+      return;
+    }
+
+  closeCopiedSegment ();
+
+  Segment segment = { reinterpret_cast<const char *> (buf), 0, length };
+  m_segments.push_back (segment);
+  m_referencedSize += length;
+  m_iovecValid = false;
+}
+
+void
+IovecList::keepAlive (boost::shared_ptr<const void> object)
+{
+  m_keepAlive.push_back (object);
+}
+
+void
+IovecList::closeCopiedSegment () const
+{
+  if (m_stream)
+    m_stream->flush ();
+
+  if (m_copied.size () > m_copiedMark)
+    {
+      Segment segment = { 0, m_copiedMark, m_copied.size () - m_copiedMark };
+      m_segments.push_back (segment);
+      m_copiedMark = m_copied.size ();
+    }
+}
+
+const std::vector<iovec> &
+IovecList::getIovec () const
+{
+  if (m_iovecValid)
+    return m_iovec;
+
+  closeCopiedSegment ();
+
+  // pointers to m_copied are resolved only now, as the blob may have been reallocated while encoding
+  m_iovec.resize (m_segments.size ());
+  for (size_t i = 0; i < m_segments.size (); i++)
+    {
+      const Segment &segment = m_segments[i];
+      m_iovec[i].iov_base = const_cast<char *> (segment.m_reference != 0 ?
+                                                segment.m_reference :
+                                                m_copied.buf () + segment.m_offset);
+      m_iovec[i].iov_len = segment.m_length;
+    }
+
+  m_iovecValid = true;
+  return m_iovec;
+}
+
+size_t
+IovecList::size () const
+{
+  if (m_stream)
+    m_stream->flush ();
+
+  return m_copied.size () + m_referencedSize;
+}
+
+Ptr<Blob>
+IovecList::flatten () const
+{
+  const std::vector<iovec> &buffers = getIovec ();
+
+  Ptr<Blob> blob = Create<Blob> ();
+  blob->resize (size ());
+
+  size_t offset = 0;
+  for (std::vector<iovec>::const_iterator i = buffers.begin (); i != buffers.end (); i++)
+    {
+      memcpy (blob->buf () + offset, i->iov_base, i->iov_len);
+      offset += i->iov_len;
+    }
+  return blob;
+}
+
+} // wire
+} // ndn
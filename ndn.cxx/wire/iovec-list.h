@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_IOVEC_LIST_H
+#define NDN_WIRE_IOVEC_LIST_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/blob.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <sys/uio.h>
+
+namespace ndn {
+namespace wire {
+
+/**
+ * @brief Wire encoding of a packet as a list of buffers (scatter-gather list)
+ *
+ * Small encoded elements (headers, names, SignedInfo) are written to getStream () and copied
+ * into the list, while large buffers (e.g., payload of the Data packet and signature bits)
+ * are only referenced with appendReference ().  The list can be written to a socket with a
+ * single writev call or hashed piece by piece, so the referenced buffers are never copied.
+ *
+ * Referenced memory is not owned by the list: it should stay valid and unmodified as long as
+ * the list is used, which can be ensured with keepAlive ().
+ */
+class IovecList : boost::noncopyable
+{
+public:
+  /**
+   * @brief Buffers shorter than this are copied by appendReference (), since a separate
+   *        iovec for them costs more than the copy
+   */
+  static const size_t MIN_REFERENCE_SIZE;
+
+  IovecList ();
+
+  /**
+   * @brief Stream to encode elements that should be copied into the list
+   */
+  std::ostream &
+  getStream ();
+
+  /**
+   * @brief Append a copy of the buffer to the list
+   */
+  void
+  appendCopy (const void *buf, size_t length);
+
+  /**
+   * @brief Append buffer to the list without copying it
+   */
+  void
+  appendReference (const void *buf, size_t length);
+
+  /**
+   * @brief Keep object alive (e.g., Data packet owning referenced buffers) for the lifetime of the list
+   */
+  void
+  keepAlive (boost::shared_ptr<const void> object);
+
+  /**
+   * @brief Get buffers of the list, in order
+   *
+   * The returned vector is valid until the list is modified
+   */
+  const std::vector<iovec> &
+  getIovec () const;
+
+  /**
+   * @brief Get total size of the encoding
+   */
+  size_t
+  size () const;
+
+  /**
+   * @brief Copy the whole encoding into a single contiguous blob
+   */
+  Ptr<Blob>
+  flatten () const;
+
+private:
+  void
+  closeCopiedSegment () const;
+
+private:
+  struct Segment
+  {
+    const char *m_reference; ///< @brief referenced buffer, 0 if segment is stored in m_copied
+    size_t m_offset;         ///< @brief offset of the segment in m_copied
+    size_t m_length;
+  };
+
+  mutable Blob m_copied;
+  // created on first use, lists with only copied and referenced buffers do not pay for the stream
+  boost::scoped_ptr< boost::iostreams::stream<iostreams::blob_append_device> > m_stream;
+  mutable size_t m_copiedMark; // end of the last segment stored in m_copied
+  mutable std::vector<Segment> m_segments;
+  size_t m_referencedSize;
+
+  mutable std::vector<iovec> m_iovec;
+  mutable bool m_iovecValid;
+
+  std::vector< boost::shared_ptr<const void> > m_keepAlive;
+};
+
+} // wire
+} // ndn
+
+#endif // NDN_WIRE_IOVEC_LIST_H
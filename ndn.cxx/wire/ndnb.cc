@@ -40,6 +40,141 @@ Ndnb::appendBlockHeader (std::ostream &os, size_t val, Ndnb::ndn_tt tt)
   // return n;
 }
 
+bool
+Ndnb::parseBlockHeader (const unsigned char *&begin, const unsigned char *end, size_t &value, Ndnb::ndn_tt &tt)
+{
+  const unsigned char *p = begin;
+  if (p == end)
+    return false;
+
+  if (*p == Ndnb::NDN_CLOSE_TAG)
+    {
+      value = 0;
+      tt = Ndnb::NDN_NO_TOKEN;
+      begin = p + 1;
+      return true;
+    }
+
+  size_t val = 0;
+  for (size_t i = 0; p != end && i < 1+8*((sizeof(val)+6)/7); i++, p++)
+    {
+      if (*p & NDN_TT_HBIT)
+        {
+          value = (val << (7-NDN_TT_BITS)) | ((*p >> NDN_TT_BITS) & NDN_MAX_TINY);
+          tt = static_cast<Ndnb::ndn_tt> (*p & NDN_TT_MASK);
+          begin = p + 1;
+          return true;
+        }
+      val = (val << 7) | *p;
+    }
+
+  return false;
+}
+
+/**
+ * @brief Move p right after the NDNB element that starts at p
+ * @returns false if the element is not complete or malformed
+ */
+static bool
+skipElement (const unsigned char *&p, const unsigned char *end)
+{
+  int depth = 0;
+  do
+    {
+      size_t value;
+      Ndnb::ndn_tt type;
+      if (!Ndnb::parseBlockHeader (p, end, value, type))
+        return false;
+
+      switch (type)
+        {
+        case Ndnb::NDN_NO_TOKEN: // closer
+          if (depth == 0)
+            return false;
+          depth --;
+          break;
+        case Ndnb::NDN_DTAG:
+        case Ndnb::NDN_EXT:
+          depth ++;
+          break;
+        case Ndnb::NDN_TAG:
+          depth ++;
+          value ++; // tag name follows the header
+          // fall through
+        case Ndnb::NDN_BLOB:
+        case Ndnb::NDN_UDATA:
+          if (static_cast<size_t> (end - p) < value)
+            return false;
+          p += value;
+          break;
+        case Ndnb::NDN_ATTR:
+          if (static_cast<size_t> (end - p) < value + 1)
+            return false;
+          p += value + 1; // attribute name, value follows as UDATA
+          break;
+        case Ndnb::NDN_DATTR:
+          break;
+        }
+    }
+  while (depth > 0);
+
+  return true;
+}
+
+bool
+Ndnb::parseName (const unsigned char *buf, size_t length, Name &name)
+{
+  const unsigned char *p = buf;
+  const unsigned char *end = buf + length;
+
+  size_t value;
+  Ndnb::ndn_tt type;
+  if (!parseBlockHeader (p, end, value, type) || type != NDN_DTAG ||
+      (value != NDN_DTAG_Interest && value != NDN_DTAG_ContentObject))
+    return false;
+
+  // look for Name among the children of the packet
+  while (true)
+    {
+      const unsigned char *element = p;
+      if (!parseBlockHeader (p, end, value, type) || type == NDN_NO_TOKEN)
+        return false;
+
+      if (type == NDN_DTAG && value == NDN_DTAG_Name)
+        break;
+
+      p = element;
+      if (!skipElement (p, end))
+        return false;
+    }
+
+  while (true)
+    {
+      if (!parseBlockHeader (p, end, value, type))
+        return false;
+      if (type == NDN_NO_TOKEN) // end of Name
+        return true;
+      if (type != NDN_DTAG || value != NDN_DTAG_Component)
+        return false;
+
+      if (!parseBlockHeader (p, end, value, type))
+        return false;
+      if (type == NDN_NO_TOKEN) // empty component
+        {
+          name.append (name::Component ());
+          continue;
+        }
+      if ((type != NDN_BLOB && type != NDN_UDATA) || static_cast<size_t> (end - p) < value)
+        return false;
+
+      name.append (name::Component (p, value));
+      p += value;
+
+      if (!parseBlockHeader (p, end, value, type) || type != NDN_NO_TOKEN)
+        return false;
+    }
+}
+
 void
 Ndnb::appendNumber (std::ostream &os, uint32_t number)
 {
@@ -107,13 +242,18 @@ Ndnb::appendExclude (std::ostream &os, const Exclude &exclude)
 }
 
 void
-Ndnb::appendInterest (std::ostream &os, const Interest &interest)
+Ndnb::appendInterest (std::ostream &os, const Interest &interest, bool withName/* = false*/)
 {
   Ndnb::appendBlockHeader (os, Ndnb::NDN_DTAG_Interest, Ndnb::NDN_DTAG); // <Interest>
 
-  // this is used for now as an interest template. Name should be empty
-  // Ndnb::appendName (os, interest.getName ());
-  Ndnb::appendName (os, Name ());                              // <Component>...</Component>...
+  if (withName)
+    {
+      Ndnb::appendName (os, interest.getName ());              // <Name><Component>...</Component>...</Name>
+    }
+  else
+    {
+      Ndnb::appendName (os, Name ());                          // interest template, Name should be empty
+    }
 
   if (interest.getMinSuffixComponents () != Interest::ncomps)
     {
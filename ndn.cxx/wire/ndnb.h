@@ -157,6 +157,31 @@ public:
   static void
   appendBlockHeader (std::ostream &os, size_t value, ndn_tt block_type);
 
+  /**
+   * @brief Parse NDNB block header
+   * @param begin pointer to the first byte of the header, on success moved right after the header
+   * @param end pointer right after the last available byte
+   * @param value (out) numeric value of the block header
+   * @param block_type (out) type of NDNB block, NDN_NO_TOKEN if header is a closer tag
+   *
+   * @returns false if header is not complete or malformed (begin is not changed)
+   */
+  static bool
+  parseBlockHeader (const unsigned char *&begin, const unsigned char *end, size_t &value, ndn_tt &block_type);
+
+  /**
+   * @brief Extract name of the NDNB-encoded Interest or ContentObject without decoding the packet
+   * @param buf pointer to the first byte of the packet
+   * @param length size of the packet
+   * @param name (out) name of the packet, components are appended
+   *
+   * Elements that precede the name (e.g., Signature of ContentObject) are skipped without being parsed.
+   *
+   * @returns false if the packet is malformed or does not contain a name
+   */
+  static bool
+  parseName (const unsigned char *buf, size_t length, Name &name);
+
   /**
    * @brief Add number in NDNB encoding
    * @param os output stream to write
@@ -260,11 +285,10 @@ public:
    * @brief Format interest in NDNb encoding
    * @param os output stream to write
    * @param interest Interest to be formatted
-   *
-   * @todo For now, this method is used to create Interest template, which doesn't output name to the stream
+   * @param withName if false, empty Name is written (Interest template for ndn_express_interest)
    */
   static void
-  appendInterest (std::ostream &os, const Interest &interest);
+  appendInterest (std::ostream &os, const Interest &interest, bool withName = false);
 
   /**
    * @brief Append exclude filter in NDNb encoding
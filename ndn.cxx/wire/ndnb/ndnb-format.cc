@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "ndnb-format.h"
+#include "ndnb-writer.h"
+#include "wire-ndnb-interest.h"
+#include "wire-ndnb-data.h"
+
+#include "ndn.cxx/wire/ndnb.h"
+#include "ndn.cxx/wire/interest-template.h"
+#include "ndn.cxx/error.h"
+
+#include <string.h>
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+const char *
+Format::getName () const
+{
+  return "NDNB";
+}
+
+size_t
+Format::findPacketEnd (const unsigned char *buf, size_t length, PacketScan &scan) const
+{
+  // scan.m_end is the offset of the next block header, which can be beyond the received bytes
+  // if value of the last parsed block has not been received completely
+  size_t offset = scan.m_end;
+  int depth = scan.m_depth;
+  if (offset > 0 && depth == 0)
+    return offset <= length ? offset : 0; // packet is a single BLOB or UDATA block
+
+  do
+    {
+      if (offset > length)
+        break;
+
+      const unsigned char *p = buf + offset;
+      size_t value;
+      Ndnb::ndn_tt type;
+      if (!Ndnb::parseBlockHeader (p, buf + length, value, type))
+        {
+          if (length - offset > 10) // header cannot be that long
+            BOOST_THROW_EXCEPTION (error::wire::Ndnb () << error::msg ("invalid NDNB header"));
+          break;
+        }
+      offset = p - buf;
+
+      switch (type)
+        {
+        case Ndnb::NDN_NO_TOKEN: // closer
+          if (depth == 0)
+            BOOST_THROW_EXCEPTION (error::wire::Ndnb () << error::msg ("unexpected NDNB closer"));
+          depth --;
+          break;
+        case Ndnb::NDN_DTAG:
+        case Ndnb::NDN_EXT:
+          depth ++;
+          break;
+        case Ndnb::NDN_TAG:
+          depth ++;
+          value ++; // tag name follows the header
+          // fall through
+        case Ndnb::NDN_BLOB:
+        case Ndnb::NDN_UDATA:
+          if (value > static_cast<size_t> (-1) - offset)
+            BOOST_THROW_EXCEPTION (error::wire::Ndnb () << error::msg ("invalid NDNB block size"));
+          offset += value;
+          break;
+        case Ndnb::NDN_ATTR:
+          if (value > static_cast<size_t> (-1) - offset - 1)
+            BOOST_THROW_EXCEPTION (error::wire::Ndnb () << error::msg ("invalid NDNB block size"));
+          offset += value + 1; // attribute name, value follows as UDATA
+          break;
+        case Ndnb::NDN_DATTR:
+          break;
+        }
+
+      if (depth == 0 && offset <= length)
+        return offset;
+    }
+  while (depth > 0);
+
+  scan.m_end = offset;
+  scan.m_depth = depth;
+  return 0;
+}
+
+wire::Format::PacketType
+Format::getPacketType (const unsigned char *buf, size_t length) const
+{
+  size_t dtag;
+  Ndnb::ndn_tt type;
+  if (!Ndnb::parseBlockHeader (buf, buf + length, dtag, type) || type != Ndnb::NDN_DTAG)
+    return UNKNOWN_PACKET;
+
+  switch (dtag)
+    {
+    case Ndnb::NDN_DTAG_Interest:
+      return INTEREST_PACKET;
+    case Ndnb::NDN_DTAG_ContentObject:
+      return DATA_PACKET;
+    default:
+      return UNKNOWN_PACKET;
+    }
+}
+
+bool
+Format::parseName (const unsigned char *buf, size_t length, Name &name) const
+{
+  return Ndnb::parseName (buf, length, name);
+}
+
+size_t
+Format::encodeInterest (const ndn::Interest &interest, uint32_t nonce, Blob &wire) const
+{
+  wire.resize (Writer::EstimateInterestWithNonce (interest));
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&wire[0]);
+  unsigned char *p = begin;
+  unsigned char *nonceValue;
+  Writer::AppendInterest (p, interest, nonce, nonceValue);
+  return nonceValue - begin;
+}
+
+/**
+ * @brief NDNB Interest template: everything before the closer of the Name and everything after
+ *        it are copied, suffix components are written in between
+ */
+class EncodedInterestTemplate : public wire::InterestTemplate
+{
+public:
+  EncodedInterestTemplate (const Format &format, const ndn::Interest &interest);
+
+  virtual size_t
+  encode (const Name &suffix, uint32_t nonce, Blob &wire) const;
+
+private:
+  Blob m_head; // <Interest><Name> and components of the prefix
+  Blob m_tail; // </Name>, selectors, Nonce, and </Interest>
+  size_t m_nonceOffset; // offset of the Nonce value in m_tail
+};
+
+EncodedInterestTemplate::EncodedInterestTemplate (const Format &format, const ndn::Interest &interest)
+  : wire::InterestTemplate (interest)
+{
+  Blob wire;
+  size_t nonceOffset = format.encodeInterest (interest, 0, wire);
+
+  size_t head = Writer::EstimateBlockHeader (NdnbParser::NDN_DTAG_Interest) + Writer::EstimateName (interest.getName ()) - 1;
+  m_head.assign (wire.begin (), wire.begin () + head);
+  m_tail.assign (wire.begin () + head, wire.end ());
+  m_nonceOffset = nonceOffset - head;
+}
+
+size_t
+EncodedInterestTemplate::encode (const Name &suffix, uint32_t nonce, Blob &wire) const
+{
+  size_t size = m_head.size () + m_tail.size ();
+  for (Name::const_iterator component = suffix.begin (); component != suffix.end (); component++)
+    {
+      size += Writer::EstimateTaggedBlob (NdnbParser::NDN_DTAG_Component, component->size ());
+    }
+  wire.resize (size);
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&wire[0]);
+  unsigned char *p = begin;
+  memcpy (p, m_head.buf (), m_head.size ());
+  p += m_head.size ();
+  for (Name::const_iterator component = suffix.begin (); component != suffix.end (); component++)
+    {
+      Writer::AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Component, component->buf (), component->size ());
+    }
+  memcpy (p, m_tail.buf (), m_tail.size ());
+
+  size_t nonceOffset = (p - begin) + m_nonceOffset;
+  memcpy (&wire[nonceOffset], &nonce, sizeof (nonce));
+  return nonceOffset;
+}
+
+Ptr<InterestTemplate>
+Format::createInterestTemplate (const ndn::Interest &interest) const
+{
+  return Ptr<InterestTemplate> (new EncodedInterestTemplate (*this, interest));
+}
+
+void
+Format::decodeInterest (ndn::Interest &interest, const void *buf, size_t length) const
+{
+  Interest::Decode (interest, buf, length);
+}
+
+Ptr<SignedBlob>
+Format::encodeData (const ndn::Data &data) const
+{
+  Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+  encoded->resize (Writer::EstimateData (data));
+
+  unsigned char *p = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+  Writer::AppendData (p, data);
+
+  // signed portion is followed only by the closer of the ContentObject
+  size_t signedSize = data.getSignedBlob () ? data.getSignedBlob ()->signed_size () : Writer::EstimateUnsignedData (data);
+  encoded->setSignedPortion (encoded->size () - 1 - signedSize, signedSize);
+  return encoded;
+}
+
+Ptr<SignedBlob>
+Format::encodeDataForSigning (const ndn::Data &data, size_t reserve, size_t &signatureBitsOffset) const
+{
+  Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+  encoded->resize (Writer::EstimateDataForSigning (data, reserve));
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+  unsigned char *p = begin;
+  unsigned char *signatureBits;
+  unsigned char *signedPortion;
+  Writer::AppendDataForSigning (p, data, reserve, signatureBits, signedPortion);
+
+  encoded->setSignedPortion (signedPortion - begin, p - signedPortion - 1);
+  signatureBitsOffset = signatureBits - begin;
+  return encoded;
+}
+
+void
+Format::decodeData (ndn::Data &data, const void *buf, size_t length, size_t &signedOffset, size_t &signedSize) const
+{
+  Data::Range signedPortion;
+  Data::Decode (data, buf, length, signedPortion);
+
+  signedOffset = signedPortion.m_offset;
+  signedSize = signedPortion.m_size;
+}
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_NDNB_FORMAT_H
+#define NDN_WIRE_NDNB_FORMAT_H
+
+#include "ndn.cxx/wire/format.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+/**
+ * @brief NDNB wire format (see wire::ndnb::Writer and wire::ndnb::Reader)
+ *
+ * Nonce is encoded as the last field of Interests.  Since NDNB elements are terminated by closers, the end
+ * of the packet in the stream is found by tracking nesting depth of all blocks of the packet
+ * (resumed from the last parsed header when more bytes arrive).
+ */
+class Format : public wire::Format
+{
+public:
+  virtual const char *
+  getName () const;
+
+  using wire::Format::findPacketEnd;
+
+  virtual size_t
+  findPacketEnd (const unsigned char *buf, size_t length, PacketScan &scan) const;
+
+  virtual PacketType
+  getPacketType (const unsigned char *buf, size_t length) const;
+
+  virtual bool
+  parseName (const unsigned char *buf, size_t length, Name &name) const;
+
+  virtual size_t
+  encodeInterest (const ndn::Interest &interest, uint32_t nonce, Blob &wire) const;
+
+  virtual Ptr<InterestTemplate>
+  createInterestTemplate (const ndn::Interest &interest) const;
+
+  virtual void
+  decodeInterest (ndn::Interest &interest, const void *buf, size_t length) const;
+
+  virtual Ptr<SignedBlob>
+  encodeData (const ndn::Data &data) const;
+
+  virtual Ptr<SignedBlob>
+  encodeDataForSigning (const ndn::Data &data, size_t reserve, size_t &signatureBitsOffset) const;
+
+  virtual void
+  decodeData (ndn::Data &data, const void *buf, size_t length, size_t &signedOffset, size_t &signedSize) const;
+};
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_NDNB_FORMAT_H
@@ -25,7 +25,7 @@ NameVisitor::visit (Dtag &n, boost::any param/*should be Name* */)
 {
   // uint32_t n.m_dtag;
   // std::list<Ptr<Block> > n.m_nestedBlocks;
-  static StringVisitor stringVisitor; 
+  StringVisitor stringVisitor;
  
   Name &components = *(boost::any_cast<Name*> (param));
 
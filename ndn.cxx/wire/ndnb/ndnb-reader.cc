@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "ndnb-reader.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+Reader::Reader (const void *buf, size_t length)
+  : m_begin (reinterpret_cast<const unsigned char *> (buf))
+  , m_pos (m_begin)
+  , m_end (m_begin + length)
+{
+}
+
+void
+Reader::readDtag (uint32_t dtag)
+{
+  Token token;
+  next (token);
+  if (token.m_type != NdnbParser::NDN_DTAG || token.m_value != dtag)
+    throw NdnbParser::NdnbDecodingException ();
+}
+
+void
+Reader::readValue (const unsigned char *&data, size_t &size)
+{
+  Token token;
+  next (token);
+  if (token.m_type == NdnbParser::NDN_NO_TOKEN) // empty value is encoded without BLOB
+    {
+      data = token.m_data;
+      size = 0;
+      return;
+    }
+  if (token.m_type != NdnbParser::NDN_BLOB && token.m_type != NdnbParser::NDN_UDATA)
+    throw NdnbParser::NdnbDecodingException ();
+
+  data = token.m_data;
+  size = token.m_size;
+
+  next (token);
+  if (token.m_type != NdnbParser::NDN_NO_TOKEN)
+    throw NdnbParser::NdnbDecodingException ();
+}
+
+uint32_t
+Reader::readNumber ()
+{
+  Token token;
+  next (token);
+  if (token.m_type != NdnbParser::NDN_UDATA || token.m_size == 0)
+    throw NdnbParser::NdnbDecodingException ();
+
+  uint64_t number = 0;
+  for (size_t i = 0; i < token.m_size; i++)
+    {
+      if (token.m_data[i] < '0' || token.m_data[i] > '9')
+        throw NdnbParser::NdnbDecodingException ();
+
+      number = number * 10 + (token.m_data[i] - '0');
+      if (number > 0xFFFFFFFF)
+        throw NdnbParser::NdnbDecodingException ();
+    }
+
+  next (token);
+  if (token.m_type != NdnbParser::NDN_NO_TOKEN)
+    throw NdnbParser::NdnbDecodingException ();
+
+  return static_cast<uint32_t> (number);
+}
+
+TimeInterval
+Reader::readTimestamp ()
+{
+  const unsigned char *data;
+  size_t size;
+  readValue (data, size);
+  if (size < 2 || size > 8)
+    throw NdnbParser::NdnbDecodingException ();
+
+  // all but the last 12 bits hold seconds, the last 12 bits hold fraction of a second
+  int64_t seconds = 0;
+  for (size_t i = 0; i < size - 2; i++)
+    {
+      seconds = (seconds << 8) | data[i];
+    }
+  seconds = (seconds << 4) | (data[size - 2] >> 4);
+  int64_t fraction = ((data[size - 2] & 0x0F) << 8) | data[size - 1];
+
+  return boost::posix_time::seconds (static_cast<long> (seconds)) +
+    boost::posix_time::microseconds (fraction * 1000000 / 4096);
+}
+
+void
+Reader::readComponents (Name &name)
+{
+  uint32_t dtag;
+  while (readChild (dtag))
+    {
+      if (dtag != NdnbParser::NDN_DTAG_Component)
+        throw NdnbParser::NdnbDecodingException ();
+
+      const unsigned char *data;
+      size_t size;
+      readValue (data, size);
+      name.append (data, size);
+    }
+}
+
+void
+Reader::readName (Name &name)
+{
+  readDtag (NdnbParser::NDN_DTAG_Name);
+  readComponents (name);
+}
+
+void
+Reader::skipRest ()
+{
+  int depth = 1;
+  do
+    {
+      Token token;
+      next (token);
+      switch (token.m_type)
+        {
+        case NdnbParser::NDN_NO_TOKEN:
+          depth --;
+          break;
+        case NdnbParser::NDN_DTAG:
+        case NdnbParser::NDN_TAG:
+        case NdnbParser::NDN_EXT:
+          depth ++;
+          break;
+        default: // BLOB, UDATA, and attributes have already been skipped
+          break;
+        }
+    }
+  while (depth > 0);
+}
+
+void
+Reader::skipElement ()
+{
+  Token token;
+  next (token);
+  switch (token.m_type)
+    {
+    case NdnbParser::NDN_DTAG:
+    case NdnbParser::NDN_TAG:
+    case NdnbParser::NDN_EXT:
+      skipRest ();
+      break;
+    case NdnbParser::NDN_NO_TOKEN: // closer of the parent, not an element
+      throw NdnbParser::NdnbDecodingException ();
+    default:
+      break;
+    }
+}
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
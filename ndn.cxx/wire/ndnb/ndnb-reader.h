@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_NDNB_READER_H
+#define NDN_WIRE_NDNB_READER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+
+#include "ndnb-parser/common.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+/**
+ * @brief Pull parser (cursor) over contiguous NDNB-encoded buffer
+ *
+ * Reader yields one token at a time: type of the block, its numeric value (dtag or length),
+ * and, for BLOB and UDATA, the span of the value inside the buffer.  Nothing is copied or
+ * allocated by the reader itself, decoders copy only the values they keep in the final objects.
+ *
+ * Methods that read the content of an element (readValue, readNumber, readTimestamp,
+ * readComponents, skipRest) are called right after the opening DTAG has been consumed (e.g.,
+ * by readChild) and consume everything up to and including the closer of the element.
+ *
+ * All methods throw NdnbParser::NdnbDecodingException if the buffer is truncated or malformed.
+ */
+class Reader
+{
+public:
+  /**
+   * @brief Single token of NDNB encoding
+   */
+  struct Token
+  {
+    NdnbParser::ndn_tt m_type;   ///< @brief type of the block, NDN_NO_TOKEN for the closer
+    size_t m_value;              ///< @brief dtag of DTAG/DATTR, size of BLOB/UDATA
+    const unsigned char *m_data; ///< @brief value of BLOB/UDATA, name of TAG/ATTR (points into the buffer)
+    size_t m_size;               ///< @brief size of the value (or name)
+  };
+
+  Reader (const void *buf, size_t length);
+
+  /**
+   * @brief Check if the whole buffer has been consumed
+   */
+  inline bool
+  atEnd () const;
+
+  /**
+   * @brief Get offset of the cursor from the beginning of the buffer
+   */
+  inline size_t
+  getOffset () const;
+
+  /**
+   * @brief Read next token and move cursor after it (and after the value of BLOB/UDATA)
+   */
+  inline void
+  next (Token &token);
+
+  /**
+   * @brief Read next token without moving the cursor
+   */
+  inline void
+  peek (Token &token) const;
+
+  /**
+   * @brief Read opening DTAG with the specific dtag value
+   */
+  void
+  readDtag (uint32_t dtag);
+
+  /**
+   * @brief Read opening DTAG of the next child element or the closer of the current element
+   * @param dtag (out) dtag of the child element
+   * @returns false if the closer has been read (no more children)
+   */
+  inline bool
+  readChild (uint32_t &dtag);
+
+  /**
+   * @brief Read content of BLOB or UDATA element (empty element has zero size)
+   * @param data (out) pointer to the value inside the buffer
+   * @param size (out) size of the value
+   */
+  void
+  readValue (const unsigned char *&data, size_t &size);
+
+  /**
+   * @brief Read content of the element holding a non-negative integer (UDATA with decimal digits)
+   */
+  uint32_t
+  readNumber ();
+
+  /**
+   * @brief Read content of the element holding a BLOB with the binary timestamp (12-bit fraction)
+   */
+  TimeInterval
+  readTimestamp ();
+
+  /**
+   * @brief Read components of the name element, components are appended to the name
+   */
+  void
+  readComponents (Name &name);
+
+  /**
+   * @brief Read <Name> element, components are appended to the name
+   */
+  void
+  readName (Name &name);
+
+  /**
+   * @brief Skip the rest of the current element, including its closer
+   */
+  void
+  skipRest ();
+
+  /**
+   * @brief Skip the whole element that starts at the cursor
+   */
+  void
+  skipElement ();
+
+private:
+  inline void
+  parse (const unsigned char *&p, Token &token) const;
+
+private:
+  const unsigned char *m_begin;
+  const unsigned char *m_pos;
+  const unsigned char *m_end;
+};
+
+inline bool
+Reader::atEnd () const
+{
+  return m_pos == m_end;
+}
+
+inline size_t
+Reader::getOffset () const
+{
+  return m_pos - m_begin;
+}
+
+inline void
+Reader::parse (const unsigned char *&p, Token &token) const
+{
+  if (p == m_end)
+    throw NdnbParser::NdnbDecodingException ();
+
+  token.m_data = 0;
+  token.m_size = 0;
+  if (*p == NdnbParser::NDN_CLOSE)
+    {
+      token.m_type = NdnbParser::NDN_NO_TOKEN;
+      token.m_value = 0;
+      p ++;
+      return;
+    }
+
+  // all but the last byte of the header have the high bit unset, the last one holds
+  // the 3-bit type and 4 least significant bits of the value
+  size_t value = 0;
+  for (size_t i = 0; !(*p & 0x80); i++)
+    {
+      if (i == 1 + 8 * ((sizeof (value) + 6) / 7) || p + 1 == m_end)
+        throw NdnbParser::NdnbDecodingException ();
+      value = (value << 7) | *p;
+      p ++;
+    }
+  token.m_value = (value << 4) | ((*p >> 3) & 0x0F);
+  token.m_type = static_cast<NdnbParser::ndn_tt> (*p & 0x07);
+  p ++;
+
+  switch (token.m_type)
+    {
+    case NdnbParser::NDN_BLOB:
+    case NdnbParser::NDN_UDATA:
+      token.m_size = token.m_value;
+      break;
+    case NdnbParser::NDN_TAG:
+    case NdnbParser::NDN_ATTR:
+      token.m_size = token.m_value + 1; // name follows the header
+      break;
+    case NdnbParser::NDN_DTAG:
+    case NdnbParser::NDN_DATTR:
+    case NdnbParser::NDN_EXT:
+      return;
+    default:
+      throw NdnbParser::NdnbDecodingException ();
+    }
+
+  if (static_cast<size_t> (m_end - p) < token.m_size)
+    throw NdnbParser::NdnbDecodingException ();
+  token.m_data = p;
+  p += token.m_size;
+}
+
+inline void
+Reader::next (Token &token)
+{
+  parse (m_pos, token);
+}
+
+inline void
+Reader::peek (Token &token) const
+{
+  const unsigned char *p = m_pos;
+  parse (p, token);
+}
+
+inline bool
+Reader::readChild (uint32_t &dtag)
+{
+  Token token;
+  next (token);
+  if (token.m_type == NdnbParser::NDN_NO_TOKEN)
+    return false;
+  if (token.m_type != NdnbParser::NDN_DTAG)
+    throw NdnbParser::NdnbDecodingException ();
+
+  dtag = token.m_value;
+  return true;
+}
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_NDNB_READER_H
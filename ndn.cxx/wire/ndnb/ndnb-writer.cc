@@ -0,0 +1,419 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "ndnb-writer.h"
+#include "wire-ndnb-data.h"
+
+#include "ndn.cxx/error.h"
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+// pairs of decimal digits of 0..99, numbers are formatted two digits at a time
+static const char DIGITS[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static size_t
+countDigits (uint32_t number)
+{
+  size_t digits = 1;
+  for (; number >= 10; number /= 10)
+    digits ++;
+  return digits;
+}
+
+size_t
+Writer::EstimateNumber (uint32_t number)
+{
+  size_t digits = countDigits (number);
+  return EstimateBlockHeader (digits) + digits;
+}
+
+void
+Writer::AppendNumber (unsigned char *&p, uint32_t number)
+{
+  size_t digits = countDigits (number);
+  AppendBlockHeader (p, digits, NdnbParser::NDN_UDATA);
+
+  unsigned char *end = p + digits;
+  unsigned char *digit = end;
+  while (number >= 100)
+    {
+      const char *pair = DIGITS + 2 * (number % 100);
+      *--digit = pair[1];
+      *--digit = pair[0];
+      number /= 100;
+    }
+  if (number >= 10)
+    {
+      *--digit = DIGITS[2 * number + 1];
+      *--digit = DIGITS[2 * number];
+    }
+  else
+    *--digit = '0' + number;
+
+  p = end;
+}
+
+size_t
+Writer::EstimateTaggedNumber (uint32_t dtag, uint32_t number)
+{
+  return EstimateBlockHeader (dtag) + EstimateNumber (number) + 1;
+}
+
+void
+Writer::AppendTaggedNumber (unsigned char *&p, uint32_t dtag, uint32_t number)
+{
+  AppendBlockHeader (p, dtag, NdnbParser::NDN_DTAG);
+  AppendNumber (p, number);
+  AppendCloser (p);
+}
+
+void
+Writer::AppendTaggedBlobWithPadding (unsigned char *&p, uint32_t dtag, size_t length, const void *data, size_t size)
+{
+  if (size >= length)
+    {
+      // no padding required
+      AppendTaggedBlob (p, dtag, data, size);
+      return;
+    }
+
+  AppendBlockHeader (p, dtag, NdnbParser::NDN_DTAG);
+  AppendBlockHeader (p, length, NdnbParser::NDN_BLOB);
+  if (size > 0)
+    memcpy (p, data, size);
+  memset (p + size, 0, length - size);
+  p += length;
+  AppendCloser (p);
+}
+
+/**
+ * @brief Get number of bytes of the timestamp: 12 bits for fractions of a second and at least 4 bits for seconds
+ */
+static int
+timestampBytes (const TimeInterval &time)
+{
+  int bytes = 2;
+  intmax_t ts = time.total_seconds () >> 4;
+  for (; bytes < 7 && ts != 0; ts >>= 8) // not more than 6 bytes?
+    bytes++;
+  return bytes;
+}
+
+size_t
+Writer::EstimateTimestampBlob (const TimeInterval &time)
+{
+  int bytes = timestampBytes (time);
+  return EstimateBlockHeader (bytes) + bytes;
+}
+
+void
+Writer::AppendTimestampBlob (unsigned char *&p, const TimeInterval &time)
+{
+  int bytes = timestampBytes (time);
+  AppendBlockHeader (p, bytes, NdnbParser::NDN_BLOB);
+
+  // part with seconds
+  intmax_t ts = time.total_seconds () >> 4;
+  for (int i = 0; i < bytes - 2; i++)
+    *p++ = ts >> (8 * (bytes - 3 - i));
+
+  /* arithmetic contortions are to avoid overflowing 31 bits */
+  ts = ((time.total_seconds () & 15) << 12) +
+    (((time.total_nanoseconds () % 1000000000) / 5 * 8 + 195312) / 390625);
+  *p++ = ts >> 8;
+  *p++ = ts;
+}
+
+size_t
+Writer::EstimateName (const Name &name)
+{
+  size_t size = EstimateBlockHeader (NdnbParser::NDN_DTAG_Name) + 1;
+  for (Name::const_iterator component = name.begin (); component != name.end (); component++)
+    {
+      size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_Component, component->size ());
+    }
+  return size;
+}
+
+void
+Writer::AppendName (unsigned char *&p, const Name &name)
+{
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Name, NdnbParser::NDN_DTAG); // <Name>
+  for (Name::const_iterator component = name.begin (); component != name.end (); component++)
+    {
+      AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Component, component->buf (), component->size ());
+    }
+  AppendCloser (p);                                                      // </Name>
+}
+
+size_t
+Writer::EstimateInterest (const ndn::Interest &interest)
+{
+  size_t size = EstimateBlockHeader (NdnbParser::NDN_DTAG_Interest) + 1;
+  size += EstimateName (interest.getName ());
+
+  if (interest.getMinSuffixComponents () != ndn::Interest::ncomps)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_MinSuffixComponents, interest.getMinSuffixComponents ());
+  if (interest.getMaxSuffixComponents () != ndn::Interest::ncomps)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_MaxSuffixComponents, interest.getMaxSuffixComponents ());
+  if (interest.getExclude ().size () > 0)
+    {
+      size += EstimateBlockHeader (NdnbParser::NDN_DTAG_Exclude) + 1;
+      for (Exclude::const_reverse_iterator item = interest.getExclude ().rbegin (); item != interest.getExclude ().rend (); item++)
+        {
+          if (!item->first.empty ())
+            size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_Component, item->first.size ());
+          if (item->second)
+            size += EstimateBlockHeader (NdnbParser::NDN_DTAG_Any) + 1;
+        }
+    }
+  if (interest.getChildSelector () != ndn::Interest::CHILD_DEFAULT)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_ChildSelector, interest.getChildSelector ());
+  if (interest.getAnswerOriginKind () != ndn::Interest::AOK_DEFAULT)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_AnswerOriginKind, interest.getAnswerOriginKind ());
+  if (interest.getScope () != ndn::Interest::NO_SCOPE)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_Scope, interest.getScope ());
+  if (!interest.getInterestLifetime ().is_negative ())
+    size += EstimateBlockHeader (NdnbParser::NDN_DTAG_InterestLifetime) + EstimateTimestampBlob (interest.getInterestLifetime ()) + 1;
+
+  return size;
+}
+
+static void
+appendInterestFields (unsigned char *&p, const ndn::Interest &interest)
+{
+  Writer::AppendName (p, interest.getName ());
+
+  if (interest.getMinSuffixComponents () != ndn::Interest::ncomps)
+    Writer::AppendTaggedNumber (p, NdnbParser::NDN_DTAG_MinSuffixComponents, interest.getMinSuffixComponents ());
+  if (interest.getMaxSuffixComponents () != ndn::Interest::ncomps)
+    Writer::AppendTaggedNumber (p, NdnbParser::NDN_DTAG_MaxSuffixComponents, interest.getMaxSuffixComponents ());
+  if (interest.getExclude ().size () > 0)
+    {
+      Writer::AppendBlockHeader (p, NdnbParser::NDN_DTAG_Exclude, NdnbParser::NDN_DTAG); // <Exclude>
+      for (Exclude::const_reverse_iterator item = interest.getExclude ().rbegin (); item != interest.getExclude ().rend (); item++)
+        {
+          if (!item->first.empty ())
+            Writer::AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Component, item->first.buf (), item->first.size ());
+          if (item->second)
+            {
+              Writer::AppendBlockHeader (p, NdnbParser::NDN_DTAG_Any, NdnbParser::NDN_DTAG); // <Any>
+              Writer::AppendCloser (p);                                                     // </Any>
+            }
+        }
+      Writer::AppendCloser (p); // </Exclude>
+    }
+  if (interest.getChildSelector () != ndn::Interest::CHILD_DEFAULT)
+    Writer::AppendTaggedNumber (p, NdnbParser::NDN_DTAG_ChildSelector, interest.getChildSelector ());
+  if (interest.getAnswerOriginKind () != ndn::Interest::AOK_DEFAULT)
+    Writer::AppendTaggedNumber (p, NdnbParser::NDN_DTAG_AnswerOriginKind, interest.getAnswerOriginKind ());
+  if (interest.getScope () != ndn::Interest::NO_SCOPE)
+    Writer::AppendTaggedNumber (p, NdnbParser::NDN_DTAG_Scope, interest.getScope ());
+  if (!interest.getInterestLifetime ().is_negative ())
+    {
+      Writer::AppendBlockHeader (p, NdnbParser::NDN_DTAG_InterestLifetime, NdnbParser::NDN_DTAG);
+      Writer::AppendTimestampBlob (p, interest.getInterestLifetime ());
+      Writer::AppendCloser (p);
+    }
+}
+
+void
+Writer::AppendInterest (unsigned char *&p, const ndn::Interest &interest)
+{
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Interest, NdnbParser::NDN_DTAG); // <Interest>
+  appendInterestFields (p, interest);
+  AppendCloser (p); // </Interest>
+}
+
+size_t
+Writer::EstimateInterestWithNonce (const ndn::Interest &interest)
+{
+  return EstimateInterest (interest) + EstimateTaggedBlob (NdnbParser::NDN_DTAG_Nonce, sizeof (uint32_t));
+}
+
+void
+Writer::AppendInterest (unsigned char *&p, const ndn::Interest &interest, uint32_t nonce, unsigned char *&nonceValue)
+{
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Interest, NdnbParser::NDN_DTAG); // <Interest>
+  appendInterestFields (p, interest);
+  AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Nonce, &nonce, sizeof (nonce));
+  nonceValue = p - 1 - sizeof (nonce); // value is followed by </Nonce>
+  AppendCloser (p); // </Interest>
+}
+
+static const signature::Sha256WithRsa &
+getSignature (const ndn::Data &data)
+{
+  const signature::Sha256WithRsa *signature = dynamic_cast<const signature::Sha256WithRsa *> (data.getSignature ().get ());
+  if (signature == 0)
+    BOOST_THROW_EXCEPTION (error::wire::Ndnb ()
+                           << error::msg ("Sha256WithRsa signature is required, but not set"));
+  return *signature;
+}
+
+size_t
+Writer::EstimateUnsignedData (const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+
+  size_t size = EstimateName (data.getName ());
+
+  size += EstimateBlockHeader (NdnbParser::NDN_DTAG_SignedInfo) + 1;
+  size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_PublisherPublicKeyDigest, signature.getPublisherKeyDigest ().size ());
+  size += EstimateBlockHeader (NdnbParser::NDN_DTAG_Timestamp) +
+    EstimateTimestampBlob (data.getContent ().getTimestamp () - time::UNIX_EPOCH_TIME) + 1;
+  if (data.getContent ().getType () != Content::DATA)
+    size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_Type, 3);
+  if (data.getContent ().getFreshness () > Content::noFreshness)
+    size += EstimateTaggedNumber (NdnbParser::NDN_DTAG_FreshnessSeconds, data.getContent ().getFreshness ().total_seconds ());
+  if (data.getContent ().getFinalBlockId () != Content::noFinalBlock)
+    size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_FinalBlockID, data.getContent ().getFinalBlockId ().size ());
+  size += EstimateBlockHeader (NdnbParser::NDN_DTAG_KeyLocator) + EstimateBlockHeader (NdnbParser::NDN_DTAG_KeyName) +
+    EstimateName (signature.getKeyLocator ().getKeyName ()) + 2;
+
+  size += EstimateTaggedBlob (NdnbParser::NDN_DTAG_Content, data.content ().size ());
+  return size;
+}
+
+void
+Writer::AppendUnsignedData (unsigned char *&p, const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+
+  AppendName (p, data.getName ());
+
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_SignedInfo, NdnbParser::NDN_DTAG); // <SignedInfo>
+  {
+    AppendTaggedBlob (p, NdnbParser::NDN_DTAG_PublisherPublicKeyDigest,
+                      signature.getPublisherKeyDigest ().buf (), signature.getPublisherKeyDigest ().size ());
+
+    AppendBlockHeader (p, NdnbParser::NDN_DTAG_Timestamp, NdnbParser::NDN_DTAG); // <Timestamp>
+    AppendTimestampBlob (p, data.getContent ().getTimestamp () - time::UNIX_EPOCH_TIME);
+    AppendCloser (p);                                                          // </Timestamp>
+
+    if (data.getContent ().getType () != Content::DATA)
+      {
+        uint32_t type = Data::fromType (data.getContent ().getType ());
+        const unsigned char typeBytes[] = { static_cast<unsigned char> (type >> 16),
+                                            static_cast<unsigned char> (type >> 8),
+                                            static_cast<unsigned char> (type) };
+        AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Type, typeBytes, sizeof (typeBytes));
+      }
+
+    if (data.getContent ().getFreshness () > Content::noFreshness)
+      AppendTaggedNumber (p, NdnbParser::NDN_DTAG_FreshnessSeconds, data.getContent ().getFreshness ().total_seconds ());
+
+    if (data.getContent ().getFinalBlockId () != Content::noFinalBlock)
+      {
+        const name::Component &finalBlockId = data.getContent ().getFinalBlockId ();
+        AppendTaggedBlob (p, NdnbParser::NDN_DTAG_FinalBlockID, finalBlockId.buf (), finalBlockId.size ());
+      }
+
+    AppendBlockHeader (p, NdnbParser::NDN_DTAG_KeyLocator, NdnbParser::NDN_DTAG); // <KeyLocator>
+    AppendBlockHeader (p, NdnbParser::NDN_DTAG_KeyName, NdnbParser::NDN_DTAG);    // <KeyName>
+    AppendName (p, signature.getKeyLocator ().getKeyName ());
+    AppendCloser (p);                                                           // </KeyName>
+    AppendCloser (p);                                                           // </KeyLocator>
+  }
+  AppendCloser (p); // </SignedInfo>
+
+  AppendTaggedBlob (p, NdnbParser::NDN_DTAG_Content, data.content ().buf (), data.content ().size ());
+}
+
+size_t
+Writer::EstimateData (const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+
+  size_t size = EstimateBlockHeader (NdnbParser::NDN_DTAG_Data) + 1;
+  size += EstimateBlockHeader (NdnbParser::NDN_DTAG_Signature) + 1;
+  size += EstimateTaggedBlobWithPadding (NdnbParser::NDN_DTAG_SignatureBits, 16, signature.getSignatureBits ().size ());
+
+  if (data.getSignedBlob ())
+    size += data.getSignedBlob ()->signed_size ();
+  else
+    size += EstimateUnsignedData (data);
+
+  return size;
+}
+
+void
+Writer::AppendData (unsigned char *&p, const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Data, NdnbParser::NDN_DTAG);           // <ContentObject>
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Signature, NdnbParser::NDN_DTAG);      // <Signature>
+  AppendTaggedBlobWithPadding (p, NdnbParser::NDN_DTAG_SignatureBits, 16,
+                               signature.getSignatureBits ().buf (), signature.getSignatureBits ().size ());
+  AppendCloser (p);                                                                // </Signature>
+
+  if (data.getSignedBlob ())
+    {
+      memcpy (p, data.getSignedBlob ()->signed_buf (), data.getSignedBlob ()->signed_size ());
+      p += data.getSignedBlob ()->signed_size ();
+    }
+  else
+    AppendUnsignedData (p, data);
+
+  AppendCloser (p); // </ContentObject>
+}
+
+size_t
+Writer::EstimateDataForSigning (const ndn::Data &data, size_t reserve)
+{
+  size_t size = EstimateBlockHeader (NdnbParser::NDN_DTAG_Data) + 1;
+  size += EstimateBlockHeader (NdnbParser::NDN_DTAG_Signature) + 1;
+  size += EstimateTaggedBlobWithPadding (NdnbParser::NDN_DTAG_SignatureBits, 16, reserve);
+  size += EstimateUnsignedData (data);
+
+  return size;
+}
+
+void
+Writer::AppendDataForSigning (unsigned char *&p, const ndn::Data &data, size_t reserve,
+                              unsigned char *&signatureBits, unsigned char *&signedPortion)
+{
+  size_t length = std::max (reserve, static_cast<size_t> (16));
+
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Data, NdnbParser::NDN_DTAG);           // <ContentObject>
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_Signature, NdnbParser::NDN_DTAG);      // <Signature>
+  AppendBlockHeader (p, NdnbParser::NDN_DTAG_SignatureBits, NdnbParser::NDN_DTAG);  // <SignatureBits>
+  AppendBlockHeader (p, length, NdnbParser::NDN_BLOB);
+  signatureBits = p;
+  memset (p, 0, length);
+  p += length;
+  AppendCloser (p);                                                                // </SignatureBits>
+  AppendCloser (p);                                                                // </Signature>
+
+  signedPortion = p;
+  AppendUnsignedData (p, data);
+
+  AppendCloser (p); // </ContentObject>
+}
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
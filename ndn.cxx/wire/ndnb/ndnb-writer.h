@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_NDNB_WRITER_H
+#define NDN_WIRE_NDNB_WRITER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/data.h"
+
+#include "ndnb-parser/common.h"
+
+#include <algorithm>
+#include <cstring>
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace ndnb {
+
+/**
+ * @brief NDNB encoder writing with raw pointer writes into a preallocated buffer
+ *
+ * Every Append method has a matching Estimate method returning the exact number of bytes the
+ * Append method writes, so the whole packet is encoded into one buffer of the exact size (a Blob,
+ * an ndnx charbuf, or caller memory) without streams and intermediate reallocations:
+ *
+ *     Blob wire (Writer::EstimateData (data));
+ *     unsigned char *p = reinterpret_cast<unsigned char *> (&wire[0]);
+ *     Writer::AppendData (p, data);
+ *
+ * Encoding is byte-for-byte the same as of the stream-based encoders (wire::ndnb::Data,
+ * wire::ndnb::Interest, and wire::Ndnb::appendInterest).  Append methods move the pointer
+ * right after the written bytes.
+ */
+class Writer
+{
+public:
+  inline static size_t
+  EstimateBlockHeader (size_t value);
+
+  inline static void
+  AppendBlockHeader (unsigned char *&p, size_t value, NdnbParser::ndn_tt type);
+
+  inline static void
+  AppendCloser (unsigned char *&p);
+
+  /**
+   * @brief Estimate size of the number in NDNB encoding (UDATA with decimal digits)
+   */
+  static size_t
+  EstimateNumber (uint32_t number);
+
+  static void
+  AppendNumber (unsigned char *&p, uint32_t number);
+
+  static size_t
+  EstimateTaggedNumber (uint32_t dtag, uint32_t number);
+
+  static void
+  AppendTaggedNumber (unsigned char *&p, uint32_t dtag, uint32_t number);
+
+  /**
+   * @brief Estimate size of the tagged BLOB (empty BLOB is encoded without BLOB header)
+   */
+  inline static size_t
+  EstimateTaggedBlob (uint32_t dtag, size_t size);
+
+  inline static void
+  AppendTaggedBlob (unsigned char *&p, uint32_t dtag, const void *data, size_t size);
+
+  /**
+   * @brief Estimate size of the tagged BLOB, padded with zeros if it is shorter than length
+   */
+  inline static size_t
+  EstimateTaggedBlobWithPadding (uint32_t dtag, size_t length, size_t size);
+
+  static void
+  AppendTaggedBlobWithPadding (unsigned char *&p, uint32_t dtag, size_t length, const void *data, size_t size);
+
+  /**
+   * @brief Estimate size of the binary timestamp BLOB (12-bit fraction)
+   */
+  static size_t
+  EstimateTimestampBlob (const TimeInterval &time);
+
+  static void
+  AppendTimestampBlob (unsigned char *&p, const TimeInterval &time);
+
+  /**
+   * @brief Estimate size of the <Name> element
+   */
+  static size_t
+  EstimateName (const Name &name);
+
+  static void
+  AppendName (unsigned char *&p, const Name &name);
+
+  /**
+   * @brief Estimate size of the Interest (with name and exclude filter)
+   */
+  static size_t
+  EstimateInterest (const ndn::Interest &interest);
+
+  static void
+  AppendInterest (unsigned char *&p, const ndn::Interest &interest);
+
+  /**
+   * @brief Estimate size of the Interest with Nonce
+   */
+  static size_t
+  EstimateInterestWithNonce (const ndn::Interest &interest);
+
+  /**
+   * @brief Append Interest with Nonce (the last field of Interest in NDNB)
+   * @param nonceValue (out) position of the Nonce value, which can be patched before sending
+   */
+  static void
+  AppendInterest (unsigned char *&p, const ndn::Interest &interest, uint32_t nonce, unsigned char *&nonceValue);
+
+  /**
+   * @brief Estimate size of the Data packet (signature is required)
+   *
+   * If data has the signed blob, the signed portion is written as is
+   */
+  static size_t
+  EstimateData (const ndn::Data &data);
+
+  static void
+  AppendData (unsigned char *&p, const ndn::Data &data);
+
+  /**
+   * @brief Estimate size of the Data packet with space reserved for signature bits
+   *
+   * Signature bits and the signed blob of data are ignored, the signed portion is encoded from
+   * the fields
+   */
+  static size_t
+  EstimateDataForSigning (const ndn::Data &data, size_t reserve);
+
+  /**
+   * @brief Append Data packet with zeroed space reserved for signature bits (padded as by AppendData)
+   * @param signatureBits (out) beginning of the reserved space, to be patched after signing
+   * @param signedPortion (out) beginning of the signed portion (it ends right before the last byte)
+   */
+  static void
+  AppendDataForSigning (unsigned char *&p, const ndn::Data &data, size_t reserve,
+                        unsigned char *&signatureBits, unsigned char *&signedPortion);
+
+  /**
+   * @brief Estimate size of the unsigned portion of the Data packet (Name, SignedInfo, and Content)
+   */
+  static size_t
+  EstimateUnsignedData (const ndn::Data &data);
+
+  static void
+  AppendUnsignedData (unsigned char *&p, const ndn::Data &data);
+};
+
+inline size_t
+Writer::EstimateBlockHeader (size_t value)
+{
+  value >>= 4;
+  size_t n = 1;
+  while (value > 0)
+    {
+      value >>= 7;
+      n++;
+    }
+  return n;
+}
+
+inline void
+Writer::AppendBlockHeader (unsigned char *&p, size_t value, NdnbParser::ndn_tt type)
+{
+  // 7-bit groups are written from the end, the last byte holds the high bit, the 3-bit type,
+  // and 4 least significant bits of the value
+  size_t n = EstimateBlockHeader (value);
+  p[n - 1] = 0x80 | ((value & 0x0F) << 3) | (type & 0x07);
+  value >>= 4;
+  for (size_t i = n - 1; i > 0; i--)
+    {
+      p[i - 1] = value & 0x7F;
+      value >>= 7;
+    }
+  p += n;
+}
+
+inline void
+Writer::AppendCloser (unsigned char *&p)
+{
+  *p++ = NdnbParser::NDN_CLOSE;
+}
+
+inline size_t
+Writer::EstimateTaggedBlob (uint32_t dtag, size_t size)
+{
+  if (size > 0)
+    return EstimateBlockHeader (dtag) + EstimateBlockHeader (size) + size + 1;
+  else
+    return EstimateBlockHeader (dtag) + 1;
+}
+
+inline void
+Writer::AppendTaggedBlob (unsigned char *&p, uint32_t dtag, const void *data, size_t size)
+{
+  AppendBlockHeader (p, dtag, NdnbParser::NDN_DTAG);
+  if (size > 0)
+    {
+      AppendBlockHeader (p, size, NdnbParser::NDN_BLOB);
+      memcpy (p, data, size);
+      p += size;
+    }
+  AppendCloser (p);
+}
+
+inline size_t
+Writer::EstimateTaggedBlobWithPadding (uint32_t dtag, size_t length, size_t size)
+{
+  return EstimateTaggedBlob (dtag, std::max (length, size));
+}
+
+} // ndnb
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_NDNB_WRITER_H
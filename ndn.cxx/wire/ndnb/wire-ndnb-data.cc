@@ -10,6 +10,8 @@
 
 #include "wire-ndnb-data.h"
 #include "wire-ndnb.h"
+#include "ndnb-reader.h"
+#include "ndn.cxx/wire/iovec-list.h"
 
 #include "ndn.cxx/fields/signature-sha256-with-rsa.h"
 #include "ndn.cxx/fields/key-locator.h"
@@ -35,8 +37,11 @@ NDN_NAMESPACE_BEGIN
 namespace wire {
 namespace ndnb {
 
-  void 
-  Data::SerializeUnsigned (const ndn::Data &data, OutputIterator &start)
+  /**
+   * @brief Serialize Name, SignedInfo, and everything of Content except the payload and the closing tag
+   */
+  static void
+  SerializeUnsignedHeader (const ndn::Data &data, OutputIterator &start)
   {
     Ptr<const Signature> sig = data.getSignature();
 
@@ -68,6 +73,26 @@ namespace ndnb {
         Ndnb::AppendTimestampBlob (start, ti);
         Ndnb::AppendCloser (start); //</Timestamp>
       }
+      if (data.getContent().getType() != Content::DATA)
+      {
+        uint32_t type = Data::fromType (data.getContent().getType());
+        const uint8_t typeBytes[] = { static_cast<uint8_t> (type >> 16), static_cast<uint8_t> (type >> 8), static_cast<uint8_t> (type) };
+        Ndnb::AppendTaggedBlob(start, NdnbParser::NDN_DTAG_Type, typeBytes, 3); // <Type>
+      }
+      if (data.getContent().getFreshness() > Content::noFreshness)
+      {
+        Ndnb::AppendTaggedNumber(start, NdnbParser::NDN_DTAG_FreshnessSeconds,
+                                 data.getContent().getFreshness().total_seconds()); // <FreshnessSeconds>
+      }
+      if (data.getContent().getFinalBlockId() != Content::noFinalBlock)
+      {
+        // _LOG_DEBUG("Append FinalBlockID!");
+        const name::Component &finalBlockId = data.getContent().getFinalBlockId();
+        Ndnb::AppendTaggedBlob(start,
+                               NdnbParser::NDN_DTAG_FinalBlockID,
+                               reinterpret_cast<const uint8_t*>(finalBlockId.buf()),
+                               finalBlockId.size()); //<FinalBlockID>
+      }
       {
         // _LOG_DEBUG("Append KeyLocator!");
         Ndnb::AppendBlockHeader(start, NdnbParser::NDN_DTAG_KeyLocator, NdnbParser::NDN_DTAG); // <KeyLocator>
@@ -91,14 +116,35 @@ namespace ndnb {
       uint32_t payloadSize = data.content().size();
       if (payloadSize > 0){
         Ndnb::AppendBlockHeader (start, payloadSize, NdnbParser::NDN_BLOB);
-        start.Write(reinterpret_cast<const uint8_t*>(data.content().buf()), data.content().size());
         // _LOG_DEBUG("payLoadSize: " << payloadSize);
       }
-
-      Ndnb::AppendCloser(start); // </Content>
     }
   }
 
+  void 
+  Data::SerializeUnsigned (const ndn::Data &data, OutputIterator &start)
+  {
+    SerializeUnsignedHeader (data, start);
+
+    const Blob &payload = data.content();
+    if (payload.size() > 0)
+      start.Write(reinterpret_cast<const uint8_t*>(payload.buf()), payload.size());
+
+    Ndnb::AppendCloser(start); // </Content>
+  }
+
+  void
+  Data::SerializeUnsigned (const ndn::Data &data, IovecList &list)
+  {
+    SerializeUnsignedHeader (data, reinterpret_cast<OutputIterator &> (list.getStream ()));
+
+    const Blob &payload = data.content();
+    if (payload.size() > 0)
+      list.appendReference (payload.buf(), payload.size()); // payload is not copied
+
+    Ndnb::AppendCloser(reinterpret_cast<OutputIterator &> (list.getStream ())); // </Content>
+  }
+
   void
   Data::Serialize (const ndn::Data &data, OutputIterator &start)
   {
@@ -133,6 +179,44 @@ namespace ndnb {
     Ndnb::AppendCloser(start);// </Data>
   }
 
+  void
+  Data::Serialize (const ndn::Data &data, IovecList &list)
+  {
+    OutputIterator &start = reinterpret_cast<OutputIterator &> (list.getStream ());
+
+    Ptr<const signature::Sha256WithRsa> sha256sig = DynamicCast<const signature::Sha256WithRsa>(data.getSignature());
+    const Blob &sigBits = sha256sig->getSignatureBits();
+
+    Ndnb::AppendBlockHeader(start, NdnbParser::NDN_DTAG_Data, NdnbParser::NDN_DTAG); // <Data>
+    {
+      Ndnb::AppendBlockHeader(start, NdnbParser::NDN_DTAG_Signature, NdnbParser::NDN_DTAG); //<Signature>
+      if (sigBits.size() > 16)
+        {
+          // same encoding as AppendTaggedBlobWithPadding, as no padding is required
+          Ndnb::AppendBlockHeader(start, NdnbParser::NDN_DTAG_SignatureBits, NdnbParser::NDN_DTAG); //<SignatureBits>
+          Ndnb::AppendBlockHeader(start, sigBits.size(), NdnbParser::NDN_BLOB);
+          list.appendReference (sigBits.buf(), sigBits.size());
+          Ndnb::AppendCloser(start); //</SignatureBits>
+        }
+      else
+        {
+          Ndnb::AppendTaggedBlobWithPadding(start, 
+                                            NdnbParser::NDN_DTAG_SignatureBits, 
+                                            16, 
+                                            reinterpret_cast<const uint8_t*>(sigBits.size() > 0 ? sigBits.buf() : 0), 
+                                            sigBits.size()); //<SignatureBits>
+        }
+      Ndnb::AppendCloser(start); //</Signature>
+    }
+
+    if(data.getSignedBlob() == NULL)
+      SerializeUnsigned (data, list);
+    else
+      list.appendReference (data.getSignedBlob()->signed_buf(), data.getSignedBlob()->signed_size());
+
+    Ndnb::AppendCloser(start);// </Data>
+  }
+
   class DataVisitor : public NdnbParser::VoidDepthFirstVisitor
   {
   public:
@@ -142,9 +226,9 @@ namespace ndnb {
   void
   DataVisitor::visit (NdnbParser::Dtag &n, boost::any param)
   {
-    static NdnbParser::NameVisitor nameVisitor;
-    static NdnbParser::TimestampVisitor timestampVisitor;
-    static NdnbParser::ContentTypeVisitor contentTypeVisitor;
+    NdnbParser::NameVisitor nameVisitor;
+    NdnbParser::TimestampVisitor timestampVisitor;
+    NdnbParser::ContentTypeVisitor contentTypeVisitor;
 
     ndn::Data *m_data = boost::any_cast<ndn::Data*> (param);
 
@@ -236,8 +320,15 @@ namespace ndnb {
       m_data->getContent().setFreshness();
       break;
     case NdnbParser::NDN_DTAG_FinalBlockID:
-      // _LOG_DEBUG ("NDN_DTAG_FinalBlockID");
-      break;
+      {
+        // _LOG_DEBUG ("NDN_DTAG_FinalBlockID");
+        if (n.m_nestedTags.size()!=1) // should be exactly one BLOB inside this tag
+          throw NdnbParser::NdnbDecodingException ();
+
+        Ptr<NdnbParser::Blob> finalBlockId = boost::dynamic_pointer_cast<NdnbParser::Blob>(*n.m_nestedTags.begin());
+        m_data->getContent().setFinalBlockId(name::Component(finalBlockId->m_blob, finalBlockId->m_blobSize));
+        break;
+      }
     case NdnbParser::NDN_DTAG_KeyLocator:
       // _LOG_DEBUG ("KeyLocator");
       BOOST_FOREACH (Ptr<NdnbParser::Block> block, n.m_nestedTags)
@@ -261,6 +352,12 @@ namespace ndnb {
       {
         // _LOG_DEBUG ("Content");
 
+        if (n.m_nestedTags.empty()) // empty content is encoded without BLOB
+          {
+            m_data->getContent().setContent(Blob());
+            break;
+          }
+
         if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
           throw NdnbParser::NdnbDecodingException ();
         
@@ -293,16 +390,267 @@ namespace ndnb {
     }
   }
 
+  uint32_t
+  Data::fromType (ndn::Content::Type type)
+  {
+    static const uint32_t TYPES[] = { 0x0C04C0, 0x10D091, 0x18E344, 0x28463F, 0x2C834A, 0x34008A };
+    BOOST_ASSERT (static_cast<size_t> (type) < sizeof (TYPES) / sizeof (TYPES[0]));
+    return TYPES[type];
+  }
+
 
   void
   Data::Deserialize (Ptr<ndn::Data> data, InputIterator &start)
   {
-    static DataVisitor dataVisitor;
+    DataVisitor dataVisitor;
 
     Ptr<NdnbParser::Block> root = NdnbParser::Block::ParseBlock (start);
     root->accept (dataVisitor, GetPointer (data));
   }
 
+  static void
+  ReadKeyLocator (KeyLocator &keyLocator, Reader &reader)
+  {
+    const unsigned char *value;
+    size_t size;
+    uint32_t dtag;
+    while (reader.readChild (dtag))
+      {
+        switch (dtag)
+          {
+          case NdnbParser::NDN_DTAG_Key:
+            reader.readValue (value, size);
+            keyLocator.setType (KeyLocator::KEY);
+            keyLocator.getKey ().assign (value, value + size);
+            break;
+          case NdnbParser::NDN_DTAG_Certificate:
+            reader.readValue (value, size);
+            keyLocator.setType (KeyLocator::CERTIFICATE);
+            keyLocator.getCertificate ().assign (value, value + size);
+            break;
+          case NdnbParser::NDN_DTAG_KeyName:
+            keyLocator.setType (KeyLocator::KEYNAME);
+            while (reader.readChild (dtag))
+              {
+                if (dtag == NdnbParser::NDN_DTAG_Name)
+                  reader.readComponents (keyLocator.getKeyName ());
+                else
+                  reader.skipRest (); // publisher ID
+              }
+            break;
+          default:
+            reader.skipRest ();
+            break;
+          }
+      }
+  }
+
+  static void
+  ReadSignedInfo (ndn::Data &data, signature::Sha256WithRsa &signature, Reader &reader, bool withKeyLocator)
+  {
+    const unsigned char *value;
+    size_t size;
+    uint32_t dtag;
+    while (reader.readChild (dtag))
+      {
+        switch (dtag)
+          {
+          case NdnbParser::NDN_DTAG_PublisherPublicKeyDigest:
+            reader.readValue (value, size);
+            signature.getPublisherKeyDigest ().assign (value, value + size);
+            break;
+          case NdnbParser::NDN_DTAG_Timestamp:
+            data.getContent ().setTimeStamp (time::UNIX_EPOCH_TIME + reader.readTimestamp ());
+            break;
+          case NdnbParser::NDN_DTAG_Type:
+            reader.readValue (value, size);
+            if (size != 3)
+              throw NdnbParser::NdnbDecodingException ();
+            data.getContent ().setType (Data::toType ((value[0] << 16) | (value[1] << 8) | value[2]));
+            break;
+          case NdnbParser::NDN_DTAG_FreshnessSeconds:
+            data.getContent ().setFreshness (boost::posix_time::seconds (reader.readNumber ()));
+            break;
+          case NdnbParser::NDN_DTAG_FinalBlockID:
+            reader.readValue (value, size);
+            data.getContent ().setFinalBlockId (name::Component (value, size));
+            break;
+          case NdnbParser::NDN_DTAG_KeyLocator:
+            if (withKeyLocator)
+              ReadKeyLocator (signature.getKeyLocator (), reader);
+            else
+              reader.skipRest ();
+            break;
+          default:
+            reader.skipRest ();
+            break;
+          }
+      }
+  }
+
+  void
+  Data::Decode (ndn::Data &data, const void *buf, size_t length)
+  {
+    Range signedPortion;
+    Decode (data, buf, length, signedPortion);
+  }
+
+  void
+  Data::Decode (ndn::Data &data, const void *buf, size_t length, Range &signedPortion)
+  {
+    Ptr<signature::Sha256WithRsa> signature = Ptr<signature::Sha256WithRsa>::Create ();
+
+    Reader reader (buf, length);
+    reader.readDtag (NdnbParser::NDN_DTAG_Data);
+
+    const unsigned char *value;
+    size_t size;
+    uint32_t dtag;
+    size_t offset = reader.getOffset ();
+    size_t signedOffset = 0;
+    while (reader.readChild (dtag))
+      {
+        if (dtag != NdnbParser::NDN_DTAG_Signature && signedOffset == 0)
+          signedOffset = offset;
+
+        switch (dtag)
+          {
+          case NdnbParser::NDN_DTAG_Signature:
+            while (reader.readChild (dtag))
+              {
+                if (dtag == NdnbParser::NDN_DTAG_SignatureBits)
+                  {
+                    reader.readValue (value, size);
+                    signature->getSignatureBits ().assign (value, value + size);
+                  }
+                else
+                  reader.skipRest (); // DigestAlgorithm, Witness
+              }
+            break;
+          case NdnbParser::NDN_DTAG_Name:
+            reader.readComponents (data.getName ());
+            break;
+          case NdnbParser::NDN_DTAG_SignedInfo:
+            ReadSignedInfo (data, *signature, reader, true);
+            break;
+          case NdnbParser::NDN_DTAG_Content:
+            reader.readValue (value, size);
+            data.getContent ().setContent (value, size);
+            break;
+          default:
+            reader.skipRest ();
+            break;
+          }
+        offset = reader.getOffset ();
+      }
+
+    // signed portion ends right before the closer of the Data
+    signedPortion.m_offset = signedOffset;
+    signedPortion.m_size = signedOffset != 0 ? offset - signedOffset : 0;
+
+    data.setSignature (signature);
+  }
+
+  void
+  Data::Scan (Layout &layout, const void *buf, size_t length)
+  {
+    layout = Layout ();
+
+    const unsigned char *begin = reinterpret_cast<const unsigned char *> (buf);
+    Reader reader (buf, length);
+    reader.readDtag (NdnbParser::NDN_DTAG_Data);
+
+    const unsigned char *value;
+    size_t size;
+    uint32_t dtag;
+    size_t offset = reader.getOffset ();
+    size_t signedOffset = 0;
+    while (reader.readChild (dtag))
+      {
+        if (dtag != NdnbParser::NDN_DTAG_Signature && signedOffset == 0)
+          signedOffset = offset;
+
+        uint32_t child;
+        switch (dtag)
+          {
+          case NdnbParser::NDN_DTAG_Signature:
+            while (reader.readChild (child))
+              {
+                if (child == NdnbParser::NDN_DTAG_SignatureBits)
+                  {
+                    reader.readValue (value, size);
+                    layout.m_signatureBits.m_offset = value - begin;
+                    layout.m_signatureBits.m_size = size;
+                  }
+                else
+                  reader.skipRest ();
+              }
+            break;
+          case NdnbParser::NDN_DTAG_Name:
+            reader.skipRest ();
+            layout.m_name.m_offset = offset;
+            layout.m_name.m_size = reader.getOffset () - offset;
+            break;
+          case NdnbParser::NDN_DTAG_SignedInfo:
+            {
+              size_t childOffset = reader.getOffset ();
+              while (reader.readChild (child))
+                {
+                  reader.skipRest ();
+                  if (child == NdnbParser::NDN_DTAG_KeyLocator)
+                    {
+                      layout.m_keyLocator.m_offset = childOffset;
+                      layout.m_keyLocator.m_size = reader.getOffset () - childOffset;
+                    }
+                  childOffset = reader.getOffset ();
+                }
+              layout.m_signedInfo.m_offset = offset;
+              layout.m_signedInfo.m_size = reader.getOffset () - offset;
+              break;
+            }
+          case NdnbParser::NDN_DTAG_Content:
+            reader.readValue (value, size);
+            layout.m_content.m_offset = value - begin;
+            layout.m_content.m_size = size;
+            break;
+          default:
+            reader.skipRest ();
+            break;
+          }
+        offset = reader.getOffset ();
+      }
+
+    if (signedOffset != 0)
+      {
+        // offset points right before the closer of the Data
+        layout.m_signedPortion.m_offset = signedOffset;
+        layout.m_signedPortion.m_size = offset - signedOffset;
+      }
+  }
+
+  void
+  Data::DecodeName (Name &name, const void *buf, size_t length)
+  {
+    Reader reader (buf, length);
+    reader.readName (name);
+  }
+
+  void
+  Data::DecodeSignedInfo (ndn::Data &data, signature::Sha256WithRsa &signature, const void *buf, size_t length)
+  {
+    Reader reader (buf, length);
+    reader.readDtag (NdnbParser::NDN_DTAG_SignedInfo);
+    ReadSignedInfo (data, signature, reader, false);
+  }
+
+  void
+  Data::DecodeKeyLocator (KeyLocator &keyLocator, const void *buf, size_t length)
+  {
+    Reader reader (buf, length);
+    reader.readDtag (NdnbParser::NDN_DTAG_KeyLocator);
+    ReadKeyLocator (keyLocator, reader);
+  }
+
 } //ndnb
 } //wire
 
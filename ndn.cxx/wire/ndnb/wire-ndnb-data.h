@@ -17,8 +17,13 @@
 
 NDN_NAMESPACE_BEGIN
 
+class KeyLocator;
+namespace signature { class Sha256WithRsa; }
+
 namespace wire {
 
+class IovecList;
+
 /**
  * @brief Namespace for NDNb wire format operations
  */
@@ -32,17 +37,112 @@ namespace ndnb {
 class Data
 {
 public:
+  /**
+   * @brief Position of a field inside the encoded buffer (zero size if the field is absent)
+   */
+  struct Range
+  {
+    size_t m_offset;
+    size_t m_size;
+  };
+
+  /**
+   * @brief Positions of the Data fields, recorded by Scan
+   *
+   * Name, SignedInfo, and KeyLocator ranges cover the whole element (from the opening DTAG to
+   * the closer), SignatureBits and Content ranges cover only the value.  Signed portion starts
+   * at the first element after Signature and ends right before the closer of the Data.
+   */
+  struct Layout
+  {
+    Range m_signatureBits;
+    Range m_name;
+    Range m_signedInfo;
+    Range m_keyLocator;
+    Range m_content;
+    Range m_signedPortion;
+  };
+
   static void
   Serialize (const ndn::Data &data, OutputIterator &start);
 
   static void 
   SerializeUnsigned (const ndn::Data &data, OutputIterator &start);
 
+  /**
+   * @brief Serialize data into the list of buffers, referencing (not copying) payload,
+   *        signature bits, and the signed portion of the wire (if data has one)
+   */
+  static void
+  Serialize (const ndn::Data &data, IovecList &list);
+
+  /**
+   * @brief Serialize unsigned portion of data into the list of buffers, referencing (not copying) payload
+   */
+  static void
+  SerializeUnsigned (const ndn::Data &data, IovecList &list);
+
   static void
   Deserialize (Ptr<ndn::Data> data, InputIterator &start);
 
+  /**
+   * @brief Decode data from the contiguous buffer with the pull parser (ndnb::Reader)
+   *
+   * Only the fields of the resulting object are allocated (each value is copied once, straight
+   * from the buffer), no intermediate syntax tree is built.  Signature is set to a new
+   * Sha256WithRsa object.  Data is expected to be freshly created (name components are appended).
+   *
+   * @throws NdnbParser::NdnbDecodingException if the buffer is truncated or malformed
+   */
+  static void
+  Decode (ndn::Data &data, const void *buf, size_t length);
+
+  /**
+   * @brief Decode data and record the position of its signed portion (from the first element
+   *        after Signature up to the closer of the Data, zero size if there is no such element)
+   */
+  static void
+  Decode (ndn::Data &data, const void *buf, size_t length, Range &signedPortion);
+
+  /**
+   * @brief Record positions of the Data fields in one pass over the buffer, without decoding them
+   *
+   * The whole packet is checked to be well-formed NDNB, values of the fields are checked only
+   * when they are decoded (DecodeName, DecodeSignedInfo, DecodeKeyLocator).
+   *
+   * @throws NdnbParser::NdnbDecodingException if the buffer is truncated or malformed
+   */
+  static void
+  Scan (Layout &layout, const void *buf, size_t length);
+
+  /**
+   * @brief Decode <Name> element, components are appended to the name
+   */
+  static void
+  DecodeName (Name &name, const void *buf, size_t length);
+
+  /**
+   * @brief Decode <SignedInfo> element into content info of the data and the signature
+   *
+   * KeyLocator is skipped (see DecodeKeyLocator)
+   */
+  static void
+  DecodeSignedInfo (ndn::Data &data, signature::Sha256WithRsa &signature, const void *buf, size_t length);
+
+  /**
+   * @brief Decode <KeyLocator> element
+   */
+  static void
+  DecodeKeyLocator (KeyLocator &keyLocator, const void *buf, size_t length);
+
   static ndn::Content::Type
   toType(uint32_t typeBytes);
+
+  /**
+   * @brief Get 3-byte value of <Type> element for the content type (inverse of toType)
+   */
+  static uint32_t
+  fromType (ndn::Content::Type type);
 };
 
 
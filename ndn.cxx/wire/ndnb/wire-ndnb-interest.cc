@@ -12,6 +12,7 @@
 #include "logging.h"
 
 #include "wire-ndnb.h"
+#include "ndnb-reader.h"
 
 
 #include "ndnb-parser/visitors/name-visitor.h"
@@ -99,10 +100,10 @@ InterestVisitor::visit (NdnbParser::Dtag &n, boost::any param/*should be Interes
   // uint32_t n.m_dtag;
   // std::list<Ptr<Block> > n.m_nestedBlocks;
 
-  static NdnbParser::NonNegativeIntegerVisitor nonNegativeIntegerVisitor;
-  static NdnbParser::NameVisitor               nameVisitor;
-  static NdnbParser::TimestampVisitor          timestampVisitor;
-  static NdnbParser::Uint32tBlobVisitor        nonceVisitor;
+  NdnbParser::NonNegativeIntegerVisitor nonNegativeIntegerVisitor;
+  NdnbParser::NameVisitor               nameVisitor;
+  NdnbParser::TimestampVisitor          timestampVisitor;
+  NdnbParser::Uint32tBlobVisitor        nonceVisitor;
   
   ndn::Interest *m_interest = boost::any_cast<ndn::Interest*> (param);
 
@@ -127,26 +128,26 @@ InterestVisitor::visit (NdnbParser::Dtag &n, boost::any param/*should be Interes
         m_interest->setName (name);
         break;
       }
-    // case NdnbParser::NDN_DTAG_MinSuffixComponents:
-    //   _LOG_DEBUG ("MinSuffixComponents");
-    //   if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
-    //     throw NdnbParser::NdnbDecodingException ();
-    //   m_interest->SetMinSuffixComponents (
-    //            boost::any_cast<uint32_t> (
-    //                                       (*n.m_nestedTags.begin())->accept(
-    //                                                                        nonNegativeIntegerVisitor
-    //                                                                        )));
-    //   break;
-    // case NdnbParser::NDN_DTAG_MaxSuffixComponents:
-    //   _LOG_DEBUG ("MaxSuffixComponents");
-    //   if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
-    //     throw NdnbParser::NdnbDecodingException ();
-    //   m_interest->SetMaxSuffixComponents (
-    //            boost::any_cast<uint32_t> (
-    //                                       (*n.m_nestedTags.begin())->accept(
-    //                                                                        nonNegativeIntegerVisitor
-    //                                                                        )));
-    //   break;
+    case NdnbParser::NDN_DTAG_MinSuffixComponents:
+      _LOG_DEBUG ("MinSuffixComponents");
+      if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
+        throw NdnbParser::NdnbDecodingException ();
+      m_interest->setMinSuffixComponents (
+               boost::any_cast<uint32_t> (
+                                          (*n.m_nestedTags.begin())->accept(
+                                                                           nonNegativeIntegerVisitor
+                                                                           )));
+      break;
+    case NdnbParser::NDN_DTAG_MaxSuffixComponents:
+      _LOG_DEBUG ("MaxSuffixComponents");
+      if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
+        throw NdnbParser::NdnbDecodingException ();
+      m_interest->setMaxSuffixComponents (
+               boost::any_cast<uint32_t> (
+                                          (*n.m_nestedTags.begin())->accept(
+                                                                           nonNegativeIntegerVisitor
+                                                                           )));
+      break;
     // case NdnbParser::NDN_DTAG_Exclude:
     //   {
     //     _LOG_DEBUG ("Exclude");
@@ -160,27 +161,27 @@ InterestVisitor::visit (NdnbParser::Dtag &n, boost::any param/*should be Interes
     //     m_interest->SetExclude (exclude);
     //     break;
     //   }
-    // case NdnbParser::NDN_DTAG_ChildSelector:
-    //   _LOG_DEBUG ("ChildSelector");
-    //   if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
-    //     throw NdnbParser::NdnbDecodingException ();
+    case NdnbParser::NDN_DTAG_ChildSelector:
+      _LOG_DEBUG ("ChildSelector");
+      if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
+        throw NdnbParser::NdnbDecodingException ();
 
-    //   m_interest->SetChildSelector (
-    //            1 == boost::any_cast<uint32_t> (
-    //                                       (*n.m_nestedTags.begin())->accept(
-    //                                                                        nonNegativeIntegerVisitor
-    //                                                                        )));
-    //   break;
-    // case NDN_DTAG_AnswerOriginKind:
-    //   _LOG_DEBUG ("AnswerOriginKind");
-    //   if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
-    //     throw NdnbParser::NdnbDecodingException ();
-    //   m_interest->SetAnswerOriginKind (
-    //            1 == boost::any_cast<uint32_t> (
-    //                                       (*n.m_nestedTags.begin())->accept(
-    //                                                                        nonNegativeIntegerVisitor
-    //                                                                        )));
-    //   break;
+      m_interest->setChildSelector (
+               boost::any_cast<uint32_t> (
+                                          (*n.m_nestedTags.begin())->accept(
+                                                                           nonNegativeIntegerVisitor
+                                                                           )));
+      break;
+    case NdnbParser::NDN_DTAG_AnswerOriginKind:
+      _LOG_DEBUG ("AnswerOriginKind");
+      if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
+        throw NdnbParser::NdnbDecodingException ();
+      m_interest->setAnswerOriginKind (
+               boost::any_cast<uint32_t> (
+                                          (*n.m_nestedTags.begin())->accept(
+                                                                           nonNegativeIntegerVisitor
+                                                                           )));
+      break;
     case NdnbParser::NDN_DTAG_Scope: 
       _LOG_DEBUG ("Scope");
       if (n.m_nestedTags.size()!=1) // should be exactly one UDATA inside this tag
@@ -230,12 +231,51 @@ InterestVisitor::visit (NdnbParser::Dtag &n, boost::any param/*should be Interes
 void
 Interest::Deserialize (Ptr<ndn::Interest> interest, InputIterator &start)
 {
-  static InterestVisitor interestVisitor;
+  InterestVisitor interestVisitor;
 
   Ptr<NdnbParser::Block> root = NdnbParser::Block::ParseBlock (start);
   root->accept (interestVisitor, GetPointer (interest));
 }
 
+void
+Interest::Decode (ndn::Interest &interest, const void *buf, size_t length)
+{
+  Reader reader (buf, length);
+  reader.readDtag (NdnbParser::NDN_DTAG_Interest);
+
+  uint32_t dtag;
+  while (reader.readChild (dtag))
+    {
+      switch (dtag)
+        {
+        case NdnbParser::NDN_DTAG_Name:
+          reader.readComponents (interest.getName ());
+          break;
+        case NdnbParser::NDN_DTAG_MinSuffixComponents:
+          interest.setMinSuffixComponents (reader.readNumber ());
+          break;
+        case NdnbParser::NDN_DTAG_MaxSuffixComponents:
+          interest.setMaxSuffixComponents (reader.readNumber ());
+          break;
+        case NdnbParser::NDN_DTAG_ChildSelector:
+          interest.setChildSelector (reader.readNumber ());
+          break;
+        case NdnbParser::NDN_DTAG_AnswerOriginKind:
+          interest.setAnswerOriginKind (reader.readNumber ());
+          break;
+        case NdnbParser::NDN_DTAG_Scope:
+          interest.setScope (reader.readNumber ());
+          break;
+        case NdnbParser::NDN_DTAG_InterestLifetime:
+          interest.setInterestLifetime (reader.readTimestamp ());
+          break;
+        default: // Exclude, Nonce, and other fields are not supported
+          reader.skipRest ();
+          break;
+        }
+    }
+}
+
 } // ndnb
 } // wire
 
@@ -37,6 +37,17 @@ public:
 
   static void
   Deserialize (Ptr<ndn::Interest> interest, InputIterator &start);
+
+  /**
+   * @brief Decode interest from the contiguous buffer with the pull parser (ndnb::Reader)
+   *
+   * No intermediate syntax tree is built, only name components are allocated.
+   * Interest is expected to be freshly created (name components are appended).
+   *
+   * @throws NdnbParser::NdnbDecodingException if the buffer is truncated or malformed
+   */
+  static void
+  Decode (ndn::Interest &interest, const void *buf, size_t length);
 };
 
 } // ndnb
@@ -0,0 +1,391 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "tlv-format.h"
+#include "tlv-writer.h"
+#include "tlv-reader.h"
+
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/wire/interest-template.h"
+#include "ndn.cxx/error.h"
+
+#include <string.h>
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+const char *
+Format::getName () const
+{
+  return "NDN-TLV";
+}
+
+size_t
+Format::findPacketEnd (const unsigned char *buf, size_t length, PacketScan &scan) const
+{
+  // unlike NDNB, the size of the whole packet is known right from its header
+  if (scan.m_end == 0)
+    {
+      const unsigned char *p = buf;
+      uint64_t type;
+      uint64_t size;
+      if (!Reader::ParseBlockHeader (p, buf + length, type, size))
+        return 0;
+
+      if (size > static_cast<size_t> (-1) - (p - buf))
+        BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Invalid TLV-LENGTH"));
+      scan.m_end = (p - buf) + size;
+    }
+
+  return scan.m_end <= length ? scan.m_end : 0;
+}
+
+wire::Format::PacketType
+Format::getPacketType (const unsigned char *buf, size_t length) const
+{
+  uint64_t type;
+  if (!Reader::ParseVarNumber (buf, buf + length, type))
+    return UNKNOWN_PACKET;
+
+  switch (type)
+    {
+    case INTEREST:
+      return INTEREST_PACKET;
+    case DATA:
+      return DATA_PACKET;
+    default:
+      return UNKNOWN_PACKET;
+    }
+}
+
+bool
+Format::parseName (const unsigned char *buf, size_t length, Name &name) const
+{
+  // name is the first element of both Interest and Data
+  try
+    {
+      Reader packet (buf, length);
+      Reader::Element element;
+      packet.next (element);
+
+      Reader reader (element);
+      reader.expect (NAME, element);
+      Reader::ReadName (element, name);
+      return true;
+    }
+  catch (error::wire::Tlv &)
+    {
+      return false;
+    }
+}
+
+size_t
+Format::encodeInterest (const Interest &interest, uint32_t nonce, Blob &wire) const
+{
+  wire.resize (Writer::EstimateInterest (interest));
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&wire[0]);
+  unsigned char *p = begin;
+  unsigned char *nonceValue;
+  Writer::AppendInterest (p, interest, nonce, nonceValue);
+
+  return nonceValue - begin;
+}
+
+/**
+ * @brief NDN-TLV Interest template: components of the prefix and the fields that follow the Name
+ *        are copied, headers of Interest and Name are written again since their lengths change
+ */
+class EncodedInterestTemplate : public wire::InterestTemplate
+{
+public:
+  EncodedInterestTemplate (const Format &format, const Interest &interest);
+
+  virtual size_t
+  encode (const Name &suffix, uint32_t nonce, Blob &wire) const;
+
+private:
+  Blob m_prefix; // value of the Name (components of the prefix)
+  Blob m_tail;   // elements of Interest after the Name: Selectors, Nonce, Scope, InterestLifetime
+  size_t m_nonceOffset; // offset of the Nonce value in m_tail
+};
+
+EncodedInterestTemplate::EncodedInterestTemplate (const Format &format, const Interest &interest)
+  : wire::InterestTemplate (interest)
+{
+  Blob wire;
+  size_t nonceOffset = format.encodeInterest (interest, 0, wire);
+
+  Reader packet (wire.buf (), wire.size ());
+  Reader::Element element;
+  packet.expect (INTEREST, element);
+  Reader reader (element);
+  reader.expect (NAME, element);
+
+  const unsigned char *begin = reinterpret_cast<const unsigned char *> (wire.buf ());
+  const unsigned char *tail = element.m_value + element.m_size;
+  m_prefix.assign (element.m_value, tail);
+  m_tail.assign (tail, begin + wire.size ());
+  m_nonceOffset = nonceOffset - (tail - begin);
+}
+
+size_t
+EncodedInterestTemplate::encode (const Name &suffix, uint32_t nonce, Blob &wire) const
+{
+  size_t nameLength = m_prefix.size ();
+  for (Name::const_iterator component = suffix.begin (); component != suffix.end (); component++)
+    {
+      nameLength += Writer::EstimateBlob (NAME_COMPONENT, component->size ());
+    }
+  size_t interestLength = Writer::EstimateBlockHeader (NAME, nameLength) + nameLength + m_tail.size ();
+  wire.resize (Writer::EstimateBlockHeader (INTEREST, interestLength) + interestLength);
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&wire[0]);
+  unsigned char *p = begin;
+  Writer::AppendBlockHeader (p, INTEREST, interestLength);
+  Writer::AppendBlockHeader (p, NAME, nameLength);
+  memcpy (p, m_prefix.buf (), m_prefix.size ());
+  p += m_prefix.size ();
+  for (Name::const_iterator component = suffix.begin (); component != suffix.end (); component++)
+    {
+      Writer::AppendBlob (p, NAME_COMPONENT, component->buf (), component->size ());
+    }
+  memcpy (p, m_tail.buf (), m_tail.size ());
+
+  size_t nonceOffset = (p - begin) + m_nonceOffset;
+  memcpy (&wire[nonceOffset], &nonce, sizeof (nonce));
+  return nonceOffset;
+}
+
+Ptr<InterestTemplate>
+Format::createInterestTemplate (const Interest &interest) const
+{
+  return Ptr<InterestTemplate> (new EncodedInterestTemplate (*this, interest));
+}
+
+static void
+readExclude (const Reader::Element &element, Exclude &exclude)
+{
+  // ANY applies to the preceding component, so a component is added when the next element is known
+  Reader reader (element);
+  Reader::Element term;
+  name::Component component;
+  bool hasComponent = false;
+  while (!reader.atEnd ())
+    {
+      reader.next (term);
+      if (term.m_type == ANY)
+        {
+          if (hasComponent)
+            exclude.appendExclude (component, true);
+          else if (exclude.size () == 0)
+            exclude.appendExclude (name::Component (), true); // leading ANY
+          else
+            BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("ANY should follow a name component in Exclude"));
+          hasComponent = false;
+        }
+      else if (term.m_type == NAME_COMPONENT)
+        {
+          if (hasComponent)
+            exclude.appendExclude (component, false);
+          component = name::Component (term.m_value, term.m_size);
+          hasComponent = true;
+        }
+      else
+        BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in Exclude"));
+    }
+  if (hasComponent)
+    exclude.appendExclude (component, false);
+}
+
+static void
+readSelectors (const Reader::Element &element, Interest &interest)
+{
+  Reader reader (element);
+  Reader::Element selector;
+
+  if (reader.nextIf (MIN_SUFFIX_COMPONENTS, selector))
+    interest.setMinSuffixComponents (Reader::ReadNumber (selector));
+  if (reader.nextIf (MAX_SUFFIX_COMPONENTS, selector))
+    interest.setMaxSuffixComponents (Reader::ReadNumber (selector));
+  reader.nextIf (PUBLISHER_PUBLIC_KEY_LOCATOR, selector);
+  if (reader.nextIf (EXCLUDE, selector))
+    readExclude (selector, interest.getExclude ());
+  if (reader.nextIf (CHILD_SELECTOR, selector))
+    interest.setChildSelector (Reader::ReadNumber (selector));
+  reader.nextIf (MUST_BE_FRESH, selector);
+
+  if (!reader.atEnd ())
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in Selectors"));
+}
+
+void
+Format::decodeInterest (Interest &interest, const void *buf, size_t length) const
+{
+  Reader packet (buf, length);
+  Reader::Element element;
+  packet.expect (INTEREST, element);
+
+  Reader reader (element);
+  reader.expect (NAME, element);
+  Reader::ReadName (element, interest.getName ());
+
+  if (reader.nextIf (SELECTORS, element))
+    readSelectors (element, interest);
+  reader.nextIf (NONCE, element);
+  if (reader.nextIf (SCOPE, element))
+    interest.setScope (Reader::ReadNumber (element));
+  if (reader.nextIf (INTEREST_LIFETIME, element))
+    interest.setInterestLifetime (time::Milliseconds (Reader::ReadNumber (element)));
+
+  if (!reader.atEnd ())
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in Interest"));
+}
+
+Ptr<SignedBlob>
+Format::encodeData (const Data &data) const
+{
+  Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+  encoded->resize (Writer::EstimateData (data));
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+  unsigned char *p = begin;
+  Writer::AppendData (p, data);
+
+  // signed portion starts right after the header of Data and ends right before SignatureValue
+  size_t signatureValue = Writer::EstimateBlob (SIGNATURE_VALUE, DynamicCast<const signature::Sha256WithRsa> (data.getSignature ())->getSignatureBits ().size ());
+  size_t signedSize = data.getSignedBlob () ? data.getSignedBlob ()->signed_size () : Writer::EstimateUnsignedData (data);
+  encoded->setSignedPortion (encoded->size () - signatureValue - signedSize, signedSize);
+  return encoded;
+}
+
+Ptr<SignedBlob>
+Format::encodeDataForSigning (const Data &data, size_t reserve, size_t &signatureBitsOffset) const
+{
+  Ptr<SignedBlob> encoded = Ptr<SignedBlob>::Create ();
+  encoded->resize (Writer::EstimateDataForSigning (data, reserve));
+
+  unsigned char *begin = reinterpret_cast<unsigned char *> (&(*encoded)[0]);
+  unsigned char *p = begin;
+  unsigned char *signatureBits;
+  unsigned char *signedPortion;
+  Writer::AppendDataForSigning (p, data, reserve, signatureBits, signedPortion);
+
+  size_t signatureValue = Writer::EstimateBlob (SIGNATURE_VALUE, reserve);
+  encoded->setSignedPortion (signedPortion - begin, p - signedPortion - signatureValue);
+  signatureBitsOffset = signatureBits - begin;
+  return encoded;
+}
+
+static void
+readMetaInfo (const Reader::Element &element, Content &content)
+{
+  Reader reader (element);
+  Reader::Element field;
+
+  content.setType (Content::DATA);
+  if (reader.nextIf (CONTENT_TYPE, field))
+    {
+      switch (Reader::ReadNumber (field))
+        {
+        case CONTENT_TYPE_KEY:
+          content.setType (Content::KEY);
+          break;
+        case CONTENT_TYPE_LINK:
+          content.setType (Content::LINK);
+          break;
+        default:
+          break;
+        }
+    }
+  if (reader.nextIf (FRESHNESS_PERIOD, field))
+    content.setFreshness (time::Milliseconds (Reader::ReadNumber (field)));
+  else
+    content.setFreshness (Content::noFreshness);
+  if (reader.nextIf (FINAL_BLOCK_ID, field))
+    {
+      Reader finalBlockId (field);
+      finalBlockId.expect (NAME_COMPONENT, field);
+      content.setFinalBlockId (name::Component (field.m_value, field.m_size));
+    }
+
+  if (!reader.atEnd ())
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in MetaInfo"));
+}
+
+static void
+readSignatureInfo (const Reader::Element &element, signature::Sha256WithRsa &signature)
+{
+  Reader reader (element);
+  Reader::Element field;
+
+  reader.expect (SIGNATURE_TYPE, field);
+  if (Reader::ReadNumber (field) != SIGNATURE_SHA256_WITH_RSA)
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Only SignatureSha256WithRsa is supported"));
+
+  if (reader.nextIf (KEY_LOCATOR, field))
+    {
+      Reader keyLocator (field);
+      if (keyLocator.nextIf (NAME, field))
+        {
+          KeyLocator locator;
+          locator.setType (KeyLocator::KEYNAME);
+          Reader::ReadName (field, locator.getKeyName ());
+          signature.setKeyLocator (locator);
+        }
+      else
+        keyLocator.expect (KEY_LOCATOR_DIGEST, field);
+    }
+
+  if (!reader.atEnd ())
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in SignatureInfo"));
+}
+
+void
+Format::decodeData (Data &data, const void *buf, size_t length, size_t &signedOffset, size_t &signedSize) const
+{
+  Ptr<signature::Sha256WithRsa> signature = Ptr<signature::Sha256WithRsa>::Create ();
+
+  Reader packet (buf, length);
+  Reader::Element element;
+  packet.expect (DATA, element);
+  signedOffset = element.m_value - reinterpret_cast<const unsigned char *> (buf);
+
+  Reader reader (element);
+  reader.expect (NAME, element);
+  Reader::ReadName (element, data.getName ());
+
+  reader.expect (META_INFO, element);
+  readMetaInfo (element, data.getContent ());
+
+  reader.expect (CONTENT, element);
+  data.getContent ().setContent (element.m_value, element.m_size);
+
+  reader.expect (SIGNATURE_INFO, element);
+  readSignatureInfo (element, *signature);
+  signedSize = reader.getOffset ();
+
+  reader.expect (SIGNATURE_VALUE, element);
+  signature->setSignatureBits (Blob (element.m_value, element.m_size));
+
+  if (!reader.atEnd ())
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected element in Data"));
+
+  data.setSignature (signature);
+}
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
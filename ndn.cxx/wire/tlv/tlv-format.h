@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_TLV_FORMAT_H
+#define NDN_WIRE_TLV_FORMAT_H
+
+#include "ndn.cxx/wire/format.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+/**
+ * @brief NDN-TLV wire format (see wire::tlv::Writer and wire::tlv::Reader)
+ *
+ * Interest is always encoded with Nonce.  Decoders accept elements only in the order defined by
+ * the specification, and elements that are not represented in the library (Nonce,
+ * PublisherPublicKeyLocator, MustBeFresh, KeyLocatorDigest) are skipped.
+ */
+class Format : public wire::Format
+{
+public:
+  virtual const char *
+  getName () const;
+
+  using wire::Format::findPacketEnd;
+
+  virtual size_t
+  findPacketEnd (const unsigned char *buf, size_t length, PacketScan &scan) const;
+
+  virtual PacketType
+  getPacketType (const unsigned char *buf, size_t length) const;
+
+  virtual bool
+  parseName (const unsigned char *buf, size_t length, Name &name) const;
+
+  virtual size_t
+  encodeInterest (const Interest &interest, uint32_t nonce, Blob &wire) const;
+
+  virtual Ptr<InterestTemplate>
+  createInterestTemplate (const Interest &interest) const;
+
+  virtual void
+  decodeInterest (Interest &interest, const void *buf, size_t length) const;
+
+  virtual Ptr<SignedBlob>
+  encodeData (const Data &data) const;
+
+  virtual Ptr<SignedBlob>
+  encodeDataForSigning (const Data &data, size_t reserve, size_t &signatureBitsOffset) const;
+
+  virtual void
+  decodeData (Data &data, const void *buf, size_t length, size_t &signedOffset, size_t &signedSize) const;
+};
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_TLV_FORMAT_H
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "tlv-reader.h"
+
+#include "ndn.cxx/error.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+Reader::Reader (const void *buf, size_t length)
+  : m_begin (reinterpret_cast<const unsigned char *> (buf))
+  , m_pos (m_begin)
+  , m_end (m_begin + length)
+{
+}
+
+Reader::Reader (const Element &element)
+  : m_begin (element.m_value)
+  , m_pos (m_begin)
+  , m_end (m_begin + element.m_size)
+{
+}
+
+bool
+Reader::ParseVarNumber (const unsigned char *&begin, const unsigned char *end, uint64_t &number)
+{
+  if (begin == end)
+    return false;
+
+  size_t size;
+  switch (*begin)
+    {
+    case 253:
+      size = 2;
+      break;
+    case 254:
+      size = 4;
+      break;
+    case 255:
+      size = 8;
+      break;
+    default:
+      number = *begin++;
+      return true;
+    }
+
+  if (static_cast<size_t> (end - begin) < size + 1)
+    return false;
+
+  number = 0;
+  for (size_t i = 1; i <= size; i++)
+    {
+      number = (number << 8) | begin[i];
+    }
+  begin += size + 1;
+  return true;
+}
+
+bool
+Reader::ParseBlockHeader (const unsigned char *&begin, const unsigned char *end, uint64_t &type, uint64_t &length)
+{
+  const unsigned char *p = begin;
+  if (!ParseVarNumber (p, end, type) || !ParseVarNumber (p, end, length))
+    return false;
+
+  begin = p;
+  return true;
+}
+
+void
+Reader::next (Element &element)
+{
+  const unsigned char *p = m_pos;
+  uint64_t length;
+  if (!ParseBlockHeader (p, m_end, element.m_type, length) || static_cast<uint64_t> (m_end - p) < length)
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Truncated TLV element"));
+
+  element.m_value = p;
+  element.m_size = length;
+  m_pos = p + length;
+}
+
+bool
+Reader::nextIf (uint64_t type, Element &element)
+{
+  if (atEnd ())
+    return false;
+
+  const unsigned char *p = m_pos;
+  uint64_t nextType;
+  if (!ParseVarNumber (p, m_end, nextType))
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Truncated TLV element"));
+  if (nextType != type)
+    return false;
+
+  next (element);
+  return true;
+}
+
+void
+Reader::expect (uint64_t type, Element &element)
+{
+  next (element);
+  if (element.m_type != type)
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Unexpected TLV element")
+                           << error::pos (getOffset ()));
+}
+
+uint64_t
+Reader::ReadNumber (const Element &element)
+{
+  if (element.m_size != 1 && element.m_size != 2 && element.m_size != 4 && element.m_size != 8)
+    BOOST_THROW_EXCEPTION (error::wire::Tlv () << error::msg ("Invalid size of nonNegativeInteger"));
+
+  uint64_t number = 0;
+  for (size_t i = 0; i < element.m_size; i++)
+    {
+      number = (number << 8) | element.m_value[i];
+    }
+  return number;
+}
+
+void
+Reader::ReadName (const Element &element, Name &name)
+{
+  Reader reader (element);
+  Element component;
+  while (!reader.atEnd ())
+    {
+      reader.expect (NAME_COMPONENT, component);
+      name.append (component.m_value, component.m_size);
+    }
+}
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_TLV_READER_H
+#define NDN_WIRE_TLV_READER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+
+#include "tlv.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+/**
+ * @brief Pull parser (cursor) over the sequence of NDN-TLV elements in a contiguous buffer
+ *
+ * Reader yields one element at a time: its type and the span of its value inside the buffer.
+ * Nested elements are read with a separate Reader over the value of the parent, so children
+ * never run past the end of the parent.  Nothing is copied or allocated by the reader itself.
+ *
+ * All methods throw error::wire::Tlv if the buffer is truncated or malformed.
+ */
+class Reader
+{
+public:
+  /**
+   * @brief Single NDN-TLV element
+   */
+  struct Element
+  {
+    uint64_t m_type;              ///< @brief TLV-TYPE of the element
+    const unsigned char *m_value; ///< @brief value of the element (points into the buffer)
+    size_t m_size;                ///< @brief TLV-LENGTH of the element
+  };
+
+  Reader (const void *buf, size_t length);
+
+  /**
+   * @brief Create reader over the value of the element (i.e., over its children)
+   */
+  explicit
+  Reader (const Element &element);
+
+  /**
+   * @brief Check if the whole buffer has been consumed
+   */
+  inline bool
+  atEnd () const;
+
+  /**
+   * @brief Get offset of the cursor from the beginning of the buffer
+   */
+  inline size_t
+  getOffset () const;
+
+  /**
+   * @brief Read next element and move cursor after it
+   */
+  void
+  next (Element &element);
+
+  /**
+   * @brief Read next element if it has the specific type
+   * @returns false (cursor is not moved) if the buffer has been consumed or the next element
+   *          is of another type
+   */
+  bool
+  nextIf (uint64_t type, Element &element);
+
+  /**
+   * @brief Read next element, which should have the specific type
+   */
+  void
+  expect (uint64_t type, Element &element);
+
+  /**
+   * @brief Parse VAR-NUMBER
+   * @returns false if VAR-NUMBER is not complete (begin is not changed)
+   */
+  static bool
+  ParseVarNumber (const unsigned char *&begin, const unsigned char *end, uint64_t &number);
+
+  /**
+   * @brief Parse TYPE and LENGTH of the element
+   * @returns false if the header is not complete (begin is not changed)
+   */
+  static bool
+  ParseBlockHeader (const unsigned char *&begin, const unsigned char *end, uint64_t &type, uint64_t &length);
+
+  /**
+   * @brief Get value of the element with nonNegativeInteger value
+   */
+  static uint64_t
+  ReadNumber (const Element &element);
+
+  /**
+   * @brief Append components of the Name element to the name
+   */
+  static void
+  ReadName (const Element &element, Name &name);
+
+private:
+  const unsigned char *m_begin;
+  const unsigned char *m_pos;
+  const unsigned char *m_end;
+};
+
+inline bool
+Reader::atEnd () const
+{
+  return m_pos == m_end;
+}
+
+inline size_t
+Reader::getOffset () const
+{
+  return m_pos - m_begin;
+}
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_TLV_READER_H
@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "tlv-writer.h"
+
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/error.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+static size_t
+numberSize (uint64_t number)
+{
+  if (number <= 0xFF)
+    return 1;
+  else if (number <= 0xFFFF)
+    return 2;
+  else if (number <= 0xFFFFFFFF)
+    return 4;
+  else
+    return 8;
+}
+
+size_t
+Writer::EstimateNumber (uint32_t type, uint64_t number)
+{
+  return EstimateBlob (type, numberSize (number));
+}
+
+void
+Writer::AppendNumber (unsigned char *&p, uint32_t type, uint64_t number)
+{
+  size_t size = numberSize (number);
+  AppendBlockHeader (p, type, size);
+  for (size_t i = size; i > 0; i--)
+    {
+      p[i - 1] = number & 0xFF;
+      number >>= 8;
+    }
+  p += size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lengths of the values of composite elements, headers of which go before their children
+
+static size_t
+nameLength (const Name &name)
+{
+  size_t length = 0;
+  for (Name::const_iterator component = name.begin (); component != name.end (); component++)
+    {
+      length += Writer::EstimateBlob (NAME_COMPONENT, component->size ());
+    }
+  return length;
+}
+
+static size_t
+excludeLength (const Exclude &exclude)
+{
+  size_t length = 0;
+  for (Exclude::const_reverse_iterator item = exclude.rbegin (); item != exclude.rend (); item++)
+    {
+      if (!item->first.empty ())
+        length += Writer::EstimateBlob (NAME_COMPONENT, item->first.size ());
+      if (item->second)
+        length += Writer::EstimateBlockHeader (ANY, 0);
+    }
+  return length;
+}
+
+static size_t
+selectorsLength (const ndn::Interest &interest)
+{
+  size_t length = 0;
+  if (interest.getMinSuffixComponents () != ndn::Interest::ncomps)
+    length += Writer::EstimateNumber (MIN_SUFFIX_COMPONENTS, interest.getMinSuffixComponents ());
+  if (interest.getMaxSuffixComponents () != ndn::Interest::ncomps)
+    length += Writer::EstimateNumber (MAX_SUFFIX_COMPONENTS, interest.getMaxSuffixComponents ());
+  if (interest.getExclude ().size () > 0)
+    {
+      size_t exclude = excludeLength (interest.getExclude ());
+      length += Writer::EstimateBlockHeader (EXCLUDE, exclude) + exclude;
+    }
+  if (interest.getChildSelector () != ndn::Interest::CHILD_DEFAULT)
+    length += Writer::EstimateNumber (CHILD_SELECTOR, interest.getChildSelector ());
+  return length;
+}
+
+static size_t
+interestLength (const ndn::Interest &interest)
+{
+  size_t length = Writer::EstimateName (interest.getName ());
+
+  size_t selectors = selectorsLength (interest);
+  if (selectors > 0)
+    length += Writer::EstimateBlockHeader (SELECTORS, selectors) + selectors;
+
+  length += Writer::EstimateBlob (NONCE, NONCE_SIZE);
+  if (interest.getScope () != ndn::Interest::NO_SCOPE)
+    length += Writer::EstimateNumber (SCOPE, interest.getScope ());
+  if (!interest.getInterestLifetime ().is_negative ())
+    length += Writer::EstimateNumber (INTEREST_LIFETIME, interest.getInterestLifetime ().total_milliseconds ());
+  return length;
+}
+
+static const signature::Sha256WithRsa &
+getSignature (const ndn::Data &data)
+{
+  const signature::Sha256WithRsa *signature = dynamic_cast<const signature::Sha256WithRsa *> (data.getSignature ().get ());
+  if (signature == 0)
+    BOOST_THROW_EXCEPTION (error::wire::Tlv ()
+                           << error::msg ("Sha256WithRsa signature is required, but not set"));
+  return *signature;
+}
+
+static uint32_t
+contentType (const Content &content)
+{
+  switch (content.getType ())
+    {
+    case Content::KEY:
+      return CONTENT_TYPE_KEY;
+    case Content::LINK:
+      return CONTENT_TYPE_LINK;
+    default: // other NDNB types have no NDN-TLV equivalents
+      return CONTENT_TYPE_BLOB;
+    }
+}
+
+static size_t
+metaInfoLength (const ndn::Data &data)
+{
+  const Content &content = data.getContent ();
+
+  size_t length = 0;
+  if (contentType (content) != CONTENT_TYPE_BLOB)
+    length += Writer::EstimateNumber (CONTENT_TYPE, contentType (content));
+  if (content.getFreshness () > Content::noFreshness)
+    length += Writer::EstimateNumber (FRESHNESS_PERIOD, content.getFreshness ().total_milliseconds ());
+  if (content.getFinalBlockId () != Content::noFinalBlock)
+    {
+      size_t finalBlockId = Writer::EstimateBlob (NAME_COMPONENT, content.getFinalBlockId ().size ());
+      length += Writer::EstimateBlockHeader (FINAL_BLOCK_ID, finalBlockId) + finalBlockId;
+    }
+  return length;
+}
+
+static size_t
+signatureInfoLength (const signature::Sha256WithRsa &signature)
+{
+  size_t keyLocator = Writer::EstimateName (signature.getKeyLocator ().getKeyName ());
+  return Writer::EstimateNumber (SIGNATURE_TYPE, SIGNATURE_SHA256_WITH_RSA) +
+    Writer::EstimateBlockHeader (KEY_LOCATOR, keyLocator) + keyLocator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t
+Writer::EstimateName (const Name &name)
+{
+  size_t length = nameLength (name);
+  return EstimateBlockHeader (NAME, length) + length;
+}
+
+void
+Writer::AppendName (unsigned char *&p, const Name &name)
+{
+  AppendBlockHeader (p, NAME, nameLength (name));
+  for (Name::const_iterator component = name.begin (); component != name.end (); component++)
+    {
+      AppendBlob (p, NAME_COMPONENT, component->buf (), component->size ());
+    }
+}
+
+size_t
+Writer::EstimateInterest (const ndn::Interest &interest)
+{
+  size_t length = interestLength (interest);
+  return EstimateBlockHeader (INTEREST, length) + length;
+}
+
+void
+Writer::AppendInterest (unsigned char *&p, const ndn::Interest &interest, uint32_t nonce, unsigned char *&nonceValue)
+{
+  AppendBlockHeader (p, INTEREST, interestLength (interest));
+  AppendName (p, interest.getName ());
+
+  size_t selectors = selectorsLength (interest);
+  if (selectors > 0)
+    {
+      AppendBlockHeader (p, SELECTORS, selectors);
+      if (interest.getMinSuffixComponents () != ndn::Interest::ncomps)
+        AppendNumber (p, MIN_SUFFIX_COMPONENTS, interest.getMinSuffixComponents ());
+      if (interest.getMaxSuffixComponents () != ndn::Interest::ncomps)
+        AppendNumber (p, MAX_SUFFIX_COMPONENTS, interest.getMaxSuffixComponents ());
+      if (interest.getExclude ().size () > 0)
+        {
+          AppendBlockHeader (p, EXCLUDE, excludeLength (interest.getExclude ()));
+          for (Exclude::const_reverse_iterator item = interest.getExclude ().rbegin (); item != interest.getExclude ().rend (); item++)
+            {
+              if (!item->first.empty ())
+                AppendBlob (p, NAME_COMPONENT, item->first.buf (), item->first.size ());
+              if (item->second)
+                AppendBlockHeader (p, ANY, 0);
+            }
+        }
+      if (interest.getChildSelector () != ndn::Interest::CHILD_DEFAULT)
+        AppendNumber (p, CHILD_SELECTOR, interest.getChildSelector ());
+    }
+
+  AppendBlockHeader (p, NONCE, NONCE_SIZE);
+  nonceValue = p;
+  memcpy (p, &nonce, NONCE_SIZE); // nonce is an opaque value, byte order does not matter
+  p += NONCE_SIZE;
+
+  if (interest.getScope () != ndn::Interest::NO_SCOPE)
+    AppendNumber (p, SCOPE, interest.getScope ());
+  if (!interest.getInterestLifetime ().is_negative ())
+    AppendNumber (p, INTEREST_LIFETIME, interest.getInterestLifetime ().total_milliseconds ());
+}
+
+size_t
+Writer::EstimateUnsignedData (const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+
+  size_t metaInfo = metaInfoLength (data);
+  size_t signatureInfo = signatureInfoLength (signature);
+
+  return EstimateName (data.getName ()) +
+    EstimateBlockHeader (META_INFO, metaInfo) + metaInfo +
+    EstimateBlob (CONTENT, data.content ().size ()) +
+    EstimateBlockHeader (SIGNATURE_INFO, signatureInfo) + signatureInfo;
+}
+
+void
+Writer::AppendUnsignedData (unsigned char *&p, const ndn::Data &data)
+{
+  const signature::Sha256WithRsa &signature = getSignature (data);
+  const Content &content = data.getContent ();
+
+  AppendName (p, data.getName ());
+
+  AppendBlockHeader (p, META_INFO, metaInfoLength (data));
+  if (contentType (content) != CONTENT_TYPE_BLOB)
+    AppendNumber (p, CONTENT_TYPE, contentType (content));
+  if (content.getFreshness () > Content::noFreshness)
+    AppendNumber (p, FRESHNESS_PERIOD, content.getFreshness ().total_milliseconds ());
+  if (content.getFinalBlockId () != Content::noFinalBlock)
+    {
+      const name::Component &finalBlockId = content.getFinalBlockId ();
+      AppendBlockHeader (p, FINAL_BLOCK_ID, EstimateBlob (NAME_COMPONENT, finalBlockId.size ()));
+      AppendBlob (p, NAME_COMPONENT, finalBlockId.buf (), finalBlockId.size ());
+    }
+
+  AppendBlob (p, CONTENT, data.content ().buf (), data.content ().size ());
+
+  AppendBlockHeader (p, SIGNATURE_INFO, signatureInfoLength (signature));
+  AppendNumber (p, SIGNATURE_TYPE, SIGNATURE_SHA256_WITH_RSA);
+  AppendBlockHeader (p, KEY_LOCATOR, EstimateName (signature.getKeyLocator ().getKeyName ()));
+  AppendName (p, signature.getKeyLocator ().getKeyName ());
+}
+
+static size_t
+signedSize (const ndn::Data &data)
+{
+  if (data.getSignedBlob ())
+    return data.getSignedBlob ()->signed_size ();
+  else
+    return Writer::EstimateUnsignedData (data);
+}
+
+size_t
+Writer::EstimateData (const ndn::Data &data)
+{
+  size_t length = signedSize (data) + EstimateBlob (SIGNATURE_VALUE, getSignature (data).getSignatureBits ().size ());
+  return EstimateBlockHeader (DATA, length) + length;
+}
+
+void
+Writer::AppendData (unsigned char *&p, const ndn::Data &data)
+{
+  const Blob &signatureBits = getSignature (data).getSignatureBits ();
+
+  size_t signedPortion = signedSize (data);
+  AppendBlockHeader (p, DATA, signedPortion + EstimateBlob (SIGNATURE_VALUE, signatureBits.size ()));
+
+  if (data.getSignedBlob ())
+    {
+      memcpy (p, data.getSignedBlob ()->signed_buf (), signedPortion);
+      p += signedPortion;
+    }
+  else
+    AppendUnsignedData (p, data);
+
+  AppendBlob (p, SIGNATURE_VALUE, signatureBits.buf (), signatureBits.size ());
+}
+
+size_t
+Writer::EstimateDataForSigning (const ndn::Data &data, size_t reserve)
+{
+  size_t length = EstimateUnsignedData (data) + EstimateBlob (SIGNATURE_VALUE, reserve);
+  return EstimateBlockHeader (DATA, length) + length;
+}
+
+void
+Writer::AppendDataForSigning (unsigned char *&p, const ndn::Data &data, size_t reserve,
+                              unsigned char *&signatureBits, unsigned char *&signedPortion)
+{
+  AppendBlockHeader (p, DATA, EstimateUnsignedData (data) + EstimateBlob (SIGNATURE_VALUE, reserve));
+
+  signedPortion = p;
+  AppendUnsignedData (p, data);
+
+  AppendBlockHeader (p, SIGNATURE_VALUE, reserve);
+  signatureBits = p;
+  memset (p, 0, reserve);
+  p += reserve;
+}
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_TLV_WRITER_H
+#define NDN_WIRE_TLV_WRITER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/data.h"
+
+#include "tlv.h"
+
+#include <cstring>
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+namespace tlv {
+
+/**
+ * @brief NDN-TLV encoder writing with raw pointer writes into a preallocated buffer
+ *
+ * Same interface as wire::ndnb::Writer: every Append method has a matching Estimate method
+ * returning the exact number of bytes the Append method writes, and Append methods move the
+ * pointer right after the written bytes.  Estimate methods of the elements return the size of
+ * the whole element (TYPE, LENGTH, and VALUE).
+ */
+class Writer
+{
+public:
+  /**
+   * @brief Estimate size of the VAR-NUMBER (1, 3, 5, or 9 bytes)
+   */
+  inline static size_t
+  EstimateVarNumber (uint64_t number);
+
+  inline static void
+  AppendVarNumber (unsigned char *&p, uint64_t number);
+
+  /**
+   * @brief Estimate size of TYPE and LENGTH of the element
+   */
+  inline static size_t
+  EstimateBlockHeader (uint32_t type, size_t length);
+
+  inline static void
+  AppendBlockHeader (unsigned char *&p, uint32_t type, size_t length);
+
+  inline static size_t
+  EstimateBlob (uint32_t type, size_t size);
+
+  inline static void
+  AppendBlob (unsigned char *&p, uint32_t type, const void *data, size_t size);
+
+  /**
+   * @brief Estimate size of the element with nonNegativeInteger value (1, 2, 4, or 8 bytes)
+   */
+  static size_t
+  EstimateNumber (uint32_t type, uint64_t number);
+
+  static void
+  AppendNumber (unsigned char *&p, uint32_t type, uint64_t number);
+
+  static size_t
+  EstimateName (const Name &name);
+
+  static void
+  AppendName (unsigned char *&p, const Name &name);
+
+  /**
+   * @brief Estimate size of the Interest (with Nonce)
+   */
+  static size_t
+  EstimateInterest (const ndn::Interest &interest);
+
+  /**
+   * @brief Append Interest
+   * @param nonceValue (out) position of the Nonce value, which can be patched before sending
+   */
+  static void
+  AppendInterest (unsigned char *&p, const ndn::Interest &interest, uint32_t nonce, unsigned char *&nonceValue);
+
+  /**
+   * @brief Estimate size of the Data packet (signature is required)
+   *
+   * If data has the signed blob, the signed portion is written as is
+   */
+  static size_t
+  EstimateData (const ndn::Data &data);
+
+  static void
+  AppendData (unsigned char *&p, const ndn::Data &data);
+
+  /**
+   * @brief Estimate size of the Data packet with exactly reserve bytes of SignatureValue
+   */
+  static size_t
+  EstimateDataForSigning (const ndn::Data &data, size_t reserve);
+
+  /**
+   * @brief Append Data packet with zeroed SignatureValue of reserve bytes
+   * @param signatureBits (out) beginning of the SignatureValue value, to be patched after signing
+   * @param signedPortion (out) beginning of the signed portion (it ends right before SignatureValue)
+   */
+  static void
+  AppendDataForSigning (unsigned char *&p, const ndn::Data &data, size_t reserve,
+                        unsigned char *&signatureBits, unsigned char *&signedPortion);
+
+  /**
+   * @brief Estimate size of the signed portion of the Data packet (Name, MetaInfo, Content, and SignatureInfo)
+   */
+  static size_t
+  EstimateUnsignedData (const ndn::Data &data);
+
+  static void
+  AppendUnsignedData (unsigned char *&p, const ndn::Data &data);
+};
+
+inline size_t
+Writer::EstimateVarNumber (uint64_t number)
+{
+  if (number < 253)
+    return 1;
+  else if (number <= 0xFFFF)
+    return 3;
+  else if (number <= 0xFFFFFFFF)
+    return 5;
+  else
+    return 9;
+}
+
+inline void
+Writer::AppendVarNumber (unsigned char *&p, uint64_t number)
+{
+  if (number < 253)
+    {
+      *p++ = static_cast<unsigned char> (number);
+      return;
+    }
+
+  size_t size;
+  if (number <= 0xFFFF)
+    {
+      *p++ = 253;
+      size = 2;
+    }
+  else if (number <= 0xFFFFFFFF)
+    {
+      *p++ = 254;
+      size = 4;
+    }
+  else
+    {
+      *p++ = 255;
+      size = 8;
+    }
+
+  // network byte order
+  for (size_t i = size; i > 0; i--)
+    {
+      p[i - 1] = number & 0xFF;
+      number >>= 8;
+    }
+  p += size;
+}
+
+inline size_t
+Writer::EstimateBlockHeader (uint32_t type, size_t length)
+{
+  return EstimateVarNumber (type) + EstimateVarNumber (length);
+}
+
+inline void
+Writer::AppendBlockHeader (unsigned char *&p, uint32_t type, size_t length)
+{
+  AppendVarNumber (p, type);
+  AppendVarNumber (p, length);
+}
+
+inline size_t
+Writer::EstimateBlob (uint32_t type, size_t size)
+{
+  return EstimateBlockHeader (type, size) + size;
+}
+
+inline void
+Writer::AppendBlob (unsigned char *&p, uint32_t type, const void *data, size_t size)
+{
+  AppendBlockHeader (p, type, size);
+  if (size > 0)
+    {
+      memcpy (p, data, size);
+      p += size;
+    }
+}
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_TLV_WRITER_H
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_WIRE_TLV_H
+#define NDN_WIRE_TLV_H
+
+#include "ndn.cxx/common.h"
+
+NDN_NAMESPACE_BEGIN
+
+namespace wire {
+
+/**
+ * @brief NDN-TLV encoding (NDN packet format specification 0.1)
+ *
+ * Every element is TYPE LENGTH VALUE, where TYPE and LENGTH are VAR-NUMBERs (1, 3, 5, or 9
+ * bytes), so boundaries of any element are known from its first few bytes.
+ */
+namespace tlv {
+
+/**
+ * @brief TLV types of the packet elements
+ */
+enum Type
+  {
+    INTEREST                     = 5,
+    DATA                         = 6,
+    NAME                         = 7,
+    NAME_COMPONENT               = 8,
+    SELECTORS                    = 9,
+    NONCE                        = 10,
+    SCOPE                        = 11,
+    INTEREST_LIFETIME            = 12,
+    MIN_SUFFIX_COMPONENTS        = 13,
+    MAX_SUFFIX_COMPONENTS        = 14,
+    PUBLISHER_PUBLIC_KEY_LOCATOR = 15,
+    EXCLUDE                      = 16,
+    CHILD_SELECTOR               = 17,
+    MUST_BE_FRESH                = 18,
+    ANY                          = 19,
+    META_INFO                    = 20,
+    CONTENT                      = 21,
+    SIGNATURE_INFO               = 22,
+    SIGNATURE_VALUE              = 23,
+    CONTENT_TYPE                 = 24,
+    FRESHNESS_PERIOD             = 25,
+    FINAL_BLOCK_ID               = 26,
+    SIGNATURE_TYPE               = 27,
+    KEY_LOCATOR                  = 28,
+    KEY_LOCATOR_DIGEST           = 29
+  };
+
+/**
+ * @brief Values of the ContentType element
+ */
+enum ContentType
+  {
+    CONTENT_TYPE_BLOB = 0,
+    CONTENT_TYPE_LINK = 1,
+    CONTENT_TYPE_KEY  = 2
+  };
+
+/**
+ * @brief Values of the SignatureType element
+ */
+enum SignatureType
+  {
+    DIGEST_SHA256 = 0,
+    SIGNATURE_SHA256_WITH_RSA = 1
+  };
+
+/// @brief Size of the Nonce value
+const size_t NONCE_SIZE = 4;
+
+} // tlv
+} // wire
+
+NDN_NAMESPACE_END
+
+#endif // NDN_WIRE_TLV_H
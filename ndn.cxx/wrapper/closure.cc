@@ -10,6 +10,8 @@
 
 #include "closure.h"
 
+#include "executor/strand.h"
+
 namespace ndn {
 
   Closure::Closure (const DataCallback &dataCallback, 
@@ -20,6 +22,7 @@ namespace ndn {
     , m_timeoutCallback (timeoutCallback)
     , m_unverifiedCallback (unverifiedCallback)
     , m_stepCount(stepCount)
+    , m_strand (new Strand ())
   {}
 
   Closure::~Closure ()
@@ -16,6 +16,8 @@
 #include "ndn.cxx/interest.h"
 #include "ndn.cxx/data.h"
 
+class Strand;
+
 namespace ndn {
 
   class Closure;
@@ -41,6 +43,7 @@ namespace ndn {
     TimeoutCallback m_timeoutCallback;
     UnverifiedCallback m_unverifiedCallback;
     int m_stepCount;
+    Ptr<Strand> m_strand; ///< @brief callbacks of the closure and its copies are called one at a time, in order
 
   };
 
@@ -0,0 +1,454 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "segment-fetcher.h"
+
+#include "wrapper.h"
+#include "closure.h"
+
+#include <boost/bind.hpp>
+#include <cmath>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.SegmentFetcher");
+
+using namespace std;
+
+namespace ndn {
+
+RttEstimator::RttEstimator (double initialRto/* = 1.0*/, double minRto/* = 0.05*/, double maxRto/* = 4.0*/)
+  : m_srtt (-1)
+  , m_rttvar (0)
+  , m_rto (initialRto)
+  , m_minRto (minRto)
+  , m_maxRto (maxRto)
+{
+}
+
+void
+RttEstimator::addMeasurement (double rtt)
+{
+  if (m_srtt < 0)
+    {
+      m_srtt = rtt;
+      m_rttvar = rtt / 2;
+    }
+  else
+    {
+      // RTTVAR is updated with the old SRTT
+      m_rttvar = 0.75 * m_rttvar + 0.25 * std::abs (m_srtt - rtt);
+      m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+
+  m_rto = std::min (std::max (m_srtt + 4 * m_rttvar, m_minRto), m_maxRto);
+}
+
+void
+RttEstimator::backoff ()
+{
+  m_rto = std::min (m_rto * 2, m_maxRto);
+}
+
+void
+RttEstimator::setRtoLimits (double minRto, double maxRto)
+{
+  m_minRto = minRto;
+  m_maxRto = maxRto;
+  m_rto = std::min (std::max (m_rto, m_minRto), m_maxRto);
+}
+
+double
+RttEstimator::getSmoothedRtt () const
+{
+  return m_srtt;
+}
+
+double
+RttEstimator::getRttVariation () const
+{
+  return m_rttvar;
+}
+
+double
+RttEstimator::getRto () const
+{
+  return m_rto;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SegmentFetcher::Statistics::Statistics ()
+  : m_segments (0)
+  , m_bytes (0)
+  , m_retransmissions (0)
+  , m_windowDecreases (0)
+  , m_duration (0, 0, 0, 0)
+{
+}
+
+double
+SegmentFetcher::Statistics::getThroughput () const
+{
+  if (m_duration.total_microseconds () <= 0)
+    return 0;
+
+  return m_bytes * 1000000.0 / m_duration.total_microseconds ();
+}
+
+const double SegmentFetcher::DEFAULT_INITIAL_WINDOW = 2;
+const double SegmentFetcher::DEFAULT_MAX_WINDOW = 256;
+const int SegmentFetcher::DEFAULT_MAX_RETRIES = 8;
+
+SegmentFetcher::SegmentFetcher (Ptr<Wrapper> wrapper, const Name &prefix,
+                                const CompletionCallback &completion,
+                                const SegmentCallback &segment/* = SegmentCallback ()*/)
+  : m_wrapper (wrapper)
+  , m_prefix (prefix)
+  , m_completion (completion)
+  , m_segmentCallback (segment)
+  , m_running (false)
+  , m_finished (false)
+  , m_window (DEFAULT_INITIAL_WINDOW)
+  , m_slowStartThreshold (DEFAULT_MAX_WINDOW)
+  , m_maxWindow (DEFAULT_MAX_WINDOW)
+  , m_maxRetries (DEFAULT_MAX_RETRIES)
+  , m_nextSegment (0)
+  , m_nextToDeliver (0)
+  , m_hasFinalSegment (false)
+  , m_finalSegment (0)
+{
+  if (m_segmentCallback.empty ())
+    m_content = Create<Blob> ();
+}
+
+void
+SegmentFetcher::setWindow (double initialWindow, double maxWindow)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_maxWindow = std::max (maxWindow, 1.0);
+  m_window = std::min (std::max (initialWindow, 1.0), m_maxWindow);
+  m_slowStartThreshold = m_maxWindow;
+}
+
+void
+SegmentFetcher::setRtoLimits (double minRto, double maxRto)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_rtt.setRtoLimits (minRto, maxRto);
+}
+
+void
+SegmentFetcher::setMaxRetries (int maxRetries)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_maxRetries = maxRetries;
+}
+
+void
+SegmentFetcher::start ()
+{
+  _LOG_DEBUG ("Start fetching " << m_prefix);
+
+  bool failed;
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (m_running || m_finished)
+      return;
+
+    // one closure for all segments, segment number is taken from the name
+    m_closure = Ptr<Closure> (new Closure (boost::bind (&SegmentFetcher::onData, shared_from_this (), _1),
+                                           boost::bind (&SegmentFetcher::onTimeout, shared_from_this (), _1, _2),
+                                           boost::bind (&SegmentFetcher::onUnverified, shared_from_this (), _1)));
+    m_running = true;
+    m_startTime = time::Now ();
+    failed = !fillWindow ();
+  }
+
+  if (failed && !m_completion.empty ())
+    m_completion (shared_from_this (), false);
+}
+
+void
+SegmentFetcher::cancel ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  if (m_finished)
+    return;
+
+  // Interests that are still pending are ignored when they are satisfied or time out
+  finish (false);
+}
+
+bool
+SegmentFetcher::isFinished ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  return m_finished;
+}
+
+Ptr<Blob>
+SegmentFetcher::getContent ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  return m_content;
+}
+
+SegmentFetcher::Statistics
+SegmentFetcher::getStatistics ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  Statistics statistics = m_statistics;
+  if (m_running)
+    statistics.m_duration = time::Now () - m_startTime;
+  return statistics;
+}
+
+double
+SegmentFetcher::getWindow ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  return m_window;
+}
+
+double
+SegmentFetcher::getRto ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  return m_rtt.getRto ();
+}
+
+void
+SegmentFetcher::onData (Ptr<Data> data)
+{
+  bool completed = false;
+  bool success = false;
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (!m_running)
+      return;
+
+    uint64_t segmentNo;
+    if (!parseSegmentNo (data->getName (), segmentNo))
+      return;
+
+    map<uint64_t, PendingSegment>::iterator pending = m_pending.find (segmentNo);
+    if (pending == m_pending.end ())
+      return; // duplicate, or beyond the final segment
+
+    Time now = time::Now ();
+    if (pending->second.m_retries == 0)
+      {
+        // Karn's algorithm: it is not known which transmission a retransmitted segment answers
+        m_rtt.addMeasurement ((now - pending->second.m_sentAt).total_microseconds () / 1000000.0);
+      }
+    m_pending.erase (pending);
+
+    const name::Component &finalBlockId = data->getContent ().getFinalBlockId ();
+    if (!m_hasFinalSegment && finalBlockId != Content::noFinalBlock)
+      {
+        try
+          {
+            m_finalSegment = finalBlockId.toSeqNum ();
+            m_hasFinalSegment = true;
+            _LOG_DEBUG ("Final segment of " << m_prefix << " is " << m_finalSegment);
+
+            // Interests for segments that do not exist are no longer waited for
+            m_pending.erase (m_pending.upper_bound (m_finalSegment), m_pending.end ());
+          }
+        catch (std::exception &e)
+          {
+            _LOG_ERROR ("Invalid FinalBlockId in " << data->getName ());
+          }
+      }
+
+    // additive increase: +1 per segment in slow start, +1 per window of segments afterwards
+    if (m_window < m_slowStartThreshold)
+      m_window += 1;
+    else
+      m_window += 1 / m_window;
+    m_window = std::min (m_window, m_maxWindow);
+
+    if (!m_hasFinalSegment || segmentNo <= m_finalSegment)
+      {
+        m_received[segmentNo] = data;
+        deliverSegments ();
+      }
+
+    if (m_hasFinalSegment && m_nextToDeliver > m_finalSegment)
+      {
+        finish (true);
+        completed = true;
+        success = true;
+      }
+    else if (!fillWindow ())
+      {
+        completed = true;
+      }
+  }
+
+  if (completed && !m_completion.empty ())
+    m_completion (shared_from_this (), success);
+}
+
+void
+SegmentFetcher::onUnverified (Ptr<Data> data)
+{
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    uint64_t segmentNo;
+    if (!m_running || !parseSegmentNo (data->getName (), segmentNo) || m_pending.find (segmentNo) == m_pending.end ())
+      return;
+
+    _LOG_ERROR ("Segment " << data->getName () << " cannot be verified");
+    finish (false);
+  }
+
+  if (!m_completion.empty ())
+    m_completion (shared_from_this (), false);
+}
+
+void
+SegmentFetcher::onTimeout (Ptr<Closure> closure, Ptr<Interest> interest)
+{
+  bool completed = false;
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (!m_running)
+      return;
+
+    uint64_t segmentNo;
+    if (!parseSegmentNo (interest->getName (), segmentNo))
+      return;
+
+    map<uint64_t, PendingSegment>::iterator pending = m_pending.find (segmentNo);
+    if (pending == m_pending.end ())
+      return;
+
+    if (pending->second.m_retries >= m_maxRetries)
+      {
+        _LOG_ERROR ("Segment " << interest->getName () << " timed out " << pending->second.m_retries + 1 << " times");
+        finish (false);
+        completed = true;
+      }
+    else
+      {
+        m_rtt.backoff ();
+
+        // multiplicative decrease, once per RTT (a burst of timeouts is a single congestion event)
+        Time now = time::Now ();
+        double srtt = std::max (m_rtt.getSmoothedRtt (), 0.0);
+        if (m_lastDecrease.is_not_a_date_time () ||
+            (now - m_lastDecrease).total_microseconds () >= srtt * 1000000)
+          {
+            m_slowStartThreshold = std::max (m_window / 2, 1.0);
+            m_window = m_slowStartThreshold;
+            m_lastDecrease = now;
+            m_statistics.m_windowDecreases ++;
+          }
+
+        _LOG_TRACE ("Retransmit " << interest->getName () << ", window " << m_window << ", RTO " << m_rtt.getRto ());
+        pending->second.m_retries ++;
+        m_statistics.m_retransmissions ++;
+        completed = !expressInterest (segmentNo) || !fillWindow ();
+      }
+  }
+
+  if (completed && !m_completion.empty ())
+    m_completion (shared_from_this (), false);
+}
+
+bool
+SegmentFetcher::parseSegmentNo (const Name &name, uint64_t &segmentNo) const
+{
+  if (name.size () <= m_prefix.size ())
+    return false;
+
+  try
+    {
+      segmentNo = name.get (m_prefix.size ()).toSeqNum ();
+      return true;
+    }
+  catch (std::exception &e)
+    {
+      _LOG_DEBUG ("Not a segment of " << m_prefix << ": " << name);
+      return false;
+    }
+}
+
+bool
+SegmentFetcher::fillWindow ()
+{
+  while (m_pending.size () < static_cast<size_t> (m_window) &&
+         (!m_hasFinalSegment || m_nextSegment <= m_finalSegment))
+    {
+      PendingSegment &pending = m_pending[m_nextSegment];
+      pending.m_retries = 0;
+      if (!expressInterest (m_nextSegment))
+        return false;
+
+      m_nextSegment ++;
+    }
+  return true;
+}
+
+bool
+SegmentFetcher::expressInterest (uint64_t segmentNo)
+{
+  Ptr<Interest> interest (new Interest (Name (m_prefix).appendSeqNum (segmentNo)));
+  interest->setInterestLifetime (m_rtt.getRto ());
+
+  m_pending[segmentNo].m_sentAt = time::Now ();
+  if (m_wrapper->sendInterest (interest, m_closure) != 0)
+    {
+      _LOG_ERROR ("Cannot express Interest for " << interest->getName ());
+      finish (false);
+      return false;
+    }
+  return true;
+}
+
+void
+SegmentFetcher::deliverSegments ()
+{
+  map<uint64_t, Ptr<Data> >::iterator segment = m_received.begin ();
+  while (segment != m_received.end () && segment->first == m_nextToDeliver)
+    {
+      m_statistics.m_segments ++;
+      m_statistics.m_bytes += segment->second->content ().size ();
+
+      if (m_segmentCallback.empty ())
+        m_content->insert (m_content->end (), segment->second->content ().begin (), segment->second->content ().end ());
+      else
+        m_segmentCallback (segment->first, segment->second);
+
+      m_received.erase (segment++);
+      m_nextToDeliver ++;
+    }
+}
+
+void
+SegmentFetcher::finish (bool success)
+{
+  if (m_running)
+    m_statistics.m_duration = time::Now () - m_startTime;
+
+  m_running = false;
+  m_finished = true;
+  m_pending.clear ();
+  m_received.clear ();
+  m_closure.reset (); // closure references the fetcher, Interests still pending keep it alive until they expire
+
+  _LOG_DEBUG ("Fetching " << m_prefix << (success ? " finished: " : " failed: ")
+              << m_statistics.m_segments << " segments, " << m_statistics.m_bytes << " bytes in "
+              << m_statistics.m_duration.total_milliseconds () << "ms");
+}
+
+} // ndn
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_SEGMENT_FETCHER_H
+#define NDN_SEGMENT_FETCHER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/interest.h"
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+
+namespace ndn {
+
+class Wrapper;
+class Closure;
+
+/**
+ * @brief Estimator of the round-trip time and retransmission timeout of a flow (Jacobson/Karels)
+ *
+ * SRTT and RTTVAR are exponentially weighted averages (gains 1/8 and 1/4) of measured RTTs,
+ * RTO = SRTT + 4 * RTTVAR, clamped to [minRto, maxRto] and doubled on every timeout.
+ */
+class RttEstimator
+{
+public:
+  RttEstimator (double initialRto = 1.0, double minRto = 0.05, double maxRto = 4.0);
+
+  /**
+   * @brief Update estimation with a new measurement (should not be taken for retransmitted packets)
+   */
+  void
+  addMeasurement (double rtt);
+
+  /**
+   * @brief Double RTO after a timeout (it is recomputed with the next measurement)
+   */
+  void
+  backoff ();
+
+  void
+  setRtoLimits (double minRto, double maxRto);
+
+  /// @brief Smoothed RTT in seconds, negative if nothing has been measured
+  double
+  getSmoothedRtt () const;
+
+  double
+  getRttVariation () const;
+
+  /// @brief Retransmission timeout in seconds
+  double
+  getRto () const;
+
+private:
+  double m_srtt;
+  double m_rttvar;
+  double m_rto;
+  double m_minRto;
+  double m_maxRto;
+};
+
+/**
+ * @brief Fetcher of a segmented object (/prefix/%00%00, /prefix/%00%01, ...) with a window of
+ *        outstanding Interests
+ *
+ * The window grows by one segment per RTT (or per received segment in slow start) and is halved
+ * at most once per RTT when an Interest times out (AIMD).  Interest lifetime is the RTO of the
+ * flow, timed out Interests are retransmitted.  Fetching stops at the segment announced as
+ * FinalBlockId.  Segments are delivered in order, either appended into a contiguous buffer
+ * (getContent ()) or passed to the segment callback as they arrive.
+ *
+ * Callbacks are called from executor threads of the wrapper.
+ */
+class SegmentFetcher : public boost::enable_shared_from_this<SegmentFetcher>, boost::noncopyable
+{
+public:
+  /**
+   * @brief Callback receiving segments in order, called while the fetcher is locked (it should not
+   *        call methods of the fetcher)
+   */
+  typedef boost::function<void (uint64_t segmentNo, Ptr<Data> data)> SegmentCallback;
+
+  /**
+   * @brief Callback called once all segments have been fetched (success is true), or fetching
+   *        has failed (too many retransmissions of a segment, unverified segment)
+   */
+  typedef boost::function<void (Ptr<SegmentFetcher> fetcher, bool success)> CompletionCallback;
+
+  struct Statistics
+  {
+    Statistics ();
+
+    /// @brief Goodput in bytes per second
+    double
+    getThroughput () const;
+
+    uint64_t m_segments;
+    uint64_t m_bytes;            ///< @brief bytes of content delivered
+    uint64_t m_retransmissions;
+    uint64_t m_windowDecreases;
+    TimeInterval m_duration;     ///< @brief time since start, until completion if finished
+  };
+
+  static const double DEFAULT_INITIAL_WINDOW;
+  static const double DEFAULT_MAX_WINDOW;
+  static const int DEFAULT_MAX_RETRIES;
+
+  /**
+   * @brief Create fetcher (call start () to begin fetching)
+   * @param wrapper wrapper used to send Interests
+   * @param prefix name of the object, segments are named prefix + sequence number
+   * @param completion callback called when fetching finishes
+   * @param segment callback receiving segments in order. If set, content is not buffered
+   */
+  SegmentFetcher (Ptr<Wrapper> wrapper, const Name &prefix,
+                  const CompletionCallback &completion,
+                  const SegmentCallback &segment = SegmentCallback ());
+
+  /**
+   * @brief Set initial and maximum size of the window (in segments), should be called before start ()
+   */
+  void
+  setWindow (double initialWindow, double maxWindow);
+
+  /**
+   * @brief Set limits of the retransmission timeout (in seconds), should be called before start ()
+   */
+  void
+  setRtoLimits (double minRto, double maxRto);
+
+  /**
+   * @brief Set how many times a segment is retransmitted before fetching fails
+   */
+  void
+  setMaxRetries (int maxRetries);
+
+  void
+  start ();
+
+  /**
+   * @brief Stop fetching, completion callback is not called
+   */
+  void
+  cancel ();
+
+  bool
+  isFinished ();
+
+  /**
+   * @brief Get content of the fetched segments delivered so far (null if segment callback is used)
+   */
+  Ptr<Blob>
+  getContent ();
+
+  Statistics
+  getStatistics ();
+
+  double
+  getWindow ();
+
+  double
+  getRto ();
+
+private:
+  struct PendingSegment
+  {
+    Time m_sentAt;
+    int m_retries;
+  };
+
+  void
+  onData (Ptr<Data> data);
+
+  void
+  onUnverified (Ptr<Data> data);
+
+  void
+  onTimeout (Ptr<Closure> closure, Ptr<Interest> interest);
+
+  bool
+  parseSegmentNo (const Name &name, uint64_t &segmentNo) const;
+
+  bool
+  fillWindow ();
+
+  bool
+  expressInterest (uint64_t segmentNo);
+
+  void
+  deliverSegments ();
+
+  void
+  finish (bool success);
+
+private:
+  Ptr<Wrapper> m_wrapper;
+  Name m_prefix;
+  CompletionCallback m_completion;
+  SegmentCallback m_segmentCallback;
+  Ptr<Closure> m_closure;
+
+  boost::mutex m_mutex;
+  bool m_running;
+  bool m_finished;
+
+  double m_window;
+  double m_slowStartThreshold;
+  double m_maxWindow;
+  int m_maxRetries;
+  RttEstimator m_rtt;
+  Time m_lastDecrease;
+
+  uint64_t m_nextSegment;       // first segment never requested
+  uint64_t m_nextToDeliver;
+  bool m_hasFinalSegment;
+  uint64_t m_finalSegment;
+
+  std::map<uint64_t, PendingSegment> m_pending;
+  std::map<uint64_t, Ptr<Data> > m_received; // out-of-order segments
+
+  Ptr<Blob> m_content;
+  Time m_startTime;
+  Statistics m_statistics;
+};
+
+} // ndn
+
+#endif // NDN_SEGMENT_FETCHER_H
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "segmented-producer.h"
+
+#include "wrapper.h"
+
+#include <boost/bind.hpp>
+
+#include <sys/stat.h>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.SegmentedProducer");
+
+typedef boost::error_info<struct tag_errmsg, std::string> errmsg_info_str;
+
+using namespace std;
+
+namespace ndn {
+
+const size_t SegmentedProducer::DEFAULT_SEGMENT_SIZE = 4096;
+
+SegmentedProducer::SegmentedProducer (Ptr<Wrapper> wrapper, const Name &prefix, const std::string &fileName,
+                                      size_t segmentSize/* = DEFAULT_SEGMENT_SIZE*/,
+                                      uint64_t version/* = Name::nversion*/)
+  : m_wrapper (wrapper)
+  , m_prefix (prefix)
+  , m_segmentSize (segmentSize > 0 ? segmentSize : DEFAULT_SEGMENT_SIZE)
+  , m_freshness (Wrapper::DEFAULT_FRESHNESS)
+  , m_started (false)
+  , m_publishedSegments (0)
+{
+  struct stat info;
+  if (stat (fileName.c_str (), &info) != 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot open " + fileName));
+    }
+  m_size = info.st_size;
+
+  if (m_size > 0) // empty file cannot be mapped
+    {
+      try
+        {
+          m_file.open (fileName);
+        }
+      catch (std::exception &e)
+        {
+          BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot map " + fileName + ": " + e.what ()));
+        }
+      m_size = m_file.size ();
+    }
+
+  init (version);
+}
+
+SegmentedProducer::SegmentedProducer (Ptr<Wrapper> wrapper, const Name &prefix, Ptr<std::istream> stream,
+                                      size_t segmentSize/* = DEFAULT_SEGMENT_SIZE*/,
+                                      uint64_t version/* = Name::nversion*/)
+  : m_wrapper (wrapper)
+  , m_prefix (prefix)
+  , m_segmentSize (segmentSize > 0 ? segmentSize : DEFAULT_SEGMENT_SIZE)
+  , m_stream (stream)
+  , m_freshness (Wrapper::DEFAULT_FRESHNESS)
+  , m_started (false)
+  , m_publishedSegments (0)
+{
+  m_stream->seekg (0, std::ios::end);
+  std::streamoff size = m_stream->tellg ();
+  if (!*m_stream || size < 0)
+    {
+      BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("stream does not support seeking"));
+    }
+  m_size = size;
+
+  init (version);
+}
+
+SegmentedProducer::~SegmentedProducer ()
+{
+  stop ();
+}
+
+void
+SegmentedProducer::init (uint64_t version)
+{
+  m_name = m_prefix;
+  m_name.appendVersion (version);
+
+  // empty object is a single empty segment
+  m_segmentCount = m_size == 0 ? 1 : (m_size + m_segmentSize - 1) / m_segmentSize;
+
+  _LOG_DEBUG ("Producer of " << m_name << ": " << m_size << " bytes in " << m_segmentCount << " segments");
+}
+
+void
+SegmentedProducer::setSigningIdentity (const Name &identity)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_identity = identity;
+}
+
+void
+SegmentedProducer::setFreshness (int freshness)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_freshness = freshness;
+}
+
+int
+SegmentedProducer::start ()
+{
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (m_started)
+      return 0;
+    m_started = true;
+  }
+
+  // wrapper does not keep the producer alive, Interests that arrive after it is destroyed are ignored
+  boost::weak_ptr<SegmentedProducer> self = shared_from_this ();
+  return m_wrapper->setInterestFilter (m_prefix, boost::bind (onInterestDispatch, self, _1));
+}
+
+void
+SegmentedProducer::stop ()
+{
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (!m_started)
+      return;
+    m_started = false;
+  }
+
+  m_wrapper->clearInterestFilter (m_prefix);
+}
+
+const Name &
+SegmentedProducer::getName () const
+{
+  return m_name;
+}
+
+uint64_t
+SegmentedProducer::getSize () const
+{
+  return m_size;
+}
+
+uint64_t
+SegmentedProducer::getSegmentCount () const
+{
+  return m_segmentCount;
+}
+
+uint64_t
+SegmentedProducer::getPublishedSegments ()
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  return m_publishedSegments;
+}
+
+void
+SegmentedProducer::onInterestDispatch (boost::weak_ptr<SegmentedProducer> producer, Ptr<Interest> interest)
+{
+  Ptr<SegmentedProducer> self = producer.lock ();
+  if (self)
+    self->onInterest (interest);
+}
+
+void
+SegmentedProducer::onPublishedDispatch (boost::weak_ptr<SegmentedProducer> producer, uint64_t segmentNo, bool published)
+{
+  Ptr<SegmentedProducer> self = producer.lock ();
+  if (self)
+    self->onPublished (segmentNo, published);
+}
+
+void
+SegmentedProducer::onInterest (Ptr<Interest> interest)
+{
+  const Name &name = interest->getName ();
+
+  uint64_t segmentNo = 0;
+  if (name.size () > m_name.size ())
+    {
+      if (name.getPrefix (m_name.size ()) != m_name)
+        return; // another version or another object
+
+      try
+        {
+          segmentNo = name.get (m_name.size ()).toSeqNum ();
+        }
+      catch (std::exception &e)
+        {
+          _LOG_DEBUG ("Not a segment Interest: " << name);
+          return;
+        }
+
+      if (segmentNo >= m_segmentCount)
+        return;
+    }
+  else if (m_name.getPrefix (name.size ()) != name)
+    {
+      return;
+    }
+
+  Name identity;
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    if (!m_started || !m_publishing.insert (segmentNo).second)
+      return;
+    identity = m_identity;
+  }
+
+  _LOG_TRACE ("Publish segment " << segmentNo << " of " << m_name);
+  Ptr<Data> data = createSegment (segmentNo);
+
+  // blocks this strand while the signing threads of the wrapper are busy (see class description)
+  boost::weak_ptr<SegmentedProducer> self = shared_from_this ();
+  if (m_wrapper->publishDataByIdentityAsync (data, identity, boost::bind (onPublishedDispatch, self, segmentNo, _2)) != 0)
+    {
+      onPublished (segmentNo, false);
+    }
+}
+
+void
+SegmentedProducer::onPublished (uint64_t segmentNo, bool published)
+{
+  boost::mutex::scoped_lock lock (m_mutex);
+  m_publishing.erase (segmentNo);
+  if (published)
+    {
+      m_publishedSegments ++;
+    }
+  else
+    {
+      _LOG_ERROR ("Segment " << segmentNo << " of " << m_name << " cannot be published");
+    }
+}
+
+Ptr<Data>
+SegmentedProducer::createSegment (uint64_t segmentNo)
+{
+  uint64_t offset = segmentNo * m_segmentSize;
+  size_t length = std::min<uint64_t> (m_segmentSize, m_size - offset);
+
+  Ptr<Data> data = Create<Data> ();
+  data->setName (Name (m_name).appendSeqNum (segmentNo));
+
+  int freshness;
+  {
+    boost::mutex::scoped_lock lock (m_mutex);
+    freshness = m_freshness;
+  }
+
+  name::Component finalBlockId = name::Component::fromNumberWithMarker (m_segmentCount - 1, 0x00);
+  if (m_file.is_open ())
+    {
+      // the only copy of the payload, straight from the mapping
+      data->setContent (Content (m_file.data () + offset, length, Content::DATA, time::Seconds (freshness), finalBlockId));
+    }
+  else
+    {
+      data->setContent (Content (0, 0, Content::DATA, time::Seconds (freshness), finalBlockId));
+      if (m_stream)
+        {
+          Blob &content = data->content ();
+          content.resize (length);
+
+          boost::mutex::scoped_lock lock (m_streamMutex);
+          m_stream->clear ();
+          m_stream->seekg (offset);
+          m_stream->read (content.buf (), length);
+          if (static_cast<size_t> (m_stream->gcount ()) != length)
+            {
+              _LOG_ERROR ("Cannot read segment " << segmentNo << " of " << m_name << " from the stream");
+              content.resize (m_stream->gcount ());
+            }
+        }
+    }
+
+  return data;
+}
+
+} // ndn
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_SEGMENTED_PRODUCER_H
+#define NDN_SEGMENTED_PRODUCER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/fields/name.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/interest.h"
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <istream>
+#include <set>
+
+namespace ndn {
+
+class Wrapper;
+
+/**
+ * @brief Producer of a large object (file or seekable stream) as a sequence of segments
+ *        /prefix/<version>/%00%00, /prefix/<version>/%00%01, ...
+ *
+ * Segments are not prepared in advance: every Interest for a segment is answered by reading the
+ * segment from the memory-mapped file (or the stream), and signing it in the signing threads of
+ * the wrapper (Wrapper::publishDataByIdentityAsync), so memory use does not depend on the size
+ * of the object.  Every segment carries FinalBlockId with the number of the last segment.
+ * Interests for the unversioned prefix are answered with the first segment.
+ *
+ * Interests are handled in the callback thread of the wrapper (on the strand of the prefix), and
+ * handing a segment to the signing threads blocks while the wrapper has the maximum number of
+ * packets in signing.  A fast consumer thus stalls further Interests for the prefix (the wrapper
+ * queues them) until segments are signed and sent, which bounds the memory used for segments.
+ * Callbacks of other prefixes run on other strands; use enough callback threads of the wrapper
+ * if they should not wait for the signing threads.
+ */
+class SegmentedProducer : public boost::enable_shared_from_this<SegmentedProducer>, boost::noncopyable
+{
+public:
+  static const size_t DEFAULT_SEGMENT_SIZE;
+
+  /**
+   * @brief Create producer of the memory-mapped file
+   * @param wrapper wrapper used to receive Interests and publish segments
+   * @param prefix name of the object (without version)
+   * @param fileName path to the file, should not be modified while the producer is running
+   * @param segmentSize size of payload of every segment (except the last one), the encoded segment
+   *        should fit into the maximum packet size of the transport of the wrapper and of the
+   *        consumers (e.g., UnixTransport::DEFAULT_MAX_PACKET_SIZE, half of the ring of ShmTransport),
+   *        larger segments make the consumers drop the connection
+   * @param version version of the object, if Name::nversion, current time is used
+   */
+  SegmentedProducer (Ptr<Wrapper> wrapper, const Name &prefix, const std::string &fileName,
+                     size_t segmentSize = DEFAULT_SEGMENT_SIZE, uint64_t version = Name::nversion);
+
+  /**
+   * @brief Create producer of the stream (should support seeking, segments are read on demand)
+   */
+  SegmentedProducer (Ptr<Wrapper> wrapper, const Name &prefix, Ptr<std::istream> stream,
+                     size_t segmentSize = DEFAULT_SEGMENT_SIZE, uint64_t version = Name::nversion);
+
+  ~SegmentedProducer ();
+
+  /**
+   * @brief Set identity which default certificate signs the segments (by default, the default identity)
+   */
+  void
+  setSigningIdentity (const Name &identity);
+
+  /**
+   * @brief Set freshness of the segments, in seconds (FreshnessSeconds of the packets, 0 to omit it)
+   */
+  void
+  setFreshness (int freshness);
+
+  /**
+   * @brief Register prefix and start answering Interests
+   * @returns 0 on success, -1 if the prefix cannot be registered
+   */
+  int
+  start ();
+
+  void
+  stop ();
+
+  /**
+   * @brief Get versioned name of the object (prefix of all segment names)
+   */
+  const Name &
+  getName () const;
+
+  uint64_t
+  getSize () const;
+
+  uint64_t
+  getSegmentCount () const;
+
+  /**
+   * @brief Get number of segments published so far
+   */
+  uint64_t
+  getPublishedSegments ();
+
+private:
+  void
+  init (uint64_t version);
+
+  static void
+  onInterestDispatch (boost::weak_ptr<SegmentedProducer> producer, Ptr<Interest> interest);
+
+  static void
+  onPublishedDispatch (boost::weak_ptr<SegmentedProducer> producer, uint64_t segmentNo, bool published);
+
+  void
+  onInterest (Ptr<Interest> interest);
+
+  void
+  onPublished (uint64_t segmentNo, bool published);
+
+  Ptr<Data>
+  createSegment (uint64_t segmentNo);
+
+private:
+  Ptr<Wrapper> m_wrapper;
+  Name m_prefix;
+  Name m_name;
+  size_t m_segmentSize;
+  uint64_t m_size;
+  uint64_t m_segmentCount;
+
+  boost::iostreams::mapped_file_source m_file;
+  Ptr<std::istream> m_stream;
+  boost::mutex m_streamMutex; // reading the stream moves its position
+
+  boost::mutex m_mutex;
+  Name m_identity;
+  int m_freshness;
+  bool m_started;
+  std::set<uint64_t> m_publishing; // segments being signed, repeated Interests for them are ignored
+  uint64_t m_publishedSegments;
+};
+
+} // ndn
+
+#endif // NDN_SEGMENTED_PRODUCER_H
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "sharded-wrapper.h"
+
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/bind.hpp>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.ShardedWrapper");
+
+using namespace std;
+
+namespace ndn {
+
+const size_t ShardedWrapper::SHARED_FILTER = static_cast<size_t> (-1);
+
+ShardedWrapper::ShardedWrapper (int shards,
+                                Ptr<security::Keychain> keychain/* = Ptr<security::Keychain>::Create ()*/,
+                                const TransportFactory &transportFactory/* = TransportFactory ()*/,
+                                int callbackThreads/* = Wrapper::DEFAULT_CALLBACK_THREADS*/)
+{
+  for (int i = 0; i < std::max (shards, 1); i++)
+    {
+      Ptr<Transport> transport;
+      if (!transportFactory.empty ())
+        transport = transportFactory ();
+
+      m_shards.push_back (Ptr<Wrapper> (new Wrapper (keychain, transport, callbackThreads)));
+    }
+
+  _LOG_DEBUG ("Started " << m_shards.size () << " shards");
+}
+
+ShardedWrapper::~ShardedWrapper ()
+{
+  shutdown ();
+}
+
+void
+ShardedWrapper::shutdown ()
+{
+  BOOST_FOREACH (const Ptr<Wrapper> &shard, m_shards)
+    {
+      shard->shutdown ();
+    }
+}
+
+size_t
+ShardedWrapper::getShardCount () const
+{
+  return m_shards.size ();
+}
+
+Ptr<Wrapper>
+ShardedWrapper::getShard (size_t index) const
+{
+  return m_shards[index % m_shards.size ()];
+}
+
+Ptr<Wrapper>
+ShardedWrapper::getShard (const Name &name) const
+{
+  return m_shards[hashName (name) % m_shards.size ()];
+}
+
+void
+ShardedWrapper::setOutboundLimit (size_t maxQueuedBytes, const Wrapper::BackpressureCallback &backpressureCallback)
+{
+  BOOST_FOREACH (const Ptr<Wrapper> &shard, m_shards)
+    {
+      shard->setOutboundLimit (maxQueuedBytes, backpressureCallback);
+    }
+}
+
+void
+ShardedWrapper::setSigningWorkers (int workers, size_t maxInFlight)
+{
+  BOOST_FOREACH (const Ptr<Wrapper> &shard, m_shards)
+    {
+      shard->setSigningWorkers (workers, maxInFlight);
+    }
+}
+
+int
+ShardedWrapper::setInterestFilter (const Name &prefix, const Wrapper::InterestCallback &interestCallback, bool record/* = true*/)
+{
+  size_t shard = hashName (prefix) % m_shards.size ();
+  {
+    boost::mutex::scoped_lock lock (m_filtersMutex);
+    m_filters[prefix] = shard;
+  }
+  return m_shards[shard]->setInterestFilter (prefix, interestCallback, record);
+}
+
+int
+ShardedWrapper::setSharedInterestFilter (const Name &prefix, const Wrapper::InterestCallback &interestCallback, bool record/* = true*/)
+{
+  {
+    boost::mutex::scoped_lock lock (m_filtersMutex);
+    m_filters[prefix] = SHARED_FILTER;
+  }
+
+  int result = 0;
+  for (size_t shard = 0; shard < m_shards.size (); shard++)
+    {
+      if (m_shards[shard]->setInterestFilter (prefix, boost::bind (&ShardedWrapper::onSharedInterest, this, shard, prefix, interestCallback, _1),
+                                              record) != 0)
+        result = -1;
+    }
+  return result;
+}
+
+void
+ShardedWrapper::clearInterestFilter (const Name &prefix, bool record/* = true*/)
+{
+  size_t shard = hashName (prefix) % m_shards.size ();
+  {
+    boost::mutex::scoped_lock lock (m_filtersMutex);
+    std::map<Name, size_t>::iterator filter = m_filters.find (prefix);
+    if (filter != m_filters.end ())
+      {
+        shard = filter->second;
+        if (record)
+          m_filters.erase (filter);
+      }
+  }
+
+  if (shard != SHARED_FILTER)
+    {
+      m_shards[shard]->clearInterestFilter (prefix, record);
+      return;
+    }
+
+  BOOST_FOREACH (const Ptr<Wrapper> &wrapper, m_shards)
+    {
+      wrapper->clearInterestFilter (prefix, record);
+    }
+}
+
+void
+ShardedWrapper::onSharedInterest (size_t shard, const Name &prefix, const Wrapper::InterestCallback &interestCallback,
+                                  Ptr<Interest> interest)
+{
+  size_t owner = hashName (interest->getName ()) % m_shards.size ();
+  if (owner == shard)
+    {
+      interestCallback (interest);
+      return;
+    }
+
+  // the same filter in the owner shard calls the callback
+  m_shards[owner]->dispatchInterest (prefix, interest);
+}
+
+int
+ShardedWrapper::sendInterest (Ptr<Interest> interest, Ptr<Closure> closure)
+{
+  return getShard (interest->getName ())->sendInterest (interest, closure);
+}
+
+int
+ShardedWrapper::publishDataByCert (Ptr<Data> data, const Name &certificateName)
+{
+  return getDataShard (data->getName ())->publishDataByCert (data, certificateName);
+}
+
+int
+ShardedWrapper::publishDataByIdentity (Ptr<Data> data, const Name &identityName)
+{
+  return getDataShard (data->getName ())->publishDataByIdentity (data, identityName);
+}
+
+int
+ShardedWrapper::publishDataByCertAsync (Ptr<Data> data, const Name &certificateName, const Wrapper::PublishCallback &callback)
+{
+  return getDataShard (data->getName ())->publishDataByCertAsync (data, certificateName, callback);
+}
+
+int
+ShardedWrapper::publishDataByIdentityAsync (Ptr<Data> data, const Name &identityName, const Wrapper::PublishCallback &callback)
+{
+  return getDataShard (data->getName ())->publishDataByIdentityAsync (data, identityName, callback);
+}
+
+int
+ShardedWrapper::putToNdnd (const Blob &packet)
+{
+  // all shards are created by the same transport factory, so they share the wire format
+  Name name;
+  if (!m_shards.front ()->getWireFormat ()->parseName (reinterpret_cast<const unsigned char *> (packet.buf ()), packet.size (), name))
+    {
+      _LOG_ERROR ("Cannot send packet that is neither Interest nor Data");
+      return -1;
+    }
+
+  if (m_shards.front ()->getWireFormat ()->getPacketType (reinterpret_cast<const unsigned char *> (packet.buf ()), packet.size ()) ==
+      wire::Format::DATA_PACKET)
+    return getDataShard (name)->putToNdnd (packet);
+
+  return getShard (name)->putToNdnd (packet);
+}
+
+Ptr<Wrapper>
+ShardedWrapper::getDataShard (const Name &name)
+{
+  {
+    boost::mutex::scoped_lock lock (m_filtersMutex);
+    if (!m_filters.empty ())
+      {
+        for (int length = name.size (); length >= 0; length--)
+          {
+            std::map<Name, size_t>::const_iterator filter = m_filters.find (name.getPrefix (length));
+            if (filter != m_filters.end ())
+              {
+                if (filter->second != SHARED_FILTER)
+                  return m_shards[filter->second];
+                break;
+              }
+          }
+      }
+  }
+
+  return getShard (name);
+}
+
+size_t
+ShardedWrapper::hashName (const Name &name)
+{
+  size_t seed = 0;
+  BOOST_FOREACH (const name::Component &component, name)
+    {
+      boost::hash_combine (seed, boost::hash_range (component.begin (), component.end ()));
+    }
+  return seed;
+}
+
+} // ndn
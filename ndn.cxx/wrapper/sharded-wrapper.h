@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_SHARDED_WRAPPER_H
+#define NDN_SHARDED_WRAPPER_H
+
+#include "wrapper.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <map>
+#include <vector>
+
+namespace ndn {
+
+/**
+ * @brief Set of wrappers, each with its own connection to the forwarder, I/O thread, outbound
+ *        queue and callback threads, that spreads packet processing over several cores
+ *
+ * Interest filters are assigned to shards by the hash of the prefix, expressed interests by
+ * the hash of the name.  Data for an expressed interest comes back through the connection of
+ * the same shard, so pending interests are never shared between shards.  Published data is sent
+ * through the shard of the longest filter matching its name (through the shard of its name hash
+ * if no filter matches), i.e., through the connection the interests for it have come from.
+ * Filters with overlapping prefixes can end up in different shards, in which case interests
+ * are delivered to them the way the forwarder delivers interests to overlapping registrations.
+ *
+ * A prefix that receives more interests than one shard can handle can be registered in all
+ * shards (setSharedInterestFilter), and its interests are spread over the shards by name hash.
+ */
+class ShardedWrapper : boost::noncopyable
+{
+public:
+  /**
+   * @brief Factory of transports, called once for every shard
+   */
+  typedef boost::function<Ptr<Transport> ()> TransportFactory;
+
+  /**
+   * @brief Create wrappers and connect them to the forwarder
+   * @param shards number of wrappers (connections)
+   * @param keychain keychain shared by all shards
+   * @param transportFactory factory of transports. If not set, NdnxTransport (connection to ndnd) is used
+   * @param callbackThreads number of threads running callbacks in every shard
+   */
+  ShardedWrapper (int shards,
+                  Ptr<security::Keychain> keychain = Ptr<security::Keychain>::Create (),
+                  const TransportFactory &transportFactory = TransportFactory (),
+                  int callbackThreads = Wrapper::DEFAULT_CALLBACK_THREADS);
+
+  ~ShardedWrapper ();
+
+  void
+  shutdown ();
+
+  size_t
+  getShardCount () const;
+
+  Ptr<Wrapper>
+  getShard (size_t index) const;
+
+  /**
+   * @brief Get shard that handles the name (or the prefix)
+   */
+  Ptr<Wrapper>
+  getShard (const Name &name) const;
+
+  /**
+   * @brief Set limit on the size of encoded packets waiting to be sent, in every shard
+   */
+  void
+  setOutboundLimit (size_t maxQueuedBytes, const Wrapper::BackpressureCallback &backpressureCallback = Wrapper::BackpressureCallback ());
+
+  /**
+   * @brief Set number of threads signing asynchronously published data, in every shard
+   */
+  void
+  setSigningWorkers (int workers, size_t maxInFlight = Wrapper::DEFAULT_SIGNING_LIMIT);
+
+  int
+  setInterestFilter (const Name &prefix, const Wrapper::InterestCallback &interestCallback, bool record = true);
+
+  /**
+   * @brief Register prefix in all shards and spread its interests over the shards
+   *
+   * Interest received by any shard is handed to the shard of the hash of the interest name,
+   * which calls the callback in its callback threads, and data published for the prefix is
+   * sent through the shard of the hash of the data name.  The callback can thus run in several
+   * shards in parallel (one call at a time in every shard).
+   */
+  int
+  setSharedInterestFilter (const Name &prefix, const Wrapper::InterestCallback &interestCallback, bool record = true);
+
+  /**
+   * @brief Clear filter set by setInterestFilter or setSharedInterestFilter
+   */
+  void
+  clearInterestFilter (const Name &prefix, bool record = true);
+
+  int
+  sendInterest (Ptr<Interest> interest, Ptr<Closure> closure);
+
+  int
+  publishDataByCert (Ptr<Data> data, const Name &certificateName);
+
+  int
+  publishDataByIdentity (Ptr<Data> data, const Name &identityName);
+
+  int
+  publishDataByCertAsync (Ptr<Data> data, const Name &certificateName,
+                          const Wrapper::PublishCallback &callback = Wrapper::PublishCallback ());
+
+  int
+  publishDataByIdentityAsync (Ptr<Data> data, const Name &identityName = Name (),
+                              const Wrapper::PublishCallback &callback = Wrapper::PublishCallback ());
+
+  /**
+   * @brief Send encoded packet through the shard of its name
+   * @returns -1 if the packet is not an Interest or Data
+   */
+  int
+  putToNdnd (const Blob &packet);
+
+  /**
+   * @brief Hash of all components of the name
+   */
+  static size_t
+  hashName (const Name &name);
+
+private:
+  /**
+   * @brief Get shard that publishes the data (shard of the longest matching filter)
+   */
+  Ptr<Wrapper>
+  getDataShard (const Name &name);
+
+  /**
+   * @brief Callback of the shared filter in every shard, hands interest over to the shard of the name hash
+   */
+  void
+  onSharedInterest (size_t shard, const Name &prefix, const Wrapper::InterestCallback &interestCallback,
+                    Ptr<Interest> interest);
+
+private:
+  static const size_t SHARED_FILTER; ///< @brief shard index of the filters set in all shards
+
+  std::vector< Ptr<Wrapper> > m_shards;
+  boost::mutex m_filtersMutex;
+  std::map<Name, size_t> m_filters; // shard of every filter (SHARED_FILTER if set in all shards)
+};
+
+} // ndn
+
+#endif // NDN_SHARDED_WRAPPER_H
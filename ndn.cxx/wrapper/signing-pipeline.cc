@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "signing-pipeline.h"
+
+#include "executor/executor.h"
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+
+#include "logging.h"
+
+INIT_LOGGER ("ndn.SigningPipeline");
+
+using namespace std;
+
+namespace ndn {
+
+SigningPipeline::SigningPipeline (int workers, size_t maxInFlight, const EmitCallback &emit)
+  : m_workers (workers > 0 ? workers : 1)
+  , m_maxInFlight (maxInFlight > 0 ? maxInFlight : 1)
+  , m_emit (emit)
+  , m_running (true)
+  , m_executor (new Executor (m_workers))
+{
+  m_executor->start ();
+}
+
+SigningPipeline::~SigningPipeline ()
+{
+  shutdown ();
+}
+
+bool
+SigningPipeline::submit (Ptr<Data> data, const SignFunction &sign, const CompletionCallback &completion)
+{
+  Ptr<Job> job = Create<Job> ();
+  job->m_data = data;
+  job->m_sign = sign;
+  job->m_completion = completion;
+  job->m_done = false;
+
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    while (m_running && m_jobs.size () >= m_maxInFlight)
+      {
+        m_cond.wait (lock);
+      }
+
+    if (!m_running)
+      return false;
+
+    m_jobs.push_back (job);
+  }
+
+  m_executor->execute (boost::bind (&SigningPipeline::process, this, job));
+  return true;
+}
+
+void
+SigningPipeline::process (Ptr<Job> job)
+{
+  // signing and encoding run in parallel, only emission is serialized
+  Ptr<wire::IovecList> packet;
+  try
+    {
+      job->m_sign (*job->m_data);
+
+      packet = Create<wire::IovecList> ();
+      job->m_data->encodeToWire (*packet);
+      packet->keepAlive (job->m_data);
+    }
+  catch (std::exception &e)
+    {
+      _LOG_ERROR ("Signing of " << job->m_data->getName () << " failed: " << e.what ());
+      packet.reset ();
+    }
+  catch (...)
+    {
+      // worker thread should survive whatever the sign function throws
+      _LOG_ERROR ("Signing of " << job->m_data->getName () << " failed");
+      packet.reset ();
+    }
+
+  std::vector< std::pair<Ptr<Job>, bool> > completed;
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    job->m_packet = packet;
+    job->m_done = true;
+
+    // emit the longest prefix of the submission order that is done, whichever worker signed it
+    while (!m_jobs.empty () && m_jobs.front ()->m_done)
+      {
+        Ptr<Job> ready = m_jobs.front ();
+        m_jobs.pop_front ();
+
+        bool published = ready->m_packet && m_emit (ready->m_packet) == 0;
+        completed.push_back (std::make_pair (ready, published));
+      }
+
+    if (!completed.empty ())
+      m_cond.notify_all ();
+  }
+
+  for (size_t i = 0; i < completed.size (); i++)
+    {
+      Ptr<Job> ready = completed[i].first;
+      if (!ready->m_completion.empty ())
+        ready->m_completion (ready->m_data, completed[i].second);
+    }
+}
+
+void
+SigningPipeline::shutdown ()
+{
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    m_running = false;
+    m_cond.notify_all (); // release blocked submitters
+
+    while (!m_jobs.empty ())
+      {
+        m_cond.wait (lock);
+      }
+  }
+
+  m_executor->shutdown ();
+}
+
+size_t
+SigningPipeline::getInFlight ()
+{
+  boost::unique_lock<boost::mutex> lock (m_mutex);
+  return m_jobs.size ();
+}
+
+int
+SigningPipeline::getWorkers () const
+{
+  return m_workers;
+}
+
+} // ndn
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_SIGNING_PIPELINE_H
+#define NDN_SIGNING_PIPELINE_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/wire/iovec-list.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <deque>
+
+class Executor;
+
+namespace ndn {
+
+/**
+ * @brief Pool of worker threads that sign and encode Data packets in parallel, and emit the
+ *        encoded packets strictly in the order the packets have been submitted
+ *
+ * A packet signed by one worker waits until all packets submitted before it are signed (or
+ * failed), so the order of packets on the wire does not depend on the number of workers.
+ * The number of submitted, but not yet emitted, packets is bounded: submit () blocks while
+ * the limit is reached.
+ */
+class SigningPipeline : boost::noncopyable
+{
+public:
+  /**
+   * @brief Function that signs the data (called from worker threads, concurrently), throws on failure
+   */
+  typedef boost::function<void (Data &data)> SignFunction;
+
+  /**
+   * @brief Callback that takes encoded signed packet (called in submission order), returns 0 on success
+   */
+  typedef boost::function<int (Ptr<const wire::IovecList> packet)> EmitCallback;
+
+  /**
+   * @brief Callback called once the packet has been emitted (published is true) or signing or
+   *        emission failed (published is false)
+   *
+   * Called from worker threads, completions of different packets may run concurrently
+   */
+  typedef boost::function<void (Ptr<Data> data, bool published)> CompletionCallback;
+
+  /**
+   * @brief Create pipeline and start worker threads
+   * @param workers number of signing threads
+   * @param maxInFlight maximum number of submitted packets that are not yet emitted
+   * @param emit callback receiving encoded packets in submission order
+   */
+  SigningPipeline (int workers, size_t maxInFlight, const EmitCallback &emit);
+
+  ~SigningPipeline ();
+
+  /**
+   * @brief Submit data for signing, blocks while maxInFlight packets are in the pipeline
+   *
+   * The data should not be modified after the call
+   *
+   * @returns false if the pipeline has been shut down
+   */
+  bool
+  submit (Ptr<Data> data, const SignFunction &sign, const CompletionCallback &completion = CompletionCallback ());
+
+  /**
+   * @brief Stop accepting new packets, wait until all submitted packets are emitted, and stop workers
+   */
+  void
+  shutdown ();
+
+  /**
+   * @brief Get number of submitted packets that are not yet emitted
+   */
+  size_t
+  getInFlight ();
+
+  int
+  getWorkers () const;
+
+private:
+  struct Job
+  {
+    Ptr<Data> m_data;
+    SignFunction m_sign;
+    CompletionCallback m_completion;
+
+    bool m_done;
+    Ptr<wire::IovecList> m_packet; ///< @brief encoded packet, null if signing failed
+  };
+
+  void
+  process (Ptr<Job> job);
+
+private:
+  int m_workers;
+  size_t m_maxInFlight;
+  EmitCallback m_emit;
+
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond; // notified whenever packets leave the pipeline
+  std::deque< Ptr<Job> > m_jobs;    // in submission order
+  bool m_running;
+
+  Ptr<Executor> m_executor;
+};
+
+} // ndn
+
+#endif // NDN_SIGNING_PIPELINE_H
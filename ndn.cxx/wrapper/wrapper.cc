@@ -14,27 +14,26 @@
 
 #include "wrapper.h"
 
-
-#define ndn ndn_client
-extern "C" {
-#include <ndn/fetch.h>
-}
-#undef ndn
-
-#include <poll.h>
 #include <boost/throw_exception.hpp>
 #include <boost/random.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/algorithm/string.hpp>
-
-#include "charbuf.h"
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
 
 #include <sstream>
 
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "executor/executor.h"
+#include "executor/strand.h"
 
 #include "logging.h"
-#include "ndn.cxx/wire/ndnb.h"
+#include "ndn.cxx/transport/ndnx-transport.h"
+#include "ndn.cxx/wire/ndnb/ndnb-parser/common.h"
 
 INIT_LOGGER ("ndn.Wrapper");
 
@@ -46,13 +45,37 @@ using namespace boost;
 
 namespace ndn {
 
-  Wrapper::Wrapper(Ptr<security::Keychain> keychain)
-    : m_handle (0)
+  // same as default interest lifetime in ndnd
+  static const double DEFAULT_INTEREST_LIFETIME = 4.0;
+
+  const size_t Wrapper::DEFAULT_OUTBOUND_LIMIT = 16 * 1024 * 1024;
+  const size_t Wrapper::DEFAULT_SIGNING_LIMIT = 1024;
+  const int Wrapper::DEFAULT_CALLBACK_THREADS = 1;
+
+  Wrapper::Wrapper(Ptr<security::Keychain> keychain, Ptr<Transport> transport, int callbackThreads)
+    : m_transport (transport)
     , m_running (true)
     , m_connected (false)
-    , m_executor (new Executor(1))
+    , m_outboundBytes (0)
+    , m_outboundLimit (DEFAULT_OUTBOUND_LIMIT)
+    , m_outboundBatchBytes (0)
+    , m_nonceGenerator (static_cast<uint32_t> (std::time (0)) ^ reinterpret_cast<size_t> (this))
+    , m_executor (new Executor(callbackThreads > 0 ? callbackThreads : 1))
     , m_keychain (keychain)
   {
+    if (m_transport == 0)
+      {
+        m_transport = Ptr<Transport> (new NdnxTransport ());
+      }
+    m_format = m_transport->getWireFormat ();
+
+    if (pipe (m_wakeupPipe) < 0)
+      {
+        BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("cannot create wakeup pipe"));
+      }
+    fcntl (m_wakeupPipe[0], F_SETFL, fcntl (m_wakeupPipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl (m_wakeupPipe[1], F_SETFL, fcntl (m_wakeupPipe[1], F_GETFL) | O_NONBLOCK);
+
     m_keychain->setWrapper(this);
     start ();
   }
@@ -60,35 +83,22 @@ namespace ndn {
   void
   Wrapper::connectNdnd()
   {
-    if (m_handle != 0) {
-      ndn_disconnect (m_handle);
-      //ndn_destroy (&m_handle);
-    }
-    else
-      {
-        m_handle = ndn_create ();
-      }
-
     UniqueRecLock lock(m_mutex);
-    if (ndn_connect(m_handle, NULL) < 0)
-      {
-        BOOST_THROW_EXCEPTION (Error::ndnOperation() << errmsg_info_str("connection to ndnd failed"));
-      }
+    m_transport->connect (bind (&Wrapper::onReceive, this, _1, _2));
     m_connected = true;
     
-    if (!m_registeredInterests.empty())
+    // filters under covering prefixes are not registered individually
+    BOOST_FOREACH (const Name &prefix, m_registeredPrefixes)
       {
-        for (map<Name, InterestCallback>::const_iterator it = m_registeredInterests.begin(); it != m_registeredInterests.end(); ++it)
-          {
-            clearInterestFilter(it->first, false);
-            setInterestFilter(it->first, it->second, false);
-          }
+        m_transport->registerPrefix (prefix);
       }
   }
   
   Wrapper::~Wrapper()
   {
     shutdown ();
+    close (m_wakeupPipe[0]);
+    close (m_wakeupPipe[1]);
     // if (m_verifier != 0)
     // {
     //   delete m_verifier;
@@ -107,11 +117,25 @@ namespace ndn {
   void
   Wrapper::shutdown () // called in destructor, but can called manually
   {
+    Ptr<SigningPipeline> signingPipeline;
+    {
+      UniqueRecLock lock(m_mutex);
+      signingPipeline.swap (m_signingPipeline);
+    }
+    if (signingPipeline)
+      {
+        // data that is already being signed is still queued for sending
+        signingPipeline->shutdown ();
+      }
+
     m_executor->shutdown();
 
     {
       UniqueRecLock lock(m_mutex);
       m_running = false;
+      m_pendingInterests.clear ();
+      m_expirations.clear ();
+      wakeup ();
     }
 
     _LOG_DEBUG ("+++++++++SHUTDOWN+++++++");
@@ -119,10 +143,52 @@ namespace ndn {
       {
         m_thread.join ();
 
-        ndn_disconnect (m_handle);
-      //ndn_destroy (&m_handle);
+        m_transport->disconnect ();
         m_connected = false;
       }
+
+    // requests that have not been picked up by the I/O thread are dropped
+    std::vector<OutboundRequest> dropped;
+    m_outbound.popAll (dropped);
+    m_outboundBytes = 0;
+  }
+
+  void
+  Wrapper::setOutboundLimit (size_t maxQueuedBytes, const BackpressureCallback &backpressureCallback)
+  {
+    m_outboundLimit = maxQueuedBytes;
+    m_backpressureCallback = backpressureCallback;
+  }
+
+  void
+  Wrapper::setSigningWorkers (int workers, size_t maxInFlight)
+  {
+    Ptr<SigningPipeline> pipeline = make_shared<SigningPipeline> (workers, maxInFlight,
+                                                                  bind (static_cast<int (Wrapper::*) (Ptr<const wire::IovecList>)> (&Wrapper::putToNdnd), this, _1));
+    {
+      UniqueRecLock lock(m_mutex);
+      pipeline.swap (m_signingPipeline);
+    }
+    if (pipeline)
+      {
+        pipeline->shutdown (); // old pool, lock is not held while it drains
+      }
+  }
+
+  Ptr<SigningPipeline>
+  Wrapper::getSigningPipeline ()
+  {
+    UniqueRecLock lock(m_mutex);
+    if (!m_running)
+      return Ptr<SigningPipeline> ();
+
+    if (!m_signingPipeline)
+      {
+        int workers = std::max<int> (boost::thread::hardware_concurrency (), 1);
+        m_signingPipeline = make_shared<SigningPipeline> (workers, DEFAULT_SIGNING_LIMIT,
+                                                          bind (static_cast<int (Wrapper::*) (Ptr<const wire::IovecList>)> (&Wrapper::putToNdnd), this, _1));
+      }
+    return m_signingPipeline;
   }
 
   void
@@ -135,37 +201,47 @@ namespace ndn {
       {
         try
           {
-            int res = 0;
+            pollfd fds[2];
+            int timeout;
             {
               UniqueRecLock lock(m_mutex);
-              res = ndn_run (m_handle, 0);
+              fds[0].fd = m_transport->getFd ();
+              fds[0].events = POLLIN;
+              timeout = getPollTimeout ();
+              if (m_transport->isOutputPending ())
+                fds[0].events |= POLLOUT;
+              else if (!m_outbound.empty ())
+                timeout = 0; // requests were queued while the previous batch was being written out
             }
+            fds[1].fd = m_wakeupPipe[0];
+            fds[1].events = POLLIN;
 
-            if (!m_running) break;
-            
-            if (res < 0) {
-              _LOG_ERROR ("ndn_run returned negative status: " << res);
-              
-              BOOST_THROW_EXCEPTION (Error::ndnOperation()
-                                     << errmsg_info_str("ndn_run returned error"));
-            }
+            // wait without holding the lock, sendInterest/putToNdnd will interrupt the wait
+            if (poll (fds, 2, timeout) < 0 && errno != EINTR)
+              {
+                BOOST_THROW_EXCEPTION (Error::ndnOperation () << errmsg_info_str ("poll failed"));
+              }
 
+            if (fds[1].revents & POLLIN)
+              {
+                char buf[64];
+                while (read (m_wakeupPipe[0], buf, sizeof (buf)) > 0)
+                  ;
+              }
 
-            pollfd pfds[1];
             {
               UniqueRecLock lock(m_mutex);
+              if (!m_running)
+                break;
 
-              pfds[0].fd = ndn_get_connection_fd (m_handle);
-              pfds[0].events = POLLIN;
-              if (ndn_output_is_pending (m_handle))
-                pfds[0].events |= POLLOUT;
-            }
+              // new batch is taken only when the previous one has been written out, so a slow
+              // forwarder makes the outbound queue fill up and triggers the backpressure
+              if (!m_transport->isOutputPending ())
+                processOutbound ();
 
-            int ret = poll (pfds, 1, 1);
-            if (ret < 0)
-              {
-                BOOST_THROW_EXCEPTION (Error::ndnOperation() << errmsg_info_str("ndnd socket failed (probably ndnd got stopped)"));
-              }
+              m_transport->processEvents ();
+              expirePendingInterests ();
+            }
           }
         catch (Error::ndnOperation &e)
           {
@@ -212,41 +288,303 @@ namespace ndn {
   Wrapper::putToNdnd (const Blob & dataBlob)
   {
     _LOG_TRACE (">> putToNdnd");
-    UniqueRecLock lock(m_mutex);
-    if (!m_running || !m_connected)
+
+    OutboundRequest request;
+    request.m_type = OutboundRequest::PACKET;
+    request.m_wire = make_shared<Blob> (dataBlob);
+
+    return submit (request, dataBlob.size ());
+  }
+
+  int
+  Wrapper::putToNdnd (Ptr<const wire::IovecList> packet)
+  {
+    OutboundRequest request;
+    request.m_type = OutboundRequest::PACKET_LIST;
+    request.m_packet = packet;
+
+    return submit (request, packet->size ());
+  }
+
+  int
+  Wrapper::submit (const OutboundRequest &request, size_t size)
+  {
+    if (!m_running)
       {
-        _LOG_TRACE ("<< not running or connected");
+        _LOG_TRACE ("<< not running");
         return -1;
       }
 
+    size_t queued = __sync_add_and_fetch (&m_outboundBytes, size);
+    if (queued > m_outboundLimit)
+      {
+        __sync_fetch_and_sub (&m_outboundBytes, size);
+        _LOG_DEBUG ("Outbound queue is full (" << queued - size << " bytes), request rejected");
+        if (!m_backpressureCallback.empty ())
+          m_backpressureCallback (queued - size);
+        return -1;
+      }
 
-    if (ndn_put(m_handle, dataBlob.buf(), dataBlob.size()) < 0)
+    if (m_outbound.push (request))
       {
-        _LOG_ERROR ("ndn_put failed");
-        // BOOST_THROW_EXCEPTION(Error::ndnOperation() << errmsg_info_str("ndnput failed"));
+        // I/O thread takes all requests at once, it needs to be woken up only for the first one
+        wakeup ();
       }
-    else
+    return 0;
+  }
+
+  void
+  Wrapper::processOutbound ()
+  {
+    m_outboundBatchBytes = 0;
+    size_t count = m_outbound.consumeAll (boost::bind (&Wrapper::processRequest, this, _1));
+    if (count == 0)
+      return;
+
+    _LOG_TRACE ("Sent batch of " << count << " requests (" << m_outboundBatchBytes << " bytes)");
+  }
+
+  void
+  Wrapper::releaseOutbound (size_t size)
+  {
+    // released before the request is processed, so a request that fails to be sent does not
+    // stay counted in the queue
+    m_outboundBatchBytes += size;
+    __sync_fetch_and_sub (&m_outboundBytes, size);
+  }
+
+  void
+  Wrapper::processRequest (const OutboundRequest &request)
+  {
+    switch (request.m_type)
+      {
+      case OutboundRequest::PACKET:
+        releaseOutbound (request.m_wire->size ());
+        m_transport->send (reinterpret_cast<const unsigned char *> (request.m_wire->buf ()), request.m_wire->size ());
+        break;
+
+      case OutboundRequest::PACKET_LIST:
+        releaseOutbound (request.m_packet->size ());
+        m_transport->send (request.m_packet);
+        break;
+
+      case OutboundRequest::INTEREST:
+        releaseOutbound (request.m_pending->m_wire.size ());
+        expressInterest (request.m_pending, request.m_expireAt);
+        break;
+
+      case OutboundRequest::SET_FILTER:
+        if (!isCovered (request.m_prefix))
+          {
+            m_transport->registerPrefix (request.m_prefix);
+            m_registeredPrefixes.insert (request.m_prefix);
+          }
+        // incoming interests are dispatched using the recorded callbacks
+        {
+          Ptr< list<InterestFilter> > filters = m_registeredInterests.try_insert (request.m_prefix).first->payload ();
+          if (filters->empty ())
+            {
+              filters->push_back (InterestFilter ());
+              filters->back ().m_prefix = request.m_prefix;
+              filters->back ().m_strand = Ptr<Strand> (new Strand ());
+            }
+          filters->front ().m_callback = request.m_callback;
+        }
+        break;
+
+      case OutboundRequest::CLEAR_FILTER:
+        if (m_registeredPrefixes.count (request.m_prefix) > 0 && m_coveringPrefixes.count (request.m_prefix) == 0)
+          {
+            m_transport->unregisterPrefix (request.m_prefix);
+            if (request.m_record)
+              m_registeredPrefixes.erase (request.m_prefix);
+          }
+        if (request.m_record)
+          {
+            m_registeredInterests.erase (request.m_prefix);
+          }
+        break;
+
+      case OutboundRequest::SET_COVER:
+        setCover (request.m_prefix);
+        break;
+
+      case OutboundRequest::CLEAR_COVER:
+        clearCover (request.m_prefix);
+        break;
+
+      case OutboundRequest::DISPATCH:
+        {
+          CallbackTable<InterestFilter>::iterator entry = m_registeredInterests.find_exact (request.m_prefix);
+          if (entry == m_registeredInterests.end () || entry->payload ()->empty ())
+            {
+              _LOG_DEBUG ("No interest filter for " << request.m_prefix << ", dispatched interest is dropped");
+              break;
+            }
+
+          const InterestFilter &filter = entry->payload ()->front ();
+          filter.m_strand->execute (m_executor, bind (filter.m_callback, request.m_interest));
+        }
+        break;
+      }
+  }
+
+  bool
+  Wrapper::isCovered (const Name &prefix) const
+  {
+    BOOST_FOREACH (const Name &covering, m_coveringPrefixes)
       {
-        _LOG_DEBUG ("<< putToNdnd");
+        if (covering.size () <= prefix.size () && prefix.getPrefix (covering.size ()) == covering)
+          return true;
       }
+    return false;
+  }
 
-    return 0;
+  void
+  Wrapper::setCover (const Name &prefix)
+  {
+    if (!m_coveringPrefixes.insert (prefix).second)
+      return;
+
+    if (m_registeredPrefixes.insert (prefix).second)
+      m_transport->registerPrefix (prefix);
+
+    // filters that have been registered individually are now reached through the covering prefix
+    for (set<Name>::iterator registered = m_registeredPrefixes.begin (); registered != m_registeredPrefixes.end (); )
+      {
+        if (*registered != prefix && m_coveringPrefixes.count (*registered) == 0 && isCovered (*registered))
+          {
+            m_transport->unregisterPrefix (*registered);
+            m_registeredPrefixes.erase (registered++);
+          }
+        else
+          registered++;
+      }
+  }
+
+  namespace
+  {
+    struct CollectFilterPrefixes
+    {
+      std::list<Name> *m_prefixes;
+
+      bool
+      operator () (const Ptr< list<Wrapper::InterestFilter> > &filters) const
+      {
+        m_prefixes->push_back (filters->front ().m_prefix);
+        return false; // visit the whole sub-trie
+      }
+    };
+  }
+
+  void
+  Wrapper::clearCover (const Name &prefix)
+  {
+    if (m_coveringPrefixes.erase (prefix) == 0)
+      return;
+
+    // filters under the prefix that are not under another covering prefix are registered individually
+    std::list<Name> filterPrefixes;
+    bool reachLast;
+    CallbackTable<InterestFilter>::iterator node;
+    boost::tie (boost::tuples::ignore, reachLast, node) = m_registeredInterests.getTrie ().find (prefix);
+    if (reachLast)
+      {
+        CollectFilterPrefixes collect = { &filterPrefixes };
+        node->find_if (collect);
+      }
+
+    bool keepPrefix = isCovered (prefix);
+    BOOST_FOREACH (const Name &filterPrefix, filterPrefixes)
+      {
+        if (isCovered (filterPrefix))
+          continue;
+
+        if (filterPrefix == prefix)
+          keepPrefix = true; // there is a filter for the prefix itself
+        else if (m_registeredPrefixes.insert (filterPrefix).second)
+          m_transport->registerPrefix (filterPrefix);
+      }
+
+    if (!keepPrefix)
+      {
+        m_transport->unregisterPrefix (prefix);
+        m_registeredPrefixes.erase (prefix);
+      }
   }
 
   int 
-  Wrapper::publishDataByCert (Data &data, const Name & certificateName)
+  Wrapper::publishDataByCert (Ptr<Data> data, const Name & certificateName)
   {
-    _LOG_TRACE("publishDataByCert: " << data.getName ());
-    m_keychain->sign(data, certificateName);
-    return putToNdnd(*data.encodeToWire());
+    _LOG_TRACE("publishDataByCert: " << data->getName ());
+    data->setWireFormat (m_format);
+    m_keychain->sign(*data, certificateName);
+    return putToNdnd(encodeData (data));
   }
 
   int 
-  Wrapper::publishDataByIdentity (Data &data, const Name &identityName)
+  Wrapper::publishDataByIdentity (Ptr<Data> data, const Name &identityName)
+  {
+    _LOG_TRACE("publishDataByIdentity: " << data->getName ());
+    data->setWireFormat (m_format);
+    m_keychain->signByIdentity(*data, identityName);
+    return putToNdnd(encodeData (data));
+  }
+
+  Ptr<const wire::Format>
+  Wrapper::getWireFormat () const
+  {
+    return m_format;
+  }
+
+  Ptr<wire::IovecList>
+  Wrapper::encodeData (Ptr<const Data> data)
+  {
+    // payload and signature bits are referenced by the encoding, data is kept until it is sent
+    Ptr<wire::IovecList> packet = make_shared<wire::IovecList> ();
+    data->encodeToWire (*packet);
+    packet->keepAlive (data);
+    return packet;
+  }
+
+  static void
+  signByCertificate (Ptr<security::Keychain> keychain, const Name &certificateName, Data &data)
+  {
+    keychain->sign (data, certificateName);
+  }
+
+  static void
+  signByIdentity (Ptr<security::Keychain> keychain, const Name &identityName, Data &data)
+  {
+    keychain->signByIdentity (data, identityName);
+  }
+
+  int
+  Wrapper::publishDataByCertAsync (Ptr<Data> data, const Name &certificateName, const PublishCallback &callback)
   {
-    _LOG_TRACE("publishDataByCert: " << data.getName ());
-    m_keychain->signByIdentity(data, identityName);
-    return putToNdnd(*data.encodeToWire());
+    _LOG_TRACE("publishDataByCertAsync: " << data->getName ());
+
+    data->setWireFormat (m_format);
+
+    // pipeline is used without the lock, as submit blocks while the signing limit is reached
+    Ptr<SigningPipeline> pipeline = getSigningPipeline ();
+    if (!pipeline || !pipeline->submit (data, bind (signByCertificate, m_keychain, certificateName, _1), callback))
+      return -1;
+
+    return 0;
+  }
+
+  int
+  Wrapper::publishDataByIdentityAsync (Ptr<Data> data, const Name &identityName, const PublishCallback &callback)
+  {
+    _LOG_TRACE("publishDataByIdentityAsync: " << data->getName ());
+    data->setWireFormat (m_format);
+
+    Ptr<SigningPipeline> pipeline = getSigningPipeline ();
+    if (!pipeline || !pipeline->submit (data, bind (signByIdentity, m_keychain, identityName, _1), callback))
+      return -1;
+
+    return 0;
   }
 
   int
@@ -254,11 +592,11 @@ namespace ndn {
   {
     _LOG_TRACE ("publishData: " << name);
 
-    Data data;
-    data.setName(name);
+    Ptr<Data> data = make_shared<Data> ();
+    data->setName(name);
     //TODO: Freshness processing
-    Content content(buf, len, Content::DATA);
-    data.setContent(content);
+    data->setContent(Content(0, 0, Content::DATA));
+    data->getContent().setContent(buf, len); // the only copy of the payload
 
     return publishDataByCert(data, certificateName);
   }
@@ -268,252 +606,410 @@ namespace ndn {
   {
     _LOG_TRACE ("publishData: " << name);
 
-    Data data;
-    data.setName(name);
+    Ptr<Data> data = make_shared<Data> ();
+    data->setName(name);
     //TODO: Freshness processing
-    Content content(buf, len, Content::DATA);
-    data.setContent(content);
+    data->setContent(Content(0, 0, Content::DATA));
+    data->getContent().setContent(buf, len); // the only copy of the payload
 
     return publishDataByIdentity(data, identityName);
   }
 
+  /**
+   * @brief Run callback of the closure after its previous callbacks (closures without strand are not ordered)
+   */
   static void
-  deleteInInterestTuple (tuple<Wrapper::InterestCallback *, Ptr<Executor> > * tuple)
+  executeInStrand (Ptr<Executor> executor, const Ptr<Closure> &closure, const Executor::Job &job)
   {
-    delete tuple->get<0> ();
-    delete tuple;
+    if (closure->m_strand)
+      closure->m_strand->execute (executor, job);
+    else
+      executor->execute (job);
   }
 
-  static ndn_upcall_res
-  incomingInterest(ndn_closure *selfp,
-                   ndn_upcall_kind kind,
-                   ndn_upcall_info *info)
+  static void
+  onVerify(Ptr<list< Ptr<Closure> > > closures, Ptr<Data> data, Ptr<Executor> executor)
   {
-    Wrapper::InterestCallback *f;
-    Ptr<Executor> executor;
-    tuple<Wrapper::InterestCallback *, Ptr<Executor> > *realData = reinterpret_cast< tuple<Wrapper::InterestCallback *, Ptr<Executor> > * > (selfp->data);
-    tie (f, executor) = *realData;
-
-    switch (kind)
+    BOOST_FOREACH (const Ptr<Closure> &closure, *closures)
       {
-      case NDN_UPCALL_FINAL: // effective in unit tests
-        // delete closure;
-        executor->execute (bind (deleteInInterestTuple, realData));
-
-        delete selfp;
-        _LOG_TRACE ("<< incomingInterest with NDN_UPCALL_FINAL");
-        return NDN_UPCALL_RESULT_OK;
-
-      case NDN_UPCALL_INTEREST:
-        _LOG_TRACE (">> incomingInterest upcall: " << Name(info->interest_ndnb, info->interest_comps));
-        break;
-
-      default:
-        _LOG_TRACE ("<< incomingInterest with NDN_UPCALL_RESULT_OK: " << Name(info->interest_ndnb, info->interest_comps));
-        return NDN_UPCALL_RESULT_OK;
+        executeInStrand (executor, closure, bind (closure->m_dataCallback, data));
       }
-
-    Ptr<Interest> interest = Ptr<Interest>( new Interest(info->pi));
-    interest->setName (Name (info->interest_ndnb, info->interest_comps));
-
-    executor->execute (bind (*f, interest));
-    // this will be run in executor
-    // (*f) (interest);
-    // closure->runInterestCallback(interest);
-
-    return NDN_UPCALL_RESULT_OK;
   }
 
   static void
-  deleteInDataTuple (tuple<Ptr<Closure>, Ptr<Executor>, Ptr<Interest>, Ptr<security::Keychain> > *tuple)
+  onVerifyError(Ptr<list< Ptr<Closure> > > closures, Ptr<Data> data, Ptr<Executor> executor)
   {
-    // delete tuple->get<0> ();
-    delete tuple;
+    BOOST_FOREACH (const Ptr<Closure> &closure, *closures)
+      {
+        executeInStrand (executor, closure, bind (closure->m_unverifiedCallback, data));
+      }
   }
 
-  static void
-  onVerify(const DataCallback & dataCallback, Ptr<Data> data, Ptr<Executor> executor)
+  void
+  Wrapper::onReceive (const unsigned char *buf, size_t length)
   {
-    executor->execute (bind (dataCallback, data));
+    wire::Format::PacketType type = m_format->getPacketType (buf, length);
+    if (type == wire::Format::UNKNOWN_PACKET)
+      {
+        _LOG_DEBUG ("Received packet is neither Interest nor Data, ignoring");
+        return;
+      }
+
+    // only the name is extracted from the receive buffer, packets nobody is waiting for are never decoded
+    Name name;
+    if (!m_format->parseName (buf, length, name))
+      {
+        _LOG_ERROR ("Cannot parse name of received packet, ignoring");
+        return;
+      }
+
+    try
+      {
+        if (type == wire::Format::INTEREST_PACKET)
+          onInterest (name, buf, length);
+        else
+          onData (name, buf, length);
+      }
+    catch (boost::exception &e)
+      {
+        _LOG_ERROR ("Cannot decode received packet: " << diagnostic_information (e));
+      }
+    catch (wire::NdnbParser::NdnbDecodingException &e)
+      {
+        _LOG_ERROR ("Cannot decode received packet " << name << ", ignoring");
+      }
   }
 
-  static void
-  onVerifyError(const UnverifiedCallback & unverifiedCallback, Ptr<Data> data, Ptr<Executor> executor)
+  void
+  Wrapper::onInterest (const Name &name, const unsigned char *buf, size_t length)
   {
-    executor->execute (bind (unverifiedCallback, data));
+    _LOG_TRACE (">> incomingInterest: " << name);
+
+    // every registered prefix gets the interest, longest first (the same way ndnd delivers interests to overlapping filters)
+    Ptr<Interest> interest;
+    CallbackTable<InterestFilter>::iterator entry = m_registeredInterests.longest_prefix_match (name);
+    while (entry != m_registeredInterests.end ())
+      {
+        const InterestFilter &filter = entry->payload ()->front ();
+
+        Ptr<Interest> delivered;
+        if (!interest)
+          {
+            delivered = interest = Ptr<Interest>::Create ();
+            m_format->decodeInterest (*interest, buf, length);
+          }
+        else
+          delivered = Ptr<Interest> (new Interest (*interest));
+
+        filter.m_strand->execute (m_executor, bind (filter.m_callback, delivered));
+
+        if (filter.m_prefix.size () == 0)
+          break;
+        entry = m_registeredInterests.longest_prefix_match (filter.m_prefix.getPrefix (filter.m_prefix.size () - 1));
+      }
+
+    if (!interest)
+      {
+        _LOG_DEBUG ("No interest filters for " << name);
+      }
   }
 
-  static ndn_upcall_res
-  incomingData(ndn_closure *selfp,
-               ndn_upcall_kind kind,
-               ndn_upcall_info *info)
+  void
+  Wrapper::onData (const Name &name, const unsigned char *buf, size_t length)
   {
-    // Closure *cp = static_cast<Closure *> (selfp->data);
-    Ptr<Closure> cp;
-    Ptr<Executor> executor;
-    Ptr<Interest> interest;
-    Ptr<security::Keychain> keychain;
-    tuple<Ptr<Closure>, 
-          Ptr<Executor>, 
-          Ptr<Interest>, 
-          Ptr<security::Keychain> > *realData = reinterpret_cast< tuple<Ptr<Closure>, 
-                                                                        Ptr<Executor>,
-                                                                        Ptr<Interest>, 
-                                                                        Ptr<security::Keychain> > * > (selfp->data);
-  tie (cp, executor, interest, keychain) = *realData;
-
-    switch (kind)
-      {
-      case NDN_UPCALL_FINAL:  // effecitve in unit tests
-        executor->execute (bind (deleteInDataTuple, realData));
-
-        cp = NULL;
-        delete selfp;
-        _LOG_TRACE ("<< incomingData with NDN_UPCALL_FINAL");
-        return NDN_UPCALL_RESULT_OK;
-
-      case NDN_UPCALL_CONTENT:
-        _LOG_TRACE (">> incomingData content upcall: " << Name (info->content_ndnb, info->content_comps));
-        break;
+    _LOG_TRACE (">> incomingData: " << name);
 
-        // this is the case where the intentionally unsigned packets coming (in Encapsulation case)
-      case NDN_UPCALL_CONTENT_BAD:
-        _LOG_TRACE (">> incomingData content bad upcall: " << Name (info->content_ndnb, info->content_comps));
-        break;
+    CallbackTable< Ptr<PendingInterest> >::iterator entry = m_pendingInterests.longest_prefix_match (name);
+    if (entry == m_pendingInterests.end ())
+      {
+        _LOG_DEBUG ("No pending interests for " << name);
+        return;
+      }
 
-        // always ask ndnd to try to fetch the key
-      case NDN_UPCALL_CONTENT_UNVERIFIED:
-        _LOG_TRACE (">> incomingData content unverified upcall: " << Name (info->content_ndnb, info->content_comps));
-        break;
+    // decoded before pending interests are removed, they expire normally if data is malformed
+    Ptr<Data> data = Data::decodeFromWire (buf, length, m_format);
+
+    // data satisfies all pending interests which names are prefixes of the data name and which
+    // selectors accept the data, others stay pending
+    Ptr<list< Ptr<Closure> > > closures = Ptr<list< Ptr<Closure> > >::Create ();
+    int stepCount = 0;
+
+    while (entry != m_pendingInterests.end ())
+      {
+        list< Ptr<PendingInterest> > &pendingList = *entry->payload ();
+        Name prefix = pendingList.front ()->m_interest->getName ();
+
+        for (list< Ptr<PendingInterest> >::iterator pending = pendingList.begin (); pending != pendingList.end (); )
+          {
+            if (!(*pending)->m_interest->matchesData (*data))
+              {
+                pending ++;
+                continue;
+              }
+
+            m_expirations.erase ((*pending)->m_expiration);
+            BOOST_FOREACH (const Ptr<Closure> &closure, (*pending)->m_closures)
+              {
+                stepCount = std::max (stepCount, closure->m_stepCount);
+              }
+            closures->splice (closures->end (), (*pending)->m_closures);
+            pending = pendingList.erase (pending);
+          }
+        if (pendingList.empty ())
+          m_pendingInterests.erase (entry);
+
+        if (prefix.size () == 0)
+          break;
+        entry = m_pendingInterests.longest_prefix_match (prefix.getPrefix (prefix.size () - 1));
+      }
+
+    if (closures->empty ())
+      {
+        _LOG_DEBUG ("No pending interests match " << name);
+        return;
+      }
 
-      case NDN_UPCALL_INTEREST_TIMED_OUT: {
-        if (cp != NULL)
+    // data is decoded and verified only once for all aggregated closures
+    m_keychain->verifyData(data,
+                           boost::bind(onVerify, closures, _1, m_executor),
+                           boost::bind(onVerifyError, closures, _1, m_executor),
+                           stepCount);
+  }
+
+  void
+  Wrapper::expirePendingInterests ()
+  {
+    Time now = time::Now ();
+    while (!m_expirations.empty () && m_expirations.begin ()->first <= now)
+      {
+        Ptr<PendingInterest> pending = m_expirations.begin ()->second;
+        if (pending->m_lastExpireAt > now)
           {
-            Name interestName (info->interest_ndnb, info->interest_comps);
-            _LOG_TRACE ("<< incomingData timeout: " << Name (info->interest_ndnb, info->interest_comps));
-            executor->execute (bind (cp->m_timeoutCallback, cp, interest));
+            // some closures were aggregated later and still wait, the interest is expressed again for them
+            m_expirations.erase (pending->m_expiration);
+            pending->m_expiration = m_expirations.insert (make_pair (pending->m_lastExpireAt, pending));
+            transmitInterest (*pending);
+            continue;
           }
-        else
+
+        clearPendingInterest (pending);
+
+        _LOG_TRACE ("<< timeout: " << pending->m_interest->getName ()
+                    << " (" << pending->m_closures.size () << " closures)");
+        BOOST_FOREACH (const Ptr<Closure> &closure, pending->m_closures)
           {
-            _LOG_TRACE ("<< incomingData timeout, but callback is not set...: " << Name (info->interest_ndnb, info->interest_comps));
+            if (!closure->m_timeoutCallback.empty ())
+              executeInStrand (m_executor, closure, bind (closure->m_timeoutCallback, closure, pending->m_interest));
           }
-        return NDN_UPCALL_RESULT_OK;
       }
-      default:
-        _LOG_TRACE(">> unknown upcall type");
-        return NDN_UPCALL_RESULT_OK;
+  }
+
+  void
+  Wrapper::clearPendingInterest (Ptr<PendingInterest> pending)
+  {
+    UniqueRecLock lock(m_mutex);
+
+    m_expirations.erase (pending->m_expiration);
+    pending->m_expiration = m_expirations.end ();
+
+    CallbackTable< Ptr<PendingInterest> >::iterator entry = m_pendingInterests.find_exact (pending->m_interest->getName ());
+    if (entry == m_pendingInterests.end ())
+      return;
+
+    entry->payload ()->remove (pending);
+    if (entry->payload ()->empty ())
+      {
+        m_pendingInterests.erase (entry);
+      }
+  }
+
+  void
+  Wrapper::wakeup ()
+  {
+    char c = 0;
+    if (write (m_wakeupPipe[1], &c, 1) < 0 && errno != EAGAIN)
+      {
+        _LOG_ERROR ("Cannot wake up I/O thread");
       }
+  }
 
-    Ptr<Blob> blob = Ptr<Blob> (new Blob(info->content_ndnb, info->pco->offset[NDN_PCO_E]));
-    Ptr<Data> data = Data::decodeFromWire(blob);
+  int
+  Wrapper::getPollTimeout () const
+  {
+    if (m_expirations.empty ())
+      return -1;
 
+    Time now = time::Now ();
+    if (m_expirations.begin ()->first <= now)
+      return 0;
 
-    keychain->verifyData(data, 
-                           boost::bind(onVerify, cp->m_dataCallback, _1, executor),
-                           boost::bind(onVerifyError, cp->m_unverifiedCallback, _1, executor),
-                           cp->m_stepCount);
- 
-   _LOG_TRACE (">> incomingData");
-    
-    return NDN_UPCALL_RESULT_OK;
+    // round up, so the loop does not wake up just before the expiration
+    return (m_expirations.begin ()->first - now).total_milliseconds () + 1;
   }
 
   int Wrapper::sendInterest (Ptr<Interest> interestPtr, Ptr<Closure> closurePtr)
   {
     _LOG_TRACE (">> sendInterest: " << interestPtr->getName ());
-    {
-      UniqueRecLock lock(m_mutex);
-      if (!m_running || !m_connected)
-        {
-          _LOG_ERROR ("<< sendInterest: not running or connected");
-          return -1;
-        }
-    }
-    
-    ndn_closure *dataClosure = new ndn_closure;
-    
-    // Closure *myClosure = new ExecutorClosure(closure, m_executor);
-    Ptr<Closure> myClosure = Ptr<Closure>(new Closure(*closurePtr));
-    dataClosure->data = new tuple<Ptr<Closure>, Ptr<Executor>, Ptr<Interest>, Ptr<security::Keychain> > (myClosure, m_executor, interestPtr, m_keychain);
-    
-    dataClosure->p = &incomingData;
-    
-    UniqueRecLock lock(m_mutex);
 
-    charbuf_stream nameStream;
-    wire::Ndnb::appendName (nameStream, interestPtr->getName ());
-  
-    charbuf_stream interestStream;
-    wire::Ndnb::appendInterest (interestStream, *interestPtr);
+    // interest is encoded in the calling thread, the I/O thread only matches and sends it
+    Ptr<PendingInterest> pending = Ptr<PendingInterest>::Create ();
+    pending->m_interest = interestPtr;
+    // nonce is set when the interest is actually sent, so identical interests are still matched
+    pending->m_nonceOffset = m_format->encodeInterest (*interestPtr, 0, pending->m_wire);
 
-    if (ndn_express_interest (m_handle, nameStream.buf ().getBuf (),
-                              dataClosure,
-                              interestStream.buf ().getBuf ()
-                              ) < 0)
-      {
-        _LOG_ERROR ("<< sendInterest: ndn_express_interest FAILED!!!");
-      }
+    return submitInterest (pending, closurePtr);
+  }
 
-    return 0;
+  Ptr<wire::InterestTemplate>
+  Wrapper::createInterestTemplate (const Interest &interest) const
+  {
+    return m_format->createInterestTemplate (interest);
   }
 
-  int Wrapper::setInterestFilter (const Name &prefix, const InterestCallback &interestCallback, bool record/* = true*/)
+  int Wrapper::sendInterest (const wire::InterestTemplate &interestTemplate, const Name &suffix, Ptr<Closure> closurePtr)
   {
-    _LOG_TRACE (">> setInterestFilter");
-    UniqueRecLock lock(m_mutex);
-    if (!m_running || !m_connected)
+    _LOG_TRACE (">> sendInterest: " << interestTemplate.getInterest ().getName () << suffix);
+
+    Ptr<PendingInterest> pending = Ptr<PendingInterest>::Create ();
+    pending->m_interest = interestTemplate.createInterest (suffix);
+    pending->m_nonceOffset = interestTemplate.encode (suffix, 0, pending->m_wire);
+
+    return submitInterest (pending, closurePtr);
+  }
+
+  int
+  Wrapper::submitInterest (Ptr<PendingInterest> pending, Ptr<Closure> closurePtr)
+  {
+    double lifetime = DEFAULT_INTEREST_LIFETIME;
+    if (!pending->m_interest->getInterestLifetime ().is_negative ())
       {
-        return -1;
+        lifetime = pending->m_interest->getInterestLifetime ().total_microseconds () / 1000000.0;
       }
 
-    ndn_closure *interestClosure = new ndn_closure;
-    
-    // interestClosure->data = new ExecutorInterestClosure(interestCallback, m_executor);
+    pending->m_closures.push_back (Ptr<Closure>(new Closure(*closurePtr)));
 
-    interestClosure->data = new tuple<Wrapper::InterestCallback *, Ptr<Executor> > (new InterestCallback (interestCallback), m_executor); // should be removed when closure is removed
-    interestClosure->p = &incomingInterest;
+    OutboundRequest request;
+    request.m_type = OutboundRequest::INTEREST;
+    request.m_pending = pending;
+    // lifetime includes time spent in the queue
+    request.m_expireAt = time::Now () + time::Seconds (lifetime);
 
-    charbuf_stream prefixStream;
-    wire::Ndnb::appendName (prefixStream, prefix);
+    return submit (request, pending->m_wire.size ());
+  }
+
+  /**
+   * @brief Check if encoded interests are identical, except for their nonces
+   */
+  static bool
+  isSameInterest (const Wrapper::PendingInterest &first, const Wrapper::PendingInterest &second)
+  {
+    if (first.m_nonceOffset == 0 || first.m_nonceOffset != second.m_nonceOffset)
+      return first.m_wire == second.m_wire;
 
-    int ret = ndn_set_interest_filter (m_handle, prefixStream.buf ().getBuf (), interestClosure);
-    if (ret < 0)
+    size_t nonceEnd = first.m_nonceOffset + sizeof (uint32_t);
+    return first.m_wire.size () == second.m_wire.size () &&
+      memcmp (first.m_wire.buf (), second.m_wire.buf (), first.m_nonceOffset) == 0 &&
+      memcmp (first.m_wire.buf () + nonceEnd, second.m_wire.buf () + nonceEnd, first.m_wire.size () - nonceEnd) == 0;
+  }
+
+  void
+  Wrapper::expressInterest (Ptr<PendingInterest> pending, const Time &expireAt)
+  {
+    CallbackTable< Ptr<PendingInterest> >::iterator entry = m_pendingInterests.try_insert (pending->m_interest->getName ()).first;
+    BOOST_FOREACH (const Ptr<PendingInterest> &existing, *entry->payload ())
       {
-        _LOG_ERROR ("<< setInterestFilter: ndn_set_interest_filter FAILED");
+        if (isSameInterest (*existing, *pending))
+          {
+            // identical interest is already pending, data will be delivered to all closures
+            existing->m_closures.splice (existing->m_closures.end (), pending->m_closures);
+            _LOG_TRACE ("<< sendInterest: aggregated with pending interest (" << existing->m_closures.size () << " closures)");
+
+            // closure waits for its own lifetime, the interest is expressed again if it expires before that
+            existing->m_lastExpireAt = std::max (existing->m_lastExpireAt, expireAt);
+            return;
+          }
       }
 
-    if (record)
+    pending->m_expiration = m_expirations.insert (make_pair (expireAt, pending));
+    pending->m_lastExpireAt = expireAt;
+    entry->payload ()->push_back (pending);
+
+    if (expireAt <= time::Now ())
+      return; // expired while waiting in the queue (e.g., during reconnection), will time out right away
+
+    transmitInterest (*pending);
+  }
+
+  void
+  Wrapper::transmitInterest (PendingInterest &pending)
+  {
+    if (pending.m_nonceOffset > 0)
       {
-        m_registeredInterests.insert(pair<Name, InterestCallback>(prefix, interestCallback));
+        uint32_t nonce = m_nonceGenerator ();
+        memcpy (&pending.m_wire[pending.m_nonceOffset], &nonce, sizeof (nonce));
       }
+    m_transport->send (reinterpret_cast<const unsigned char *> (pending.m_wire.buf ()), pending.m_wire.size ());
+  }
 
-    _LOG_TRACE ("<< setInterestFilter");
+  int Wrapper::setInterestFilter (const Name &prefix, const InterestCallback &interestCallback, bool record/* = true*/)
+  {
+    _LOG_TRACE (">> setInterestFilter");
 
-    return ret;
+    OutboundRequest request;
+    request.m_type = OutboundRequest::SET_FILTER;
+    request.m_prefix = prefix;
+    request.m_callback = interestCallback;
+    request.m_record = record;
+
+    return submit (request, 0);
   }
 
   void
   Wrapper::clearInterestFilter (const Name &prefix, bool record/* = true*/)
   {
     _LOG_TRACE (">> clearInterestFilter");
-    UniqueRecLock lock(m_mutex);
-    if (!m_running || !m_connected)
-      return;
 
-    charbuf_stream prefixStream;
-    wire::Ndnb::appendName (prefixStream, prefix);
-    
-    int ret = ndn_set_interest_filter (m_handle, prefixStream.buf ().getBuf (), 0);
-    if (ret < 0)
-      {
-      }
+    OutboundRequest request;
+    request.m_type = OutboundRequest::CLEAR_FILTER;
+    request.m_prefix = prefix;
+    request.m_record = record;
 
-    if (record)
-      {
-        m_registeredInterests.erase(prefix);
-      }
+    submit (request, 0);
+  }
+
+  int
+  Wrapper::setCoveringPrefix (const Name &prefix)
+  {
+    _LOG_TRACE (">> setCoveringPrefix: " << prefix);
+
+    OutboundRequest request;
+    request.m_type = OutboundRequest::SET_COVER;
+    request.m_prefix = prefix;
+
+    return submit (request, 0);
+  }
+
+  void
+  Wrapper::clearCoveringPrefix (const Name &prefix)
+  {
+    _LOG_TRACE (">> clearCoveringPrefix: " << prefix);
+
+    OutboundRequest request;
+    request.m_type = OutboundRequest::CLEAR_COVER;
+    request.m_prefix = prefix;
+
+    submit (request, 0);
+  }
+
+  int
+  Wrapper::dispatchInterest (const Name &prefix, Ptr<Interest> interest)
+  {
+    OutboundRequest request;
+    request.m_type = OutboundRequest::DISPATCH;
+    request.m_prefix = prefix;
+    request.m_interest = interest;
 
-    _LOG_TRACE ("<< clearInterestFilter");
+    return submit (request, 0);
   }
 
 }//ndn
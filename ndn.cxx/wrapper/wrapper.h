@@ -18,16 +18,27 @@
 #include <boost/thread/locks.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 #include "ndn.cxx/common.h"
 #include "ndn.cxx/fields/name.h"
 #include "ndn.cxx/interest.h"
 #include "ndn.cxx/security/keychain.h"
+#include "ndn.cxx/face.h"
+#include "ndn.cxx/transport/transport.h"
+#include "ndn.cxx/wire/interest-template.h"
+#include "ndn.cxx/helpers/mpsc-queue.h"
 
 #include "closure.h"
+#include "signing-pipeline.h"
+
+#include <list>
+#include <map>
+#include <set>
 
 
 class Executor;
+class Strand;
 
 namespace ndn {
   namespace security {
@@ -41,7 +52,38 @@ namespace ndn {
     const static int DEFAULT_FRESHNESS = 60;
     typedef boost::function<void (Ptr<Interest>)> InterestCallback;
 
-    Wrapper(Ptr<security::Keychain> keychain = Ptr<security::Keychain>::Create());
+    /**
+     * @brief Callback called (in the thread of the caller) when a packet is rejected because
+     *        the outbound queue is full.  Parameter is the number of currently queued bytes
+     */
+    typedef boost::function<void (size_t queuedBytes)> BackpressureCallback;
+
+    /// @brief Default limit on the size of encoded packets waiting in the outbound queue (16MB)
+    static const size_t DEFAULT_OUTBOUND_LIMIT;
+
+    /**
+     * @brief Callback called (from a signing thread) when asynchronously published data has been
+     *        signed and queued for sending (published is true), or when it could not be (published is false)
+     */
+    typedef SigningPipeline::CompletionCallback PublishCallback;
+
+    /// @brief Default limit on the number of Data packets being signed asynchronously
+    static const size_t DEFAULT_SIGNING_LIMIT;
+
+    /// @brief Default number of threads running Interest, Data and timeout callbacks
+    static const int DEFAULT_CALLBACK_THREADS;
+
+    /**
+     * @brief Create wrapper and connect it to the forwarder
+     * @param keychain keychain used to sign and verify packets
+     * @param transport transport to the forwarder. If not set, NdnxTransport (connection to ndnd) is used
+     * @param callbackThreads number of threads running callbacks.  Callbacks of one interest
+     *        filter (one registered prefix) or one closure (and its copies) are called one at a
+     *        time in the order of events, callbacks of different filters and closures run in parallel
+     */
+    Wrapper(Ptr<security::Keychain> keychain = Ptr<security::Keychain>::Create(),
+            Ptr<Transport> transport = Ptr<Transport> (),
+            int callbackThreads = DEFAULT_CALLBACK_THREADS);
     ~Wrapper();
     
     void
@@ -53,15 +95,80 @@ namespace ndn {
     void
     shutdown (); // called in destructor, but can called manually
 
+    /**
+     * @brief Set limit on the size of encoded packets waiting to be sent
+     *
+     * Packets are queued without blocking and sent in batches by the I/O thread (also while
+     * connection to the forwarder is being restored).  When the limit is reached, packets are
+     * rejected and backpressureCallback is called.  Should be called before sending packets.
+     */
+    void
+    setOutboundLimit (size_t maxQueuedBytes, const BackpressureCallback &backpressureCallback = BackpressureCallback ());
+
+    /**
+     * @brief Set number of threads signing asynchronously published data and the limit on data
+     *        being signed (publishing blocks while the limit is reached)
+     *
+     * By default, one thread per CPU core is started on the first asynchronous publish.  Data
+     * that is already being signed is published before the new pool takes over.
+     */
+    void
+    setSigningWorkers (int workers, size_t maxInFlight = DEFAULT_SIGNING_LIMIT);
+
     int
     setInterestFilter (const Name &prefix, const InterestCallback &interestCallback, bool record = true);
     
     void
     clearInterestFilter (const Name &prefix, bool record = true);
 
+    /**
+     * @brief Register covering prefix with the forwarder, interest filters under it are dispatched locally
+     *
+     * Filters set under the covering prefix are not registered with the forwarder one by one:
+     * interests for the covering prefix are dispatched by the wrapper to all filters with matching
+     * prefixes (longest first), and are dropped if no filter matches.  Setting such filters, as well
+     * as restoring registrations after reconnect, takes no round trips to the forwarder.
+     */
+    int
+    setCoveringPrefix (const Name &prefix);
+
+    /**
+     * @brief Unregister covering prefix, filters under it are registered with the forwarder individually again
+     */
+    void
+    clearCoveringPrefix (const Name &prefix);
+
+    /**
+     * @brief Deliver interest to the filter of the prefix, as if it has been received for the prefix
+     *
+     * The callback of the filter is called in the callback threads of this wrapper (through the
+     * strand of the filter).  The interest is dropped if the prefix has no filter.
+     *
+     * @returns 0 on success, -1 if wrapper is shut down
+     */
+    int
+    dispatchInterest (const Name &prefix, Ptr<Interest> interest);
+
     int
     sendInterest (Ptr<Interest> interest, Ptr<Closure> closurePtr);
 
+    /**
+     * @brief Create template for Interests that differ only in the name suffix (see sendInterest)
+     * @param interest Interest with the common prefix and selectors
+     */
+    Ptr<wire::InterestTemplate>
+    createInterestTemplate (const Interest &interest) const;
+
+    /**
+     * @brief Send Interest for the prefix of the template followed by the suffix
+     *
+     * Same as sendInterest (interestTemplate.createInterest (suffix), closure), except that only
+     * the suffix is encoded.  Template should have been created by createInterestTemplate of
+     * this wrapper (or in its wire format).
+     */
+    int
+    sendInterest (const wire::InterestTemplate &interestTemplate, const Name &suffix, Ptr<Closure> closurePtr);
+
     int
     publishDataByCert (const Name &name, 
                        const unsigned char *buf, 
@@ -106,9 +213,58 @@ namespace ndn {
     // Bytes
     // createContentObject(const Name &name, const void *buf, size_t len, int freshness = DEFAULT_FRESHNESS, const Name &keyNameParam=Name());
 
+    /**
+     * @brief Sign data with the certificate and publish it
+     *
+     * Payload of the data is not copied: it is hashed for the signature and written to the
+     * forwarder directly from the data, which is kept alive until it is sent.  The data should
+     * not be modified after this call.
+     */
+    int
+    publishDataByCert (Ptr<Data> data, const Name & certificateName);
+
+    /**
+     * @brief Sign data with the default certificate of the identity and publish it (payload is
+     *        not copied, see publishDataByCert (Ptr<Data>, const Name &))
+     */
+    int
+    publishDataByIdentity (Ptr<Data> data, const Name &identityName);
+
+    /**
+     * @brief Sign data with the certificate in a signing thread and publish it
+     *
+     * Data packets are signed in parallel, but sent in the order of the calls.  The data should
+     * not be modified after this call.
+     *
+     * @returns 0 if data has been accepted for signing, -1 if wrapper is shut down
+     */
+    int
+    publishDataByCertAsync (Ptr<Data> data, const Name &certificateName, const PublishCallback &callback = PublishCallback ());
+
+    /**
+     * @brief Sign data with the default certificate of the identity in a signing thread and
+     *        publish it (see publishDataByCertAsync)
+     */
+    int
+    publishDataByIdentityAsync (Ptr<Data> data, const Name &identityName = Name (), const PublishCallback &callback = PublishCallback ());
+
     int
     putToNdnd (const Blob &contentObject);
 
+    /**
+     * @brief Send encoded packet, buffers referenced by the list should not be modified after this call
+     */
+    int
+    putToNdnd (Ptr<const wire::IovecList> packet);
+
+    /**
+     * @brief Get wire format of the packets, which is the format of the transport
+     *
+     * Data published through the wrapper is encoded and signed in this format
+     */
+    Ptr<const wire::Format>
+    getWireFormat () const;
+
     // bool
     // verify(PcoPtr &pco, double maxWait = 1 /*seconds*/);
 
@@ -118,11 +274,157 @@ namespace ndn {
   private:
     Wrapper(const Wrapper &other) {}
 
+    static Ptr<wire::IovecList>
+    encodeData (Ptr<const Data> data);
+
+    Ptr<SigningPipeline>
+    getSigningPipeline ();
+
+  public:
+    /// @cond include_hidden
+    struct PendingInterest;
+    typedef std::multimap<Time, Ptr<PendingInterest> > ExpirationQueue;
+
+    /**
+     * @brief Interest that has been expressed to ndnd and is waiting for data
+     *
+     * All closures of identical interests (same name, same selectors) are attached to
+     * one PendingInterest, so only one interest is sent upstream and returned data is
+     * decoded and verified only once.  Attached closures time out together, when the
+     * lifetime of the last one of them has passed (the interest is re-expressed as needed).
+     */
+    struct PendingInterest
+    {
+      Ptr<Interest> m_interest;
+      Blob m_wire; ///< @brief encoded interest, used to match identical interests
+      size_t m_nonceOffset; ///< @brief offset of the Nonce in m_wire (0 if the format has no nonce), nonce is not matched
+      std::list< Ptr<Closure> > m_closures;
+      ExpirationQueue::iterator m_expiration;
+      Time m_lastExpireAt; ///< @brief latest expiration requested by the attached closures
+    };
+
+    /**
+     * @brief Registered prefix, interests for it are dispatched to the callback through its own strand
+     */
+    struct InterestFilter
+    {
+      Name m_prefix;
+      InterestCallback m_callback;
+      Ptr<Strand> m_strand;
+    };
+
+    /**
+     * @brief Request from a user thread to the I/O thread, passed through the lock-free outbound queue
+     */
+    struct OutboundRequest
+    {
+      enum Type
+        {
+          PACKET,       ///< @brief send encoded packet (m_wire)
+          PACKET_LIST,  ///< @brief send packet encoded as a list of buffers (m_packet)
+          INTEREST,     ///< @brief express interest (m_pending), which expires at m_expireAt
+          SET_FILTER,   ///< @brief register m_prefix and its m_callback
+          CLEAR_FILTER, ///< @brief unregister m_prefix (and forget it if m_record is set)
+          SET_COVER,    ///< @brief register covering prefix m_prefix
+          CLEAR_COVER,  ///< @brief unregister covering prefix m_prefix
+          DISPATCH      ///< @brief deliver m_interest to the filter of m_prefix
+        };
+
+      Type m_type;
+      Ptr<Blob> m_wire;
+      Ptr<const wire::IovecList> m_packet;
+      Ptr<PendingInterest> m_pending;
+      Ptr<Interest> m_interest;
+      Time m_expireAt;
+      Name m_prefix;
+      InterestCallback m_callback;
+      bool m_record;
+    };
+    /// @endcond
+
+  private:
+    void
+    clearPendingInterest (Ptr<PendingInterest> pending);
+
+    void
+    expirePendingInterests ();
+
+    void
+    onReceive (const unsigned char *buf, size_t length);
+
+    /**
+     * @brief Dispatch interest to the matching filters, interest is decoded only if there is at least one
+     */
+    void
+    onInterest (const Name &name, const unsigned char *buf, size_t length);
+
+    /**
+     * @brief Satisfy matching pending interests, data is decoded only if there is at least one
+     */
+    void
+    onData (const Name &name, const unsigned char *buf, size_t length);
+
+    /**
+     * @brief Queue request for the I/O thread
+     * @param size number of bytes accounted against the outbound limit
+     * @returns 0 on success, -1 if wrapper is shut down or the queue is full
+     */
     int
-    publishDataByCert (Data &data, const Name & certificateName);
+    submit (const OutboundRequest &request, size_t size);
+
+    /**
+     * @brief Remove size of the request taken by the I/O thread from the queued bytes
+     */
+    void
+    releaseOutbound (size_t size);
 
+    /**
+     * @brief Process all queued requests (called from the I/O thread)
+     */
+    void
+    processOutbound ();
+
+    void
+    processRequest (const OutboundRequest &request);
+
+    void
+    setCover (const Name &prefix);
+
+    void
+    clearCover (const Name &prefix);
+
+    /**
+     * @brief Check if prefix is under one of the covering prefixes (interests for it reach the wrapper anyways)
+     */
+    bool
+    isCovered (const Name &prefix) const;
+
+    /**
+     * @brief Queue encoded interest for the I/O thread
+     */
+    int
+    submitInterest (Ptr<PendingInterest> pending, Ptr<Closure> closurePtr);
+
+    void
+    expressInterest (Ptr<PendingInterest> pending, const Time &expireAt);
+
+    /**
+     * @brief Send pending interest upstream with a fresh nonce
+     */
+    void
+    transmitInterest (PendingInterest &pending);
+
+    /**
+     * @brief Wake up I/O thread, so it picks up new requests
+     */
+    void
+    wakeup ();
+
+    /**
+     * @brief Get time (in milliseconds) until the earliest expiration of a pending interest (-1 if none)
+     */
     int
-    publishDataByIdentity (Data &data, const Name &identityName);
+    getPollTimeout () const;
 
   protected:
     void
@@ -142,26 +444,31 @@ namespace ndn {
     typedef boost::recursive_mutex RecLock;
     typedef boost::unique_lock<RecLock> UniqueRecLock;
 
-    ndn_client* m_handle;
+    Ptr<Transport> m_transport;
+    Ptr<const wire::Format> m_format; // format of the transport
     RecLock m_mutex;
     boost::thread m_thread;
     bool m_running;
     bool m_connected;
-    std::map<Name, InterestCallback> m_registeredInterests;
+    CallbackTable<InterestFilter> m_registeredInterests; // local dispatch table, one filter per prefix
+    std::set<Name> m_registeredPrefixes; // prefixes registered with the forwarder (restored after reconnect)
+    std::set<Name> m_coveringPrefixes;
+    CallbackTable< Ptr<PendingInterest> > m_pendingInterests;
+    ExpirationQueue m_expirations;
+    int m_wakeupPipe[2]; // self-pipe to interrupt poll () in the I/O thread
+    MpscQueue<OutboundRequest> m_outbound;
+    volatile size_t m_outboundBytes;
+    size_t m_outboundLimit;
+    size_t m_outboundBatchBytes; // accessed only by the I/O thread
+    boost::mt19937 m_nonceGenerator; // accessed only by the I/O thread
+    BackpressureCallback m_backpressureCallback;
     Ptr<Executor> m_executor;
     Ptr<security::Keychain> m_keychain;
+    Ptr<SigningPipeline> m_signingPipeline; // created on first asynchronous publish
 };
 
 typedef boost::shared_ptr<Wrapper> WrapperPtr;
 
-/**
- * @brief Namespace holding all exceptions that can be fired by the library
- */
-namespace Error
-{
-struct ndnOperation : boost::exception, std::exception { };
-}
-
 inline int
 Wrapper::publishDataByCert (const Name &name, const Blob &content, const Name & certificateName, int freshness)
 {
@@ -17,6 +17,7 @@
 
 #include <utility>
 #include <boost/make_shared.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 INIT_LOGGER ("Scheduler");
 
@@ -139,7 +140,13 @@ Scheduler::shutdown()
     {
       event_base_loopbreak(m_base);
       m_executor.shutdown();
-      m_thread.join();
+
+      // the break is lost if the loop has not been entered yet (e.g., right after start), so it
+      // is repeated until the thread exits
+      while (!m_thread.timed_join(posix_time::milliseconds(10)))
+        {
+          event_base_loopbreak(m_base);
+        }
     }
 }
 
@@ -12,6 +12,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "executor/executor.h"
+#include "executor/strand.h"
 
 #include "logging.h"
 
@@ -70,3 +71,76 @@ BOOST_AUTO_TEST_CASE(TestExecutor)
 
   sleep(1);
 }
+
+struct StrandRecorder
+{
+  StrandRecorder () : maxRunning (0), totalRunning (0), maxTotalRunning (0) { }
+
+  void
+  job (int strand, int seq)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock (mutex);
+      running[strand] ++;
+      maxRunning = std::max (maxRunning, running[strand]);
+      totalRunning ++;
+      maxTotalRunning = std::max (maxTotalRunning, totalRunning);
+    }
+
+    usleep (200);
+
+    boost::unique_lock<boost::mutex> lock (mutex);
+    order[strand].push_back (seq);
+    running[strand] --;
+    totalRunning --;
+  }
+
+  boost::mutex mutex;
+  map<int, int> running;
+  map<int, vector<int> > order;
+  int maxRunning;
+  int totalRunning;
+  int maxTotalRunning;
+};
+
+BOOST_AUTO_TEST_CASE(TestStrand)
+{
+  const int strands = 4;
+  const int jobs = 100;
+
+  StrandRecorder recorder;
+  {
+    ExecutorPtr executor (new Executor (strands));
+    executor->start ();
+
+    vector<StrandPtr> strand;
+    for (int i = 0; i < strands; i++)
+      strand.push_back (StrandPtr (new Strand ()));
+
+    for (int seq = 0; seq < jobs; seq++)
+      for (int i = 0; i < strands; i++)
+        strand[i]->execute (executor, bind (&StrandRecorder::job, &recorder, i, seq));
+
+    for (int wait = 0; wait < 1000; wait++)
+      {
+        int done = 0;
+        for (int i = 0; i < strands; i++)
+          done += strand[i]->jobQueueSize ();
+        if (done == 0 && executor->jobQueueSize () == 0)
+          break;
+        usleep (10000);
+      }
+    usleep (10000);
+    executor->shutdown ();
+  }
+
+  // jobs of one strand never overlap and keep submission order, strands run in parallel
+  BOOST_CHECK_EQUAL (recorder.maxRunning, 1);
+  BOOST_CHECK_GT (recorder.maxTotalRunning, 1);
+  for (int i = 0; i < strands; i++)
+    {
+      BOOST_REQUIRE_EQUAL (recorder.order[i].size (), jobs);
+      for (int seq = 0; seq < jobs; seq++)
+        BOOST_CHECK_EQUAL (recorder.order[i][seq], seq);
+    }
+}
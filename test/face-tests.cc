@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "ndn.cxx/face.h"
+
+#include <iostream>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(FaceTests)
+
+static void
+dummySatisfied (Ptr<Data>, Ptr<const Interest>)
+{
+}
+
+BOOST_AUTO_TEST_CASE (TryInsert)
+{
+  Face::sent_interest_container table;
+
+  pair<Face::sent_interest, bool> res = table.try_insert (Name ("/a/b/c"));
+  BOOST_CHECK (res.first != table.end ());
+  BOOST_CHECK_EQUAL (res.second, true);
+  BOOST_CHECK (res.first->payload () != 0);
+  BOOST_CHECK_EQUAL (table.getPolicy ().size (), 1);
+
+  res.first->payload ()->push_back (dummySatisfied);
+
+  pair<Face::sent_interest, bool> res2 = table.try_insert (Name ("/a/b/c"));
+  BOOST_CHECK (res2.first == res.first);
+  BOOST_CHECK_EQUAL (res2.second, false);
+  BOOST_CHECK_EQUAL (res2.first->payload ()->size (), 1);
+  BOOST_CHECK_EQUAL (table.getPolicy ().size (), 1);
+
+  // intermediate node without payload gets the payload on insertion
+  pair<Face::sent_interest, bool> res3 = table.try_insert (Name ("/a/b"));
+  BOOST_CHECK_EQUAL (res3.second, true);
+  BOOST_CHECK (res3.first->payload () != 0);
+  BOOST_CHECK_EQUAL (table.getPolicy ().size (), 2);
+
+  BOOST_CHECK (table.find_exact (Name ("/a/b/c")) == res.first);
+  BOOST_CHECK (table.find_exact (Name ("/a/b")) == res3.first);
+}
+
+BOOST_AUTO_TEST_CASE (RepeatedInterest)
+{
+  Face face;
+  Name name ("/ndn/ucla.edu/repeated/interest/name");
+  Ptr<Interest> interest = Create<Interest> (name);
+
+  Face::sent_interest first = face.sendInterest (interest, dummySatisfied);
+  Face::sent_interest second = face.sendInterest (interest, dummySatisfied);
+
+  BOOST_CHECK (first == second);
+  BOOST_CHECK_EQUAL (first->payload ()->size (), 2);
+}
+
+BOOST_AUTO_TEST_CASE (RepeatedInterestBenchmark)
+{
+  // the same interest is expressed again after the previous one has been satisfied,
+  // i.e., every lookup misses and the entry has to be created
+  const int iterations = 100000;
+  Name name ("/ndn/ucla.edu/repeated/interest/name/with/several/components");
+
+  // find_exact, followed by insert on miss (two descents)
+  Face::sent_interest_container twoPass;
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Face::sent_interest item = twoPass.find_exact (name);
+      if (item == twoPass.end ())
+        {
+          item = twoPass.insert (name, Ptr<Face::sent_interest_container::payload_traits::payload_type>::Create ()).first;
+        }
+      item->payload ()->push_back (dummySatisfied);
+      twoPass.erase (item);
+    }
+  time_duration twoPassTime = microsec_clock::universal_time () - start;
+
+  // try_insert (single descent)
+  Face::sent_interest_container singlePass;
+  start = microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Face::sent_interest item = singlePass.try_insert (name).first;
+      item->payload ()->push_back (dummySatisfied);
+      singlePass.erase (item);
+    }
+  time_duration singlePassTime = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK_EQUAL (twoPass.getPolicy ().size (), 0);
+  BOOST_CHECK_EQUAL (singlePass.getPolicy ().size (), 0);
+
+  cout << "Repeated interest (" << iterations << " iterations): "
+       << "find_exact+insert " << twoPassTime.total_microseconds () << "us, "
+       << "try_insert " << singlePassTime.total_microseconds () << "us" << endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/loopback-face.h"
+
+#include <iostream>
+#include <unistd.h>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(LoopbackFaceTests)
+
+struct Counters
+{
+  Counters () : interests (0), data (0), timeouts (0) { }
+
+  int interests;
+  int data;
+  int timeouts;
+};
+
+static void
+produce (LoopbackFace *face, Counters *counters, Ptr<Interest> interest, Ptr<const Name> prefix)
+{
+  counters->interests ++;
+  BOOST_CHECK_EQUAL (*prefix, Name ("/producer"));
+
+  Ptr<Data> data = Create<Data> ();
+  data->setName (interest->getName ());
+  face->put (data);
+}
+
+static void
+consume (Counters *counters, Ptr<Data> data, Ptr<const Interest> interest)
+{
+  counters->data ++;
+  BOOST_CHECK_EQUAL (interest->getName (), data->getName ().getPrefix (interest->getName ().size ()));
+}
+
+static void
+timeout (Counters *counters, Ptr<const Interest> interest)
+{
+  counters->timeouts ++;
+}
+
+BOOST_AUTO_TEST_CASE (InterestData)
+{
+  LoopbackFace face;
+  Counters counters;
+
+  Name prefix ("/producer");
+  face.setInterestFilter (Ptr<const Name> (new Name (prefix)), bind (produce, &face, &counters, _1, _2));
+
+  Name name ("/producer/data/1");
+  face.sendInterest (Ptr<const Interest> (new Interest (name)),
+                     bind (consume, &counters, _1, _2),
+                     bind (timeout, &counters, _1));
+
+  BOOST_CHECK_EQUAL (counters.interests, 1);
+  BOOST_CHECK_EQUAL (counters.data, 1);
+  BOOST_CHECK_EQUAL (counters.timeouts, 0);
+
+  // data satisfies all pending interests with names that are prefixes of the data name
+  Name dataName ("/other/data/1");
+  face.sendInterest (Ptr<const Interest> (new Interest (Name ("/other"))), bind (consume, &counters, _1, _2));
+  face.sendInterest (Ptr<const Interest> (new Interest (Name ("/other/data"))), bind (consume, &counters, _1, _2));
+  face.sendInterest (Ptr<const Interest> (new Interest (Name ("/other/data"))), bind (consume, &counters, _1, _2));
+  face.sendInterest (Ptr<const Interest> (new Interest (Name ("/other/data/2"))), bind (consume, &counters, _1, _2));
+
+  Ptr<Data> data = Create<Data> ();
+  data->setName (dataName);
+  BOOST_CHECK_EQUAL (face.put (data), 2);
+  BOOST_CHECK_EQUAL (counters.data, 4);
+
+  // nothing is pending anymore
+  BOOST_CHECK_EQUAL (face.put (data), 0);
+  BOOST_CHECK_EQUAL (counters.data, 4);
+}
+
+BOOST_AUTO_TEST_CASE (Timeout)
+{
+  LoopbackFace face;
+  Counters counters;
+
+  Ptr<Interest> interest = Ptr<Interest> (new Interest (Name ("/nobody/home")));
+  interest->setInterestLifetime (0.1);
+  face.sendInterest (interest, bind (consume, &counters, _1, _2), bind (timeout, &counters, _1));
+
+  usleep (500000);
+  BOOST_CHECK_EQUAL (counters.timeouts, 1);
+  BOOST_CHECK_EQUAL (counters.data, 0);
+
+  // expired interest is not satisfied anymore
+  Ptr<Data> data = Create<Data> ();
+  data->setName (Name ("/nobody/home"));
+  BOOST_CHECK_EQUAL (face.put (data), 0);
+  BOOST_CHECK_EQUAL (counters.data, 0);
+}
+
+BOOST_AUTO_TEST_CASE (Benchmark)
+{
+  const int iterations = 100000;
+
+  LoopbackFace face;
+  Counters counters;
+
+  face.setInterestFilter (Ptr<const Name> (new Name ("/producer")), bind (produce, &face, &counters, _1, _2));
+
+  Name name ("/producer/benchmark");
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Ptr<Interest> interest = Ptr<Interest> (new Interest (name));
+      interest->getName ().appendSeqNum (i);
+      face.sendInterest (interest, bind (consume, &counters, _1, _2));
+    }
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK_EQUAL (counters.interests, iterations);
+  BOOST_CHECK_EQUAL (counters.data, iterations);
+
+  cout << "Loopback face: " << iterations << " Interest/Data exchanges in "
+       << duration.total_microseconds () << "us ("
+       << iterations * 1000000.0 / std::max<int64_t> (duration.total_microseconds (), 1) << " exchanges/s)" << endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
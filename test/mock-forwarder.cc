@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include "mock-forwarder.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "ndn.cxx/transport/unix-transport.h"
+#include "ndn.cxx/security/keychain.h"
+#include "ndn.cxx/security/identity/identity-manager.h"
+#include "ndn.cxx/security/policy/no-verify-policy-manager.h"
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace ndn {
+namespace test {
+
+std::string
+createTemporaryPath (const std::string &name)
+{
+  static int counter = 0;
+  return "/tmp/.ndn-cxx-" + name + "-" + boost::lexical_cast<string> (getpid ()) +
+    "-" + boost::lexical_cast<string> (__sync_fetch_and_add (&counter, 1));
+}
+
+Ptr<Blob>
+makeData (const Name &name, const Content &content/* = Content ("content", 7, Content::DATA)*/)
+{
+  Data data;
+  data.setName (name);
+
+  Ptr<signature::Sha256WithRsa> signature = Create<signature::Sha256WithRsa> ();
+  signature->setSignatureBits (Blob ("signature", 9));
+  signature->setPublisherKeyDigest (Blob ("12345678901234567890123456789012", 32));
+  KeyLocator keyLocator;
+  keyLocator.setType (KeyLocator::KEYNAME);
+  keyLocator.setKeyName (Name ("/mock/key"));
+  signature->setKeyLocator (keyLocator);
+  data.setSignature (signature);
+
+  data.setContent (content);
+
+  Ptr<Blob> unsignedData = data.encodeToUnsignedWire ();
+  Ptr<SignedBlob> signedBlob = Ptr<SignedBlob> (new SignedBlob (unsignedData->buf (), unsignedData->size ()));
+  signedBlob->setSignedPortion (0, unsignedData->size ());
+  data.setSignedBlob (signedBlob);
+
+  return data.encodeToWire ();
+}
+
+Ptr<security::Keychain>
+createKeychain ()
+{
+  return Ptr<security::Keychain> (new security::Keychain (Ptr<security::IdentityManager>::Create (),
+                                                          Ptr<security::NoVerifyPolicyManager>::Create (),
+                                                          Ptr<security::EncryptionManager> ()));
+}
+
+Ptr<Transport>
+createTransport (const std::string &socketPath)
+{
+  return Ptr<Transport> (new UnixTransport (socketPath));
+}
+
+Ptr<Wrapper>
+createWrapper (const std::string &socketPath, int callbackThreads/* = Wrapper::DEFAULT_CALLBACK_THREADS*/)
+{
+  return Ptr<Wrapper> (new Wrapper (createKeychain (), createTransport (socketPath), callbackThreads));
+}
+
+MockConnection::MockConnection (int fd)
+  : m_fd (fd)
+  , m_framer (wire::Format::ndnb (), UnixTransport::DEFAULT_MAX_PACKET_SIZE)
+{
+}
+
+MockConnection::~MockConnection ()
+{
+  close (m_fd);
+}
+
+int
+MockConnection::getFd () const
+{
+  return m_fd;
+}
+
+bool
+MockConnection::read (int timeoutMs, wire::Framer::PacketList &packets)
+{
+  pollfd fd = { m_fd, POLLIN, 0 };
+  if (poll (&fd, 1, timeoutMs) <= 0)
+    return true;
+
+  const size_t readSize = 65536;
+  ssize_t received = ::read (m_fd, m_framer.prepare (readSize), readSize);
+  if (received <= 0)
+    return false;
+
+  m_framer.commit (received, packets);
+  return true;
+}
+
+Ptr<Blob>
+MockConnection::receive (int timeoutMs)
+{
+  while (m_received.empty ())
+    {
+      pollfd fd = { m_fd, POLLIN, 0 };
+      if (poll (&fd, 1, timeoutMs) <= 0)
+        return Ptr<Blob> ();
+
+      wire::Framer::PacketList packets;
+      if (!read (0, packets))
+        return Ptr<Blob> ();
+
+      for (wire::Framer::PacketList::const_iterator packet = packets.begin (); packet != packets.end (); packet++)
+        m_received.push_back (Ptr<Blob> (new Blob (packet->m_buf, packet->m_size)));
+    }
+
+  Ptr<Blob> packet = m_received.front ();
+  m_received.pop_front ();
+  return packet;
+}
+
+bool
+MockConnection::send (const void *buf, size_t size)
+{
+  const char *data = reinterpret_cast<const char *> (buf);
+  for (size_t written = 0; written < size; )
+    {
+      ssize_t result = ::send (m_fd, data + written, size - written, MSG_NOSIGNAL);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        return false;
+      written += result;
+    }
+  return true;
+}
+
+bool
+MockConnection::send (const Blob &packet)
+{
+  return send (packet.buf (), packet.size ());
+}
+
+MockListener::MockListener (const std::string &name, int backlog/* = 1*/)
+  : m_path (createTemporaryPath (name) + ".sock")
+{
+  m_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strncpy (addr.sun_path, m_path.c_str (), sizeof (addr.sun_path) - 1);
+  BOOST_REQUIRE (bind (m_fd, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)) == 0);
+  BOOST_REQUIRE (listen (m_fd, backlog) == 0);
+}
+
+MockListener::~MockListener ()
+{
+  close (m_fd);
+  unlink (m_path.c_str ());
+}
+
+const std::string &
+MockListener::getPath () const
+{
+  return m_path;
+}
+
+Ptr<MockConnection>
+MockListener::accept (int timeoutMs)
+{
+  pollfd fd = { m_fd, POLLIN, 0 };
+  if (poll (&fd, 1, timeoutMs) <= 0)
+    return Ptr<MockConnection> ();
+
+  int client = ::accept (m_fd, 0, 0);
+  if (client < 0)
+    return Ptr<MockConnection> ();
+  return Ptr<MockConnection> (new MockConnection (client));
+}
+
+} // test
+} // ndn
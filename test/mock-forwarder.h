@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#ifndef NDN_TEST_MOCK_FORWARDER_H
+#define NDN_TEST_MOCK_FORWARDER_H
+
+#include "ndn.cxx/common.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/fields/blob.h"
+#include "ndn.cxx/wire/framer.h"
+#include "ndn.cxx/wrapper/wrapper.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <deque>
+#include <string>
+
+namespace ndn {
+
+class Transport;
+
+/**
+ * @brief Building blocks of mock forwarders and producers of the unit tests, which talk to
+ *        wrappers through UnixTransport
+ */
+namespace test {
+
+/**
+ * @brief Get path in /tmp that is unique for this process and call (e.g., for a Unix socket),
+ *        so parallel runs of the tests do not collide
+ */
+std::string
+createTemporaryPath (const std::string &name);
+
+/**
+ * @brief Encode Data with a fake signature (not verifiable, KeyLocator /mock/key)
+ */
+Ptr<Blob>
+makeData (const Name &name, const Content &content = Content ("content", 7, Content::DATA));
+
+/**
+ * @brief Create keychain that does not verify Data
+ */
+Ptr<security::Keychain>
+createKeychain ();
+
+/**
+ * @brief Create UnixTransport connecting to the socket
+ */
+Ptr<Transport>
+createTransport (const std::string &socketPath);
+
+/**
+ * @brief Create wrapper with keychain from createKeychain (), connected to the socket
+ */
+Ptr<Wrapper>
+createWrapper (const std::string &socketPath, int callbackThreads = Wrapper::DEFAULT_CALLBACK_THREADS);
+
+/**
+ * @brief Connection of a wrapper accepted by MockListener, received bytes are split into packets by wire::Framer
+ */
+class MockConnection : boost::noncopyable
+{
+public:
+  /**
+   * @brief Take ownership of the connected socket
+   */
+  explicit
+  MockConnection (int fd);
+
+  ~MockConnection ();
+
+  int
+  getFd () const;
+
+  /**
+   * @brief Wait up to timeoutMs for data and read it
+   * @param packets (out) list that complete packets are appended to, they are valid until the next read
+   * @returns false if the connection has been closed by the wrapper
+   */
+  bool
+  read (int timeoutMs, wire::Framer::PacketList &packets);
+
+  /**
+   * @brief Get the next packet, reading (and waiting up to timeoutMs for every read) as needed
+   * @returns copy of the packet, or null pointer if nothing has been received
+   */
+  Ptr<Blob>
+  receive (int timeoutMs);
+
+  /**
+   * @brief Write the whole buffer (SIGPIPE is not raised if the wrapper is gone)
+   * @returns false if the buffer cannot be written
+   */
+  bool
+  send (const void *buf, size_t size);
+
+  bool
+  send (const Blob &packet);
+
+private:
+  int m_fd;
+  wire::Framer m_framer;
+  std::deque< Ptr<Blob> > m_received; // packets read, but not returned by receive () yet
+};
+
+/**
+ * @brief Listening Unix socket of a mock forwarder, at a unique path (removed in the destructor)
+ */
+class MockListener : boost::noncopyable
+{
+public:
+  /**
+   * @param name part of the socket path, identifying the test
+   * @param backlog number of connections that can wait to be accepted
+   */
+  explicit
+  MockListener (const std::string &name, int backlog = 1);
+
+  ~MockListener ();
+
+  const std::string &
+  getPath () const;
+
+  /**
+   * @brief Wait up to timeoutMs for a connection
+   * @returns accepted connection, or null pointer if nobody has connected
+   */
+  Ptr<MockConnection>
+  accept (int timeoutMs);
+
+private:
+  std::string m_path;
+  int m_fd;
+};
+
+} // test
+} // ndn
+
+#endif // NDN_TEST_MOCK_FORWARDER_H
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/helpers/mpsc-queue.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ndn;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(MpscQueueTests)
+
+BOOST_AUTO_TEST_CASE (Order)
+{
+  MpscQueue<int> queue;
+  BOOST_CHECK (queue.empty ());
+
+  BOOST_CHECK_EQUAL (queue.push (1), true);
+  BOOST_CHECK_EQUAL (queue.push (2), false);
+  BOOST_CHECK_EQUAL (queue.push (3), false);
+
+  vector<int> items;
+  BOOST_CHECK_EQUAL (queue.popAll (items), 3);
+  BOOST_REQUIRE_EQUAL (items.size (), 3);
+  BOOST_CHECK_EQUAL (items[0], 1);
+  BOOST_CHECK_EQUAL (items[1], 2);
+  BOOST_CHECK_EQUAL (items[2], 3);
+
+  BOOST_CHECK (queue.empty ());
+  BOOST_CHECK_EQUAL (queue.popAll (items), 0);
+  BOOST_CHECK_EQUAL (queue.push (4), true);
+}
+
+static void
+produce (MpscQueue< pair<int, int> > *queue, int producer, int count)
+{
+  for (int i = 0; i < count; i++)
+    {
+      queue->push (make_pair (producer, i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE (MultipleProducers)
+{
+  const int producers = 4;
+  const int count = 100000;
+
+  MpscQueue< pair<int, int> > queue;
+  boost::thread_group threads;
+  for (int i = 0; i < producers; i++)
+    {
+      threads.create_thread (boost::bind (produce, &queue, i, count));
+    }
+
+  // items of every producer should come in order and none should be lost
+  vector<int> next (producers, 0);
+  int received = 0;
+  vector< pair<int, int> > batch;
+  while (received < producers * count)
+    {
+      batch.clear ();
+      queue.popAll (batch);
+      for (vector< pair<int, int> >::iterator item = batch.begin (); item != batch.end (); item++)
+        {
+          BOOST_REQUIRE_EQUAL (item->second, next[item->first]);
+          next[item->first] ++;
+        }
+      received += batch.size ();
+    }
+  threads.join_all ();
+
+  BOOST_CHECK (queue.empty ());
+}
+
+struct ThrowingConsumer
+{
+  ThrowingConsumer (vector<int> &items) : m_items (items) { }
+
+  void
+  operator () (int item)
+  {
+    if (item == 2)
+      throw runtime_error ("cannot consume");
+    m_items.push_back (item);
+  }
+
+  vector<int> &m_items;
+};
+
+BOOST_AUTO_TEST_CASE (Exception)
+{
+  MpscQueue<int> queue;
+  queue.push (1);
+  queue.push (2);
+  queue.push (3);
+
+  // item that failed is dropped, the rest of the batch is consumed (before new items) next time
+  vector<int> items;
+  BOOST_CHECK_THROW (queue.consumeAll (ThrowingConsumer (items)), runtime_error);
+  BOOST_REQUIRE_EQUAL (items.size (), 1);
+  BOOST_CHECK_EQUAL (items[0], 1);
+  BOOST_CHECK (!queue.empty ());
+
+  queue.push (4);
+  BOOST_CHECK_EQUAL (queue.consumeAll (ThrowingConsumer (items)), 2);
+  BOOST_REQUIRE_EQUAL (items.size (), 3);
+  BOOST_CHECK_EQUAL (items[1], 3);
+  BOOST_CHECK_EQUAL (items[2], 4);
+  BOOST_CHECK (queue.empty ());
+
+  // items left after the exception are released with the queue
+  queue.push (2);
+  queue.push (5);
+  BOOST_CHECK_THROW (queue.consumeAll (ThrowingConsumer (items)), runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/wrapper/segment-fetcher.h"
+#include "ndn.cxx/wrapper/wrapper.h"
+#include "mock-forwarder.h"
+
+#include <set>
+
+using namespace ndn;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(SegmentFetcherTests)
+
+/**
+ * @brief Forwarder that answers Interests for segments of an object (with FinalBlockId set), and
+ *        ignores the first Interest for every dropEvery-th segment
+ */
+class MockProducer
+{
+public:
+  MockProducer (const Name &prefix, size_t segments, size_t segmentSize, size_t dropEvery)
+    : m_prefix (prefix)
+    , m_segments (segments)
+    , m_segmentSize (segmentSize)
+    , m_dropEvery (dropEvery)
+    , m_listener ("segment-fetcher-test")
+    , m_running (true)
+  {
+    for (size_t i = 0; i < segments * segmentSize - segmentSize / 2; i++)
+      m_object.push_back (static_cast<char> (i * 7 + i / 1000));
+
+    m_thread = boost::thread (&MockProducer::run, this);
+  }
+
+  ~MockProducer ()
+  {
+    m_running = false;
+    m_thread.join ();
+  }
+
+  const std::string &
+  getPath () const
+  {
+    return m_listener.getPath ();
+  }
+
+  const Blob &
+  getObject () const
+  {
+    return m_object;
+  }
+
+private:
+  Ptr<Blob>
+  makeSegment (uint64_t segmentNo)
+  {
+    size_t offset = segmentNo * m_segmentSize;
+    return test::makeData (Name (m_prefix).appendSeqNum (segmentNo),
+                           Content (m_object.buf () + offset, std::min (m_segmentSize, m_object.size () - offset),
+                                    Content::DATA, Content::maxFreshness,
+                                    name::Component::fromNumberWithMarker (m_segments - 1, 0x00)));
+  }
+
+  void
+  run ()
+  {
+    Ptr<test::MockConnection> client;
+    while (m_running && !client)
+      client = m_listener.accept (10);
+
+    while (m_running)
+      {
+        Ptr<Blob> packet = client->receive (10);
+        if (!packet)
+          continue;
+
+        Ptr<Interest> interest = Interest::decodeFromWire (packet);
+        if (interest->getName ().size () != m_prefix.size () + 1 ||
+            interest->getName ().getPrefix (m_prefix.size ()) != m_prefix)
+          continue;
+
+        uint64_t segmentNo = interest->getName ().get (-1).toSeqNum ();
+        if (segmentNo >= m_segments)
+          continue;
+
+        if (m_dropEvery > 0 && segmentNo % m_dropEvery == m_dropEvery / 2 && m_dropped.insert (segmentNo).second)
+          continue;
+
+        BOOST_REQUIRE (client->send (*makeSegment (segmentNo)));
+      }
+  }
+
+private:
+  Name m_prefix;
+  size_t m_segments;
+  size_t m_segmentSize;
+  size_t m_dropEvery;
+  Blob m_object;
+  set<uint64_t> m_dropped;
+
+  test::MockListener m_listener;
+  volatile bool m_running;
+  boost::thread m_thread;
+};
+
+struct Completion
+{
+  Completion () : finished (false), success (false) { }
+
+  void
+  onComplete (Ptr<SegmentFetcher> , bool ok)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    finished = true;
+    success = ok;
+    cond.notify_all ();
+  }
+
+  void
+  onSegment (uint64_t segmentNo, Ptr<Data> data)
+  {
+    order.push_back (segmentNo);
+    content.insert (content.end (), data->content ().begin (), data->content ().end ());
+  }
+
+  bool
+  wait (int timeoutMs)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    while (!finished)
+      {
+        if (!cond.timed_wait (lock, deadline))
+          return false;
+      }
+    return true;
+  }
+
+  boost::mutex mutex;
+  boost::condition_variable cond;
+  bool finished;
+  bool success;
+  vector<uint64_t> order;
+  Blob content;
+};
+
+BOOST_AUTO_TEST_CASE (RttEstimation)
+{
+  RttEstimator rtt (1.0, 0.05, 4.0);
+  BOOST_CHECK_LT (rtt.getSmoothedRtt (), 0);
+  BOOST_CHECK_CLOSE (rtt.getRto (), 1.0, 0.001);
+
+  rtt.addMeasurement (0.1);
+  BOOST_CHECK_CLOSE (rtt.getSmoothedRtt (), 0.1, 0.001);
+  BOOST_CHECK_CLOSE (rtt.getRttVariation (), 0.05, 0.001);
+  BOOST_CHECK_CLOSE (rtt.getRto (), 0.3, 0.001);
+
+  rtt.addMeasurement (0.2);
+  BOOST_CHECK_CLOSE (rtt.getRttVariation (), 0.0625, 0.001);
+  BOOST_CHECK_CLOSE (rtt.getSmoothedRtt (), 0.1125, 0.001);
+  BOOST_CHECK_CLOSE (rtt.getRto (), 0.3625, 0.001);
+
+  rtt.backoff ();
+  BOOST_CHECK_CLOSE (rtt.getRto (), 0.725, 0.001);
+  for (int i = 0; i < 10; i++)
+    rtt.backoff ();
+  BOOST_CHECK_CLOSE (rtt.getRto (), 4.0, 0.001);
+
+  // stable RTT converges, RTO is clamped from below
+  for (int i = 0; i < 200; i++)
+    rtt.addMeasurement (0.001);
+  BOOST_CHECK_CLOSE (rtt.getSmoothedRtt (), 0.001, 1);
+  BOOST_CHECK_CLOSE (rtt.getRto (), 0.05, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE (Fetch)
+{
+  const size_t segments = 500;
+  const size_t segmentSize = 4096;
+
+  Name prefix ("/mock/object");
+  MockProducer producer (prefix, segments, segmentSize, 50);
+  Ptr<Wrapper> wrapper = test::createWrapper (producer.getPath ());
+
+  Completion completion;
+  Ptr<SegmentFetcher> fetcher (new SegmentFetcher (wrapper, prefix,
+                                                   boost::bind (&Completion::onComplete, &completion, _1, _2)));
+  fetcher->setRtoLimits (0.02, 1.0);
+  fetcher->start ();
+
+  BOOST_REQUIRE (completion.wait (20000));
+  BOOST_CHECK (completion.success);
+  BOOST_CHECK (fetcher->isFinished ());
+  BOOST_REQUIRE (fetcher->getContent ());
+  BOOST_CHECK (*fetcher->getContent () == producer.getObject ());
+
+  // every dropped Interest is retransmitted, and the window is reduced
+  SegmentFetcher::Statistics statistics = fetcher->getStatistics ();
+  BOOST_CHECK_EQUAL (statistics.m_segments, segments);
+  BOOST_CHECK_EQUAL (statistics.m_bytes, producer.getObject ().size ());
+  BOOST_CHECK_GE (statistics.m_retransmissions, segments / 50);
+  BOOST_CHECK_GE (statistics.m_windowDecreases, 1);
+
+  cout << "SegmentFetcher: " << statistics.m_bytes << " bytes in " << statistics.m_segments << " segments fetched in "
+       << statistics.m_duration.total_milliseconds () << "ms (" << statistics.getThroughput () / 1000000 << " MB/s, "
+       << statistics.m_retransmissions << " retransmissions, window " << fetcher->getWindow ()
+       << ", RTO " << fetcher->getRto () * 1000 << "ms)" << endl;
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Stream)
+{
+  const size_t segments = 100;
+
+  Name prefix ("/mock/stream");
+  MockProducer producer (prefix, segments, 1000, 10);
+  Ptr<Wrapper> wrapper = test::createWrapper (producer.getPath ());
+
+  Completion completion;
+  Ptr<SegmentFetcher> fetcher (new SegmentFetcher (wrapper, prefix,
+                                                   boost::bind (&Completion::onComplete, &completion, _1, _2),
+                                                   boost::bind (&Completion::onSegment, &completion, _1, _2)));
+  fetcher->setWindow (16, 16);
+  fetcher->setRtoLimits (0.02, 1.0);
+  fetcher->start ();
+
+  BOOST_REQUIRE (completion.wait (20000));
+  BOOST_CHECK (completion.success);
+  BOOST_CHECK (!fetcher->getContent ());
+
+  // segments are passed to the callback in order, although dropped ones arrive late
+  BOOST_REQUIRE_EQUAL (completion.order.size (), segments);
+  for (size_t i = 0; i < segments; i++)
+    BOOST_CHECK_EQUAL (completion.order[i], i);
+  BOOST_CHECK (completion.content == producer.getObject ());
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Failure)
+{
+  MockProducer producer (Name ("/mock/other"), 1, 1000, 0);
+  Ptr<Wrapper> wrapper = test::createWrapper (producer.getPath ());
+
+  Completion completion;
+  Ptr<SegmentFetcher> fetcher (new SegmentFetcher (wrapper, Name ("/mock/nothing"),
+                                                   boost::bind (&Completion::onComplete, &completion, _1, _2)));
+  fetcher->setRtoLimits (0.01, 0.05);
+  fetcher->setMaxRetries (2);
+  fetcher->start ();
+
+  BOOST_REQUIRE (completion.wait (5000));
+  BOOST_CHECK (!completion.success);
+  BOOST_CHECK_GE (fetcher->getStatistics ().m_retransmissions, 2);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
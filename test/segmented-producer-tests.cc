@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "ndn.cxx/wrapper/segmented-producer.h"
+#include "ndn.cxx/wrapper/wrapper.h"
+#include "ndn.cxx/transport/unix-transport.h"
+#include "mock-forwarder.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(SegmentedProducerTests)
+
+/**
+ * @brief Forwarder that sends Interests for segments to the connected wrapper, keeping a fixed
+ *        number of them outstanding
+ */
+class MockForwarder
+{
+public:
+  MockForwarder ()
+    : m_listener ("segmented-producer-test")
+  {
+  }
+
+  const std::string &
+  getPath () const
+  {
+    return m_listener.getPath ();
+  }
+
+  /**
+   * @brief Accept connection of the wrapper and wait until it registers the prefix
+   */
+  void
+  waitForRegistration (const Name &prefix)
+  {
+    if (!m_client)
+      {
+        m_client = m_listener.accept (2000);
+        BOOST_REQUIRE (m_client);
+      }
+
+    while (true)
+      {
+        Ptr<Blob> packet = m_client->receive (2000);
+        BOOST_REQUIRE (packet);
+        Ptr<Interest> interest = Interest::decodeFromWire (packet);
+        if (interest->getName () == Name (UnixTransport::REGISTER_PREFIX).append (prefix))
+          return;
+      }
+  }
+
+  Ptr<Data>
+  get (const Name &name, int timeoutMs = 2000)
+  {
+    send (name);
+    Ptr<Blob> packet = m_client->receive (timeoutMs);
+    return packet ? Data::decodeFromWire (packet) : Ptr<Data> ();
+  }
+
+  /**
+   * @brief Fetch all segments of the object, with window outstanding Interests, in order
+   */
+  vector< Ptr<Data> >
+  fetch (const Name &name, uint64_t segments, uint64_t window)
+  {
+    vector< Ptr<Data> > result (segments);
+    uint64_t next = 0;
+    for (; next < std::min (window, segments); next++)
+      send (Name (name).appendSeqNum (next));
+
+    for (uint64_t received = 0; received < segments; received++)
+      {
+        Ptr<Blob> packet = m_client->receive (4000);
+        BOOST_REQUIRE (packet);
+        Ptr<Data> data = Data::decodeFromWire (packet);
+        result[data->getName ().get (-1).toSeqNum ()] = data;
+
+        if (next < segments)
+          send (Name (name).appendSeqNum (next++));
+      }
+    return result;
+  }
+
+private:
+  void
+  send (const Name &name)
+  {
+    Interest interest (name);
+    BOOST_REQUIRE (m_client->send (*interest.encodeToWire ()));
+  }
+
+private:
+  test::MockListener m_listener;
+  Ptr<test::MockConnection> m_client;
+};
+
+static Blob
+createObject (size_t size)
+{
+  Blob object;
+  object.resize (size);
+  for (size_t i = 0; i < size; i++)
+    object[i] = static_cast<char> (i * 13 + i / 4096);
+  return object;
+}
+
+static Blob
+reassemble (const vector< Ptr<Data> > &segments, uint64_t finalSegment)
+{
+  Blob object;
+  for (size_t i = 0; i < segments.size (); i++)
+    {
+      BOOST_REQUIRE (segments[i]);
+      BOOST_CHECK_EQUAL (segments[i]->getContent ().getFinalBlockId ().toSeqNum (), finalSegment);
+      object.insert (object.end (), segments[i]->content ().begin (), segments[i]->content ().end ());
+    }
+  return object;
+}
+
+BOOST_AUTO_TEST_CASE (File)
+{
+  const size_t size = 8 * 1024 * 1024 + 1000;
+  Blob object = createObject (size);
+  string filePath = test::createTemporaryPath ("segmented-producer-test") + ".dat";
+  {
+    ofstream file (filePath.c_str (), ios::binary);
+    file.write (object.buf (), object.size ());
+  }
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Name prefix ("/mock/file");
+  Ptr<SegmentedProducer> producer (new SegmentedProducer (wrapper, prefix, filePath, 8192, 7));
+  BOOST_CHECK_EQUAL (producer->getName (), Name (prefix).appendVersion (7));
+  BOOST_CHECK_EQUAL (producer->getSize (), size);
+  BOOST_CHECK_EQUAL (producer->getSegmentCount (), 1025);
+  BOOST_REQUIRE_EQUAL (producer->start (), 0);
+  forwarder.waitForRegistration (prefix);
+
+  // Interest for the unversioned name is answered with the first segment
+  Ptr<Data> first = forwarder.get (prefix);
+  BOOST_REQUIRE (first);
+  BOOST_CHECK_EQUAL (first->getName (), Name (producer->getName ()).appendSeqNum (0));
+  BOOST_CHECK_EQUAL (first->getContent ().getFreshness (), seconds (Wrapper::DEFAULT_FRESHNESS));
+
+  ptime start = microsec_clock::universal_time ();
+  vector< Ptr<Data> > segments = forwarder.fetch (producer->getName (), producer->getSegmentCount (), 64);
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK (reassemble (segments, 1024) == object);
+  BOOST_CHECK_EQUAL (segments.back ()->content ().size (), 1000);
+
+  cout << "SegmentedProducer: " << size << "-byte file served in " << segments.size () << " segments in "
+       << duration.total_milliseconds () << "ms ("
+       << size / std::max<double> (duration.total_microseconds (), 1) << " MB/s)" << endl;
+
+  // Interests for other versions and for segments that do not exist are not answered
+  BOOST_CHECK (!forwarder.get (Name (prefix).appendVersion (8).appendSeqNum (0), 200));
+  BOOST_CHECK (!forwarder.get (Name (producer->getName ()).appendSeqNum (1025), 200));
+
+  producer->stop ();
+  wrapper->shutdown ();
+  unlink (filePath.c_str ());
+}
+
+BOOST_AUTO_TEST_CASE (Stream)
+{
+  Blob object = createObject (100000);
+  Ptr<std::istream> stream (new istringstream (string (object.buf (), object.size ())));
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Name prefix ("/mock/stream");
+  Ptr<SegmentedProducer> producer (new SegmentedProducer (wrapper, prefix, stream, 1000));
+  producer->setFreshness (5);
+  BOOST_CHECK_EQUAL (producer->getSegmentCount (), 100);
+  BOOST_REQUIRE_EQUAL (producer->start (), 0);
+  forwarder.waitForRegistration (prefix);
+
+  vector< Ptr<Data> > segments = forwarder.fetch (producer->getName (), producer->getSegmentCount (), 16);
+  BOOST_CHECK (reassemble (segments, 99) == object);
+  BOOST_CHECK_EQUAL (segments.front ()->getContent ().getFreshness (), seconds (5));
+
+  // the last segment is counted by the publish callback, which may run after it has been sent
+  for (int wait = 0; wait < 100 && producer->getPublishedSegments () < 100; wait++)
+    usleep (1000);
+  BOOST_CHECK_EQUAL (producer->getPublishedSegments (), 100);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (EmptyFile)
+{
+  string filePath = test::createTemporaryPath ("segmented-producer-test") + ".dat";
+  {
+    ofstream file (filePath.c_str (), ios::binary);
+  }
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Name prefix ("/mock/empty");
+  Ptr<SegmentedProducer> producer (new SegmentedProducer (wrapper, prefix, filePath));
+  BOOST_CHECK_EQUAL (producer->getSegmentCount (), 1);
+  BOOST_REQUIRE_EQUAL (producer->start (), 0);
+  forwarder.waitForRegistration (prefix);
+
+  Ptr<Data> data = forwarder.get (Name (producer->getName ()).appendSeqNum (0));
+  BOOST_REQUIRE (data);
+  BOOST_CHECK_EQUAL (data->content ().size (), 0);
+  BOOST_CHECK_EQUAL (data->getContent ().getFinalBlockId ().toSeqNum (), 0);
+
+  wrapper->shutdown ();
+  unlink (filePath.c_str ());
+
+  BOOST_CHECK_THROW (SegmentedProducer (wrapper, prefix, "/tmp/.ndn-cxx-does-not-exist"), Error::ndnOperation);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,512 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/wrapper/sharded-wrapper.h"
+#include "ndn.cxx/wrapper/closure.h"
+#include "ndn.cxx/transport/unix-transport.h"
+#include "mock-forwarder.h"
+
+#include <unistd.h>
+
+#include <set>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(ShardedWrapperTests)
+
+/**
+ * @brief Forwarder that accepts any number of connections, answers every Interest with Data of
+ *        the same name (each connection in its own thread), records registrations of every connection
+ *        and the names of Data that every connection has sent
+ */
+class MockForwarder
+{
+public:
+  MockForwarder ()
+    : m_listener ("sharded-wrapper-test", 16)
+    , m_running (true)
+    , m_dataCount (0)
+  {
+    m_threads.create_thread (boost::bind (&MockForwarder::acceptLoop, this));
+  }
+
+  ~MockForwarder ()
+  {
+    m_running = false;
+    m_threads.join_all ();
+  }
+
+  const std::string &
+  getPath () const
+  {
+    return m_listener.getPath ();
+  }
+
+  /**
+   * @brief Get prefixes registered by every connection
+   */
+  vector< set<Name> >
+  getRegistrations ()
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    return m_registrations;
+  }
+
+  /**
+   * @brief Wait up to timeoutMs until every connection has registered prefix
+   */
+  bool
+  waitRegistered (const Name &prefix, size_t connections, int timeoutMs)
+  {
+    for (int wait = 0; wait < timeoutMs; wait += 10)
+      {
+        {
+          boost::unique_lock<boost::mutex> lock (m_mutex);
+          size_t registered = 0;
+          for (size_t i = 0; i < m_registrations.size (); i++)
+            registered += m_registrations[i].count (prefix);
+          if (registered >= connections)
+            return true;
+        }
+        usleep (10000);
+      }
+    return false;
+  }
+
+  /**
+   * @brief Get names of Data that every connection has sent
+   */
+  vector< vector<Name> >
+  getData ()
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    return m_data;
+  }
+
+  /**
+   * @brief Wait up to timeoutMs until count Data packets have been received (from all connections together)
+   */
+  bool
+  waitData (size_t count, int timeoutMs)
+  {
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    while (m_dataCount < count)
+      {
+        if (!m_cond.timed_wait (lock, deadline))
+          return false;
+      }
+    return true;
+  }
+
+  /**
+   * @brief Send Interest to the connection
+   */
+  bool
+  express (size_t connection, const Interest &interest)
+  {
+    Ptr<test::MockConnection> client;
+    {
+      boost::unique_lock<boost::mutex> lock (m_mutex);
+      if (connection >= m_clients.size ())
+        return false;
+      client = m_clients[connection];
+    }
+
+    Ptr<Blob> packet = Interest (interest).encodeToWire ();
+    boost::unique_lock<boost::mutex> lock (m_sendMutex);
+    return client->send (*packet);
+  }
+
+  /**
+   * @brief Request prefix/<seq> for seq = 0..total-1, keeping window Interests outstanding and
+   *        sending them round-robin to the given connections
+   * @returns false if not all Data has been received within timeoutMs
+   */
+  bool
+  fetch (const Name &prefix, size_t connections, int total, int window, int timeoutMs)
+  {
+    size_t base;
+    {
+      boost::unique_lock<boost::mutex> lock (m_mutex);
+      base = m_dataCount;
+    }
+
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    for (int sent = 0; ; )
+      {
+        size_t received;
+        {
+          boost::unique_lock<boost::mutex> lock (m_mutex);
+          while (m_dataCount - base < static_cast<size_t> (total) &&
+                 (sent == total || static_cast<int> (m_dataCount - base) + window <= sent))
+            {
+              if (!m_cond.timed_wait (lock, deadline))
+                return false;
+            }
+          received = m_dataCount - base;
+        }
+        if (received >= static_cast<size_t> (total))
+          return true;
+
+        for (; sent < total && static_cast<int> (received) + window > sent; sent++)
+          {
+            if (!express (sent % connections, Interest (Name (prefix).appendSeqNum (sent))))
+              return false;
+          }
+      }
+  }
+
+private:
+  void
+  acceptLoop ()
+  {
+    while (m_running)
+      {
+        Ptr<test::MockConnection> client = m_listener.accept (10);
+        if (!client)
+          continue;
+
+        size_t connection;
+        {
+          boost::unique_lock<boost::mutex> lock (m_mutex);
+          connection = m_registrations.size ();
+          m_registrations.push_back (set<Name> ());
+          m_data.push_back (vector<Name> ());
+          m_clients.push_back (client);
+        }
+        m_threads.create_thread (boost::bind (&MockForwarder::serve, this, client, connection));
+      }
+  }
+
+  void
+  serve (Ptr<test::MockConnection> client, size_t connection)
+  {
+    Ptr<const wire::Format> format = wire::Format::ndnb ();
+    while (m_running)
+      {
+        wire::Framer::PacketList packets;
+        if (!client->read (10, packets))
+          break;
+
+        Blob output;
+        for (wire::Framer::PacketList::const_iterator packet = packets.begin (); packet != packets.end (); packet++)
+          {
+            const unsigned char *buf = reinterpret_cast<const unsigned char *> (packet->m_buf);
+            if (format->getPacketType (buf, packet->m_size) == wire::Format::DATA_PACKET)
+              {
+                Name name;
+                BOOST_REQUIRE (format->parseName (buf, packet->m_size, name));
+
+                boost::unique_lock<boost::mutex> lock (m_mutex);
+                m_data[connection].push_back (name);
+                m_dataCount ++;
+                m_cond.notify_all ();
+                continue;
+              }
+
+            Ptr<Interest> interest = Interest::decodeFromWire (packet->m_buf, packet->m_size);
+
+            const Name &name = interest->getName ();
+            if (name.getPrefix (UnixTransport::REGISTER_PREFIX.size ()) == UnixTransport::REGISTER_PREFIX)
+              {
+                boost::unique_lock<boost::mutex> lock (m_mutex);
+                m_registrations[connection].insert (name.getPrefix (name.size () - UnixTransport::REGISTER_PREFIX.size (),
+                                                                    UnixTransport::REGISTER_PREFIX.size ()));
+                continue;
+              }
+
+            Ptr<Blob> data = test::makeData (name);
+            output.insert (output.end (), data->begin (), data->end ());
+          }
+
+        if (!output.empty ())
+          {
+            boost::unique_lock<boost::mutex> lock (m_sendMutex);
+            if (!client->send (output))
+              break;
+          }
+      }
+  }
+
+private:
+  test::MockListener m_listener;
+  volatile bool m_running;
+  boost::thread_group m_threads;
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  vector< set<Name> > m_registrations;
+  vector< vector<Name> > m_data;
+  vector< Ptr<test::MockConnection> > m_clients;
+  size_t m_dataCount;
+  boost::mutex m_sendMutex; // serializes packets written to a connection by different threads
+};
+
+/**
+ * @brief Consumer that keeps a fixed number of interests outstanding until the requested number is satisfied
+ */
+class WindowedConsumer
+{
+public:
+  WindowedConsumer (ShardedWrapper &wrapper, int total)
+    : m_wrapper (wrapper)
+    , m_total (total)
+    , m_sent (0)
+    , m_received (0)
+  {
+    m_closure = Ptr<Closure> (new Closure (boost::bind (&WindowedConsumer::onData, this, _1),
+                                           boost::bind (&WindowedConsumer::onTimeout, this, _1, _2),
+                                           UnverifiedCallback ()));
+  }
+
+  bool
+  run (int window, int timeoutMs)
+  {
+    for (int i = 0; i < window; i++)
+      sendNext ();
+
+    boost::unique_lock<boost::mutex> lock (m_mutex);
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    while (m_received < m_total)
+      {
+        if (!m_cond.timed_wait (lock, deadline))
+          return false;
+      }
+    return true;
+  }
+
+private:
+  void
+  sendNext ()
+  {
+    int seq;
+    {
+      boost::unique_lock<boost::mutex> lock (m_mutex);
+      if (m_sent >= m_total)
+        return;
+      seq = m_sent ++;
+    }
+    m_wrapper.sendInterest (Ptr<Interest> (new Interest (Name ("/mock/data").appendSeqNum (seq))), m_closure);
+  }
+
+  void
+  onData (Ptr<Data>)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock (m_mutex);
+      m_received ++;
+      m_cond.notify_all ();
+    }
+    sendNext ();
+  }
+
+  void
+  onTimeout (Ptr<Closure>, Ptr<Interest> interest)
+  {
+    // retransmit
+    m_wrapper.sendInterest (Ptr<Interest> (new Interest (interest->getName ())), m_closure);
+  }
+
+private:
+  ShardedWrapper &m_wrapper;
+  Ptr<Closure> m_closure;
+  int m_total;
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  int m_sent;
+  int m_received;
+};
+
+static void
+ignoreInterest (Ptr<Interest>)
+{
+}
+
+static void
+answerInterest (ShardedWrapper *wrapper, Ptr<Interest> interest)
+{
+  wrapper->putToNdnd (*test::makeData (interest->getName ()));
+}
+
+BOOST_AUTO_TEST_CASE (Registrations)
+{
+  const int shards = 4;
+  const int prefixes = 64;
+
+  MockForwarder forwarder;
+  ShardedWrapper wrapper (shards, test::createKeychain (), boost::bind (test::createTransport, forwarder.getPath ()));
+  BOOST_CHECK_EQUAL (wrapper.getShardCount (), shards);
+
+  for (int i = 0; i < prefixes; i++)
+    {
+      Name prefix = Name ("/mock/prefix").appendSeqNum (i);
+      BOOST_REQUIRE_EQUAL (wrapper.setInterestFilter (prefix, ignoreInterest), 0);
+      BOOST_CHECK (wrapper.getShard (prefix) == wrapper.getShard (ShardedWrapper::hashName (prefix)));
+    }
+
+  vector< set<Name> > registrations;
+  size_t registered = 0;
+  for (int wait = 0; wait < 200 && registered < prefixes; wait++)
+    {
+      usleep (10000);
+      registrations = forwarder.getRegistrations ();
+      registered = 0;
+      for (size_t i = 0; i < registrations.size (); i++)
+        registered += registrations[i].size ();
+    }
+
+  // every prefix is registered exactly once, by one of the connections, and all connections get a share
+  BOOST_REQUIRE_EQUAL (registrations.size (), shards);
+  BOOST_CHECK_EQUAL (registered, prefixes);
+  set<Name> all;
+  for (size_t i = 0; i < registrations.size (); i++)
+    {
+      BOOST_CHECK_GT (registrations[i].size (), 0);
+      all.insert (registrations[i].begin (), registrations[i].end ());
+    }
+  BOOST_CHECK_EQUAL (all.size (), prefixes);
+
+  wrapper.shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Scaling)
+{
+  const int total = 20000;
+  const int window = 256;
+
+  MockForwarder forwarder;
+  for (int shards = 1; shards <= 4; shards *= 2)
+    {
+      ShardedWrapper wrapper (shards, test::createKeychain (), boost::bind (test::createTransport, forwarder.getPath ()));
+      WindowedConsumer consumer (wrapper, total);
+
+      ptime start = microsec_clock::universal_time ();
+      BOOST_CHECK (consumer.run (window, 20000));
+      time_duration duration = microsec_clock::universal_time () - start;
+
+      cout << "ShardedWrapper: " << shards << " shards, " << total << " Interest/Data exchanges in "
+           << duration.total_milliseconds () << "ms ("
+           << static_cast<int> (total * 1000000.0 / std::max<double> (duration.total_microseconds (), 1)) << " packets/s, "
+           << boost::thread::hardware_concurrency () << " cores)" << endl;
+
+      wrapper.shutdown ();
+    }
+}
+
+BOOST_AUTO_TEST_CASE (DataRouting)
+{
+  const int shards = 4;
+  const int prefixes = 16;
+
+  MockForwarder forwarder;
+  ShardedWrapper wrapper (shards, test::createKeychain (), boost::bind (test::createTransport, forwarder.getPath ()));
+
+  for (int i = 0; i < prefixes; i++)
+    BOOST_REQUIRE_EQUAL (wrapper.setInterestFilter (Name ("/mock/prefix").appendSeqNum (i), ignoreInterest), 0);
+  for (int i = 0; i < prefixes; i++)
+    BOOST_REQUIRE (forwarder.waitRegistered (Name ("/mock/prefix").appendSeqNum (i), 1, 2000));
+
+  // Data under a prefix goes out through the connection that registered it, even though the
+  // longer name would hash to another shard
+  for (int i = 0; i < prefixes; i++)
+    {
+      Name prefix = Name ("/mock/prefix").appendSeqNum (i);
+      BOOST_REQUIRE_EQUAL (wrapper.putToNdnd (*test::makeData (Name (prefix).append ("put"))), 0);
+
+      Ptr<Data> data = Create<Data> ();
+      data->setName (Name (prefix).append ("published"));
+      data->setContent (Content ("content", 7, Content::DATA));
+      BOOST_REQUIRE_EQUAL (wrapper.publishDataByIdentity (data, Name ()), 0);
+    }
+  BOOST_REQUIRE (forwarder.waitData (2 * prefixes, 2000));
+
+  vector< set<Name> > registrations = forwarder.getRegistrations ();
+  vector< vector<Name> > received = forwarder.getData ();
+  BOOST_REQUIRE_EQUAL (received.size (), shards);
+  for (size_t connection = 0; connection < received.size (); connection++)
+    {
+      for (size_t i = 0; i < received[connection].size (); i++)
+        {
+          const Name &name = received[connection][i];
+          BOOST_CHECK_MESSAGE (registrations[connection].count (name.getPrefix (name.size () - 1)) == 1,
+                               name << " is sent by connection " << connection << " that has not registered its prefix");
+        }
+    }
+
+  wrapper.shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (SharedFilter)
+{
+  const int shards = 4;
+  const int total = 256;
+  const Name prefix ("/mock/shared");
+
+  MockForwarder forwarder;
+  ShardedWrapper wrapper (shards, test::createKeychain (), boost::bind (test::createTransport, forwarder.getPath ()));
+
+  BOOST_REQUIRE_EQUAL (wrapper.setSharedInterestFilter (prefix, boost::bind (answerInterest, &wrapper, _1)), 0);
+  BOOST_REQUIRE (forwarder.waitRegistered (prefix, shards, 2000));
+  BOOST_CHECK_EQUAL (forwarder.getRegistrations ()[0].size (), 1);
+
+  // all Interests arrive through the first connection, the answers are spread over all of them by name hash
+  BOOST_REQUIRE (forwarder.fetch (prefix, 1, total, 32, 5000));
+
+  vector< vector<Name> > received = forwarder.getData ();
+  BOOST_REQUIRE_EQUAL (received.size (), shards);
+  size_t count = 0;
+  for (size_t connection = 0; connection < received.size (); connection++)
+    {
+      BOOST_CHECK_GT (received[connection].size (), 0);
+      for (size_t i = 0; i < received[connection].size (); i++)
+        BOOST_CHECK_EQUAL (ShardedWrapper::hashName (received[connection][i]) % shards, connection);
+      count += received[connection].size ();
+    }
+  BOOST_CHECK_EQUAL (count, total);
+
+  wrapper.clearInterestFilter (prefix);
+  wrapper.shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (ProducerScaling)
+{
+  const int total = 20000;
+  const int window = 256;
+  const Name prefix ("/mock/producer");
+
+  for (int shards = 1; shards <= 4; shards *= 2)
+    {
+      MockForwarder forwarder;
+      ShardedWrapper wrapper (shards, test::createKeychain (), boost::bind (test::createTransport, forwarder.getPath ()));
+      BOOST_REQUIRE_EQUAL (wrapper.setSharedInterestFilter (prefix, boost::bind (answerInterest, &wrapper, _1)), 0);
+      BOOST_REQUIRE (forwarder.waitRegistered (prefix, shards, 2000));
+
+      // like a forwarder with a single route, Interests come through one connection only
+      ptime start = microsec_clock::universal_time ();
+      BOOST_CHECK (forwarder.fetch (prefix, 1, total, window, 20000));
+      time_duration duration = microsec_clock::universal_time () - start;
+
+      cout << "ShardedWrapper: " << shards << " shards, " << total << " Interests answered in "
+           << duration.total_milliseconds () << "ms ("
+           << static_cast<int> (total * 1000000.0 / std::max<double> (duration.total_microseconds (), 1)) << " packets/s, "
+           << boost::thread::hardware_concurrency () << " cores)" << endl;
+
+      wrapper.shutdown ();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/transport/shm-transport.h"
+#include "ndn.cxx/wrapper/wrapper.h"
+#include "ndn.cxx/wrapper/closure.h"
+#include "mock-forwarder.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(ShmTransportTests)
+
+static void
+collect (list<Blob> *packets, const unsigned char *buf, size_t length)
+{
+  packets->push_back (Blob (buf, length));
+}
+
+BOOST_AUTO_TEST_CASE (Rings)
+{
+  Ptr<ShmTransport> first;
+  Ptr<ShmTransport> second;
+  ShmTransport::createPair (first, second, 4096);
+
+  list<Blob> receivedByFirst;
+  list<Blob> receivedBySecond;
+  first->connect (boost::bind (collect, &receivedByFirst, _1, _2));
+  second->connect (boost::bind (collect, &receivedBySecond, _1, _2));
+
+  // packets of different sizes wrap around the small ring many times, and fill it up
+  vector<Blob> sent;
+  for (int i = 0; i < 500; i++)
+    {
+      Ptr<Blob> packet = Interest (Name ("/shm").append (string (i % 300, 'x')).appendSeqNum (i)).encodeToWire ();
+      sent.push_back (*packet);
+      first->send (reinterpret_cast<const unsigned char *> (packet->buf ()), packet->size ());
+    }
+  BOOST_CHECK (first->isOutputPending ());
+
+  for (int round = 0; round < 1000 && receivedBySecond.size () < sent.size (); round++)
+    {
+      second->processEvents ();
+      first->processEvents ();
+    }
+  BOOST_CHECK (!first->isOutputPending ());
+
+  BOOST_REQUIRE_EQUAL (receivedBySecond.size (), sent.size ());
+  size_t i = 0;
+  for (list<Blob>::iterator packet = receivedBySecond.begin (); packet != receivedBySecond.end (); packet++, i++)
+    {
+      BOOST_CHECK (*packet == sent[i]);
+    }
+
+  // and the other direction
+  Ptr<Blob> reply = Interest (Name ("/shm/reply")).encodeToWire ();
+  second->send (reinterpret_cast<const unsigned char *> (reply->buf ()), reply->size ());
+  first->processEvents ();
+  BOOST_REQUIRE_EQUAL (receivedByFirst.size (), 1);
+  BOOST_CHECK (receivedByFirst.front () == *reply);
+
+  // the peer notices disconnect and cannot reconnect
+  second->disconnect ();
+  BOOST_CHECK_THROW (first->processEvents (), Error::ndnOperation);
+  BOOST_CHECK_THROW (first->connect (ShmTransport::ReceiveCallback ()), Error::ndnOperation);
+}
+
+static void
+collectAndThrow (list<Blob> *packets, const unsigned char *buf, size_t length)
+{
+  packets->push_back (Blob (buf, length));
+  if (packets->size () == 1)
+    throw std::runtime_error ("first packet is rejected");
+}
+
+BOOST_AUTO_TEST_CASE (CallbackException)
+{
+  Ptr<ShmTransport> first;
+  Ptr<ShmTransport> second;
+  ShmTransport::createPair (first, second, 4096);
+
+  list<Blob> received;
+  first->connect (ShmTransport::ReceiveCallback ());
+  second->connect (boost::bind (collectAndThrow, &received, _1, _2));
+
+  Ptr<Blob> rejected = Interest (Name ("/shm/rejected")).encodeToWire ();
+  Ptr<Blob> accepted = Interest (Name ("/shm/accepted")).encodeToWire ();
+  first->send (reinterpret_cast<const unsigned char *> (rejected->buf ()), rejected->size ());
+  first->send (reinterpret_cast<const unsigned char *> (accepted->buf ()), accepted->size ());
+
+  // packet is released even though the callback has thrown, so it is not delivered again
+  BOOST_CHECK_THROW (second->processEvents (), std::runtime_error);
+  second->processEvents ();
+  BOOST_REQUIRE_EQUAL (received.size (), 2);
+  BOOST_CHECK (received.front () == *rejected);
+  BOOST_CHECK (received.back () == *accepted);
+}
+
+static void
+acceptPeer (const string &path, Ptr<ShmTransport> *transport)
+{
+  *transport = ShmTransport::accept (path, ShmTransport::DEFAULT_RING_SIZE, 2000);
+}
+
+BOOST_AUTO_TEST_CASE (Attach)
+{
+  string path = test::createTemporaryPath ("shm-transport-test") + ".sock";
+
+  Ptr<ShmTransport> acceptor;
+  boost::thread thread (boost::bind (acceptPeer, path, &acceptor));
+
+  Ptr<ShmTransport> peer;
+  for (int attempt = 0; attempt < 100 && !peer; attempt++)
+    {
+      try
+        {
+          peer = ShmTransport::attach (path);
+        }
+      catch (Error::ndnOperation &e)
+        {
+          usleep (10000); // acceptor is not listening yet
+        }
+    }
+  thread.join ();
+  BOOST_REQUIRE (acceptor);
+  BOOST_REQUIRE (peer);
+
+  list<Blob> received;
+  acceptor->connect (boost::bind (collect, &received, _1, _2));
+  peer->connect (ShmTransport::ReceiveCallback ());
+
+  Ptr<Blob> packet = Interest (Name ("/shm/attach")).encodeToWire ();
+  peer->send (reinterpret_cast<const unsigned char *> (packet->buf ()), packet->size ());
+
+  // acceptor is woken up through its eventfd
+  pollfd fd = { acceptor->getFd (), POLLIN, 0 };
+  BOOST_REQUIRE_EQUAL (poll (&fd, 1, 1000), 1);
+  acceptor->processEvents ();
+  BOOST_REQUIRE_EQUAL (received.size (), 1);
+  BOOST_CHECK (received.front () == *packet);
+
+  // nothing more to receive, the descriptor is not readable anymore
+  BOOST_CHECK_EQUAL (poll (&fd, 1, 0), 0);
+}
+
+static void
+answer (Wrapper *producer, Ptr<Interest> interest)
+{
+  producer->putToNdnd (*test::makeData (interest->getName ()));
+}
+
+struct Consumer
+{
+  Consumer (Wrapper &wrapper, int total)
+    : wrapper (wrapper), total (total), sent (0), received (0)
+  {
+    closure = Ptr<Closure> (new Closure (boost::bind (&Consumer::onData, this, _1), TimeoutCallback (), UnverifiedCallback ()));
+  }
+
+  void
+  sendNext ()
+  {
+    int seq;
+    {
+      boost::unique_lock<boost::mutex> lock (mutex);
+      if (sent >= total)
+        return;
+      seq = sent ++;
+    }
+    wrapper.sendInterest (Ptr<Interest> (new Interest (Name ("/shm/data").appendSeqNum (seq))), closure);
+  }
+
+  void
+  onData (Ptr<Data>)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock (mutex);
+      received ++;
+      cond.notify_all ();
+    }
+    sendNext ();
+  }
+
+  bool
+  waitForAll (int timeoutMs)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    while (received < total)
+      {
+        if (!cond.timed_wait (lock, deadline))
+          return false;
+      }
+    return true;
+  }
+
+  Wrapper &wrapper;
+  Ptr<Closure> closure;
+  int total;
+  boost::mutex mutex;
+  boost::condition_variable cond;
+  int sent;
+  int received;
+};
+
+BOOST_AUTO_TEST_CASE (Wrappers)
+{
+  const int total = 20000;
+
+  Ptr<ShmTransport> producerTransport;
+  Ptr<ShmTransport> consumerTransport;
+  ShmTransport::createPair (producerTransport, consumerTransport);
+
+  Ptr<security::Keychain> keychain = test::createKeychain ();
+  Wrapper producer (keychain, producerTransport);
+  Wrapper consumer (keychain, consumerTransport);
+
+  BOOST_REQUIRE_EQUAL (producer.setInterestFilter (Name ("/shm/data"), boost::bind (answer, &producer, _1)), 0);
+  usleep (10000);
+
+  Consumer client (consumer, total);
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < 64; i++)
+    client.sendNext ();
+  BOOST_CHECK (client.waitForAll (20000));
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  cout << "ShmTransport: " << total << " Interest/Data exchanges between two wrappers in "
+       << duration.total_milliseconds () << "ms ("
+       << static_cast<int> (total * 1000000.0 / std::max<double> (duration.total_microseconds (), 1)) << " packets/s)" << endl;
+
+  consumer.shutdown ();
+  producer.shutdown ();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include "ndn.cxx/wrapper/signing-pipeline.h"
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/security/keychain.h"
+#include "ndn.cxx/security/identity/identity-manager.h"
+#include "ndn.cxx/security/identity/basic-identity-storage.h"
+#include "ndn.cxx/security/identity/simplekey-store.h"
+#include "ndn.cxx/security/policy/no-verify-policy-manager.h"
+#include "ndn.cxx/security/exception.h"
+
+#include <unistd.h>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(SigningPipelineTests)
+
+/**
+ * @brief Collects emitted packets and completions, tracks number of concurrent signing calls
+ */
+struct Recorder
+{
+  Recorder () : signing (0), maxSigning (0), completed (0), failed (0) { }
+
+  void
+  sign (Data &data)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock (mutex);
+      signing ++;
+      maxSigning = std::max (maxSigning, signing);
+    }
+
+    // later packets are signed faster, so they are ready before the earlier ones
+    int seq = boost::lexical_cast<int> (data.getName ().get (-1).toUri ());
+    usleep ((20 - seq % 20) * 100);
+
+    Ptr<signature::Sha256WithRsa> signature = Create<signature::Sha256WithRsa> ();
+    signature->setSignatureBits (Blob ("signature", 9));
+    data.setSignature (signature);
+
+    boost::unique_lock<boost::mutex> lock (mutex);
+    signing --;
+    if (seq % 7 == 3)
+      throw security::SecException ("signing failed");
+  }
+
+  int
+  emit (Ptr<const wire::IovecList> packet)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    emitted.push_back (Data::decodeFromWire (packet->flatten ())->getName ());
+    return 0;
+  }
+
+  void
+  complete (Ptr<Data> data, bool published)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    if (published)
+      completed ++;
+    else
+      failed ++;
+  }
+
+  boost::mutex mutex;
+  int signing;
+  int maxSigning;
+  int completed;
+  int failed;
+  vector<Name> emitted;
+};
+
+static Ptr<Data>
+makeData (int seq)
+{
+  Ptr<Data> data = Create<Data> ();
+  data->setName (Name ("/pipeline").append (boost::lexical_cast<string> (seq)));
+  data->setContent (Content ("content", 7, Content::DATA));
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE (Order)
+{
+  const int count = 100;
+
+  Recorder recorder;
+  {
+    SigningPipeline pipeline (4, 8, boost::bind (&Recorder::emit, &recorder, _1));
+    for (int i = 0; i < count; i++)
+      {
+        BOOST_CHECK (pipeline.submit (makeData (i),
+                                      boost::bind (&Recorder::sign, &recorder, _1),
+                                      boost::bind (&Recorder::complete, &recorder, _1, _2)));
+        BOOST_CHECK_LE (pipeline.getInFlight (), 8);
+      }
+    pipeline.shutdown ();
+    BOOST_CHECK_EQUAL (pipeline.getInFlight (), 0);
+    BOOST_CHECK (!pipeline.submit (makeData (count), boost::bind (&Recorder::sign, &recorder, _1)));
+  }
+
+  // packets are signed in parallel, but emitted in submission order, failed ones are skipped
+  BOOST_CHECK_GT (recorder.maxSigning, 1);
+  BOOST_CHECK_EQUAL (recorder.completed + recorder.failed, count);
+  BOOST_CHECK_EQUAL (recorder.emitted.size (), recorder.completed);
+
+  int expected = 0;
+  for (vector<Name>::iterator name = recorder.emitted.begin (); name != recorder.emitted.end (); name++, expected++)
+    {
+      if (expected % 7 == 3)
+        expected ++;
+      BOOST_CHECK_EQUAL (*name, makeData (expected)->getName ());
+    }
+}
+
+static void
+signWithKeychain (Ptr<security::Keychain> keychain, const Name &certificateName, Data &data)
+{
+  keychain->sign (data, certificateName);
+}
+
+static int
+countPacket (int *count, Ptr<const wire::IovecList> packet)
+{
+  (*count) ++; // emission is serialized by the pipeline
+  return 0;
+}
+
+/**
+ * @brief Temporary directory removed with everything in it on destruction
+ */
+struct TemporaryDirectory
+{
+  TemporaryDirectory ()
+    : m_path (boost::filesystem::temp_directory_path () / boost::filesystem::unique_path ("ndn-cxx-test-%%%%-%%%%-%%%%"))
+  {
+    boost::filesystem::create_directories (m_path);
+  }
+
+  ~TemporaryDirectory ()
+  {
+    boost::system::error_code error;
+    boost::filesystem::remove_all (m_path, error);
+  }
+
+  boost::filesystem::path m_path;
+};
+
+BOOST_AUTO_TEST_CASE (Benchmark)
+{
+  // identity and keys are created in a temporary key store, not in the one of the user
+  TemporaryDirectory keystore;
+  Ptr<security::IdentityManager> identityManager;
+  Ptr<security::IdentityCertificate> certificate;
+  try
+    {
+      identityManager = Ptr<security::IdentityManager> (
+        new security::IdentityManager (Ptr<security::IdentityStorage> (new security::BasicIdentityStorage (keystore.m_path.string ())),
+                                       Ptr<security::PrivatekeyStorage> (new security::SimpleKeyStore ((keystore.m_path / "keys").string ()))));
+
+      Name keyName = identityManager->createIdentity (Name ("/ndn-cxx-test/signing-pipeline"));
+      certificate = identityManager->selfSign (keyName);
+      identityManager->addCertificate (certificate);
+      identityManager->setDefaultCertificateForKey (*certificate);
+    }
+  catch (std::exception &e)
+    {
+      BOOST_WARN_MESSAGE (false, "Signing benchmark skipped, identity cannot be created: " << e.what ());
+      return;
+    }
+
+  Ptr<security::Keychain> keychain (new security::Keychain (identityManager,
+                                                            Ptr<security::NoVerifyPolicyManager>::Create (),
+                                                            Ptr<security::EncryptionManager> ()));
+
+  const int count = 200;
+  for (int workers = 1; workers <= 8; workers *= 2)
+    {
+      int emitted = 0;
+      ptime start = microsec_clock::universal_time ();
+      {
+        SigningPipeline pipeline (workers, 64, boost::bind (countPacket, &emitted, _1));
+        for (int i = 0; i < count; i++)
+          {
+            Ptr<Data> data = makeData (i);
+            data->content ().resize (8192, 'x');
+            pipeline.submit (data, boost::bind (signWithKeychain, keychain, certificate->getName (), _1));
+          }
+        pipeline.shutdown ();
+      }
+      time_duration duration = microsec_clock::universal_time () - start;
+      BOOST_CHECK_EQUAL (emitted, count);
+
+      cout << "SigningPipeline: " << workers << " workers signed " << count << " 8KB Data packets in "
+           << duration.total_milliseconds () << "ms ("
+           << count * 1000000.0 / std::max<int64_t> (duration.total_microseconds (), 1) << " packets/s)" << endl;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
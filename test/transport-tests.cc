@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/transport/unix-transport.h"
+#include "ndn.cxx/interest.h"
+#include "ndn.cxx/data.h"
+#include "ndn.cxx/error.h"
+#include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/wire/framer.h"
+#include "mock-forwarder.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace ndn;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(TransportTests)
+
+static void
+collect (list<Blob> *packets, const unsigned char *buf, size_t length)
+{
+  packets->push_back (Blob (buf, length));
+}
+
+BOOST_AUTO_TEST_CASE (Framing)
+{
+  Ptr<Blob> interest1 = Interest (Name ("/test/1")).encodeToWire ();
+  Ptr<Blob> interest2 = Interest (Name ("/test/2")).encodeToWire ();
+
+  Blob stream (*interest1);
+  stream.insert (stream.end (), interest2->begin (), interest2->end ());
+  const unsigned char *buf = reinterpret_cast<const unsigned char *> (stream.buf ());
+  Ptr<const wire::Format> ndnb = wire::Format::ndnb ();
+
+  BOOST_CHECK_EQUAL (ndnb->findPacketEnd (buf, stream.size ()), interest1->size ());
+  BOOST_CHECK_EQUAL (ndnb->findPacketEnd (buf + interest1->size (), interest2->size ()), interest2->size ());
+
+  // incomplete elements
+  for (size_t length = 0; length < interest1->size (); length++)
+    {
+      BOOST_CHECK_EQUAL (ndnb->findPacketEnd (buf, length), 0);
+    }
+
+  // closer without opening tag
+  const unsigned char closer[] = { 0x00 };
+  BOOST_CHECK_THROW (ndnb->findPacketEnd (closer, sizeof (closer)), error::wire::Ndnb);
+}
+
+static Ptr<Blob>
+encodeData (const Name &name, size_t payloadSize, Ptr<const wire::Format> format)
+{
+  Data data;
+  data.setName (name);
+  data.setContent (Content (0, 0));
+  data.content ().resize (payloadSize, 'c');
+
+  Ptr<signature::Sha256WithRsa> signature = Create<signature::Sha256WithRsa> ();
+  signature->setSignatureBits (Blob (string (128, 's').c_str (), 128));
+  KeyLocator keyLocator;
+  keyLocator.setType (KeyLocator::KEYNAME);
+  keyLocator.setKeyName (Name ("/test/key"));
+  signature->setKeyLocator (keyLocator);
+  data.setSignature (signature);
+  data.setWireFormat (format);
+  return data.encodeToWire ();
+}
+
+static Blob
+packetStream (Ptr<const wire::Format> format)
+{
+  Blob interest1;
+  format->encodeInterest (Interest (Name ("/test/1")), 1, interest1);
+  Blob interest2;
+  format->encodeInterest (Interest (Name ("/test/2")), 2, interest2);
+  Ptr<Blob> data = encodeData (Name ("/test/data"), 1000, format);
+
+  Blob stream (interest1);
+  stream.insert (stream.end (), data->begin (), data->end ());
+  stream.insert (stream.end (), interest2.begin (), interest2.end ());
+  return stream;
+}
+
+BOOST_AUTO_TEST_CASE (IncrementalFraming)
+{
+  Ptr<const wire::Format> formats[] = { wire::Format::ndnb (), wire::Format::tlv () };
+  for (size_t f = 0; f < sizeof (formats) / sizeof (formats[0]); f++)
+    {
+      Blob stream = packetStream (formats[f]);
+
+      // packets split at every possible chunk size, including byte by byte
+      size_t chunks[] = { 1, 2, 7, 100, stream.size () };
+      for (size_t c = 0; c < sizeof (chunks) / sizeof (chunks[0]); c++)
+        {
+          wire::Framer framer (formats[f], 65536);
+          list<Blob> packets;
+          for (size_t offset = 0; offset < stream.size (); offset += chunks[c])
+            {
+              wire::Framer::PacketList complete;
+              framer.append (stream.buf () + offset, min (chunks[c], stream.size () - offset), complete);
+              for (size_t i = 0; i < complete.size (); i++)
+                packets.push_back (Blob (complete[i].m_buf, complete[i].m_size));
+            }
+          BOOST_CHECK_EQUAL (framer.getPendingSize (), 0);
+
+          Blob concatenated;
+          for (list<Blob>::iterator packet = packets.begin (); packet != packets.end (); packet++)
+            concatenated.insert (concatenated.end (), packet->begin (), packet->end ());
+          BOOST_CHECK_EQUAL (packets.size (), 3);
+          BOOST_CHECK (concatenated == stream);
+        }
+
+      // all packets of a single read are decoded in one batch
+      wire::Framer framer (formats[f], 65536);
+      wire::Framer::PacketList complete;
+      framer.append (stream.buf (), stream.size () - 1, complete);
+      BOOST_CHECK_EQUAL (complete.size (), 2);
+      BOOST_CHECK_EQUAL (framer.getPendingSize (), stream.size () - 1 - (complete[1].m_buf + complete[1].m_size - complete[0].m_buf));
+
+      vector< Ptr<Interest> > interests;
+      vector< Ptr<Data> > data;
+      BOOST_CHECK_EQUAL (framer.decode (complete, interests, data), 0);
+      BOOST_REQUIRE_EQUAL (interests.size (), 1);
+      BOOST_REQUIRE_EQUAL (data.size (), 1);
+      BOOST_CHECK_EQUAL (interests[0]->getName (), Name ("/test/1"));
+      BOOST_CHECK_EQUAL (data[0]->getName (), Name ("/test/data"));
+      BOOST_CHECK_EQUAL (data[0]->content ().size (), 1000);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (FramingLimits)
+{
+  Ptr<const wire::Format> formats[] = { wire::Format::ndnb (), wire::Format::tlv () };
+  for (size_t f = 0; f < sizeof (formats) / sizeof (formats[0]); f++)
+    {
+      Ptr<Blob> large = encodeData (Name ("/test/large"), 100000, formats[f]);
+
+      // packet is rejected as soon as the header of the large block is received
+      wire::Framer framer (formats[f], 10000);
+      wire::Framer::PacketList packets;
+      size_t offset = 0;
+      try
+        {
+          for (; offset < large->size (); offset += 100)
+            framer.append (large->buf () + offset, min<size_t> (100, large->size () - offset), packets);
+          BOOST_ERROR ("packet larger than the limit has not been rejected");
+        }
+      catch (error::wire::Framer &)
+        {
+        }
+      BOOST_CHECK_LT (offset, 1000);
+      BOOST_CHECK (packets.empty ());
+
+      // packets up to the limit are accepted
+      wire::Framer unlimited (formats[f], large->size ());
+      unlimited.append (large->buf (), large->size (), packets);
+      BOOST_CHECK_EQUAL (packets.size (), 1);
+    }
+
+  // malformed stream
+  const unsigned char closer[] = { 0x00 };
+  wire::Framer framer (wire::Format::ndnb (), 10000);
+  wire::Framer::PacketList packets;
+  BOOST_CHECK_THROW (framer.append (closer, sizeof (closer), packets), error::wire::Ndnb);
+}
+
+BOOST_AUTO_TEST_CASE (FramingBenchmark)
+{
+  // large packet arriving in socket-sized reads: searching for the end from the beginning of
+  // the packet after every read scans it over and over, while the framer resumes the search
+  Blob stream;
+  for (int i = 0; i < 10; i++)
+    {
+      Ptr<Blob> data = encodeData (Name ("/test/large").appendSeqNum (i), 60000, wire::Format::ndnb ());
+      stream.insert (stream.end (), data->begin (), data->end ());
+    }
+  const size_t readSize = 1500;
+  const int iterations = 20;
+
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time ();
+  size_t rescanned = 0;
+  for (int i = 0; i < iterations; i++)
+    {
+      Blob input;
+      for (size_t offset = 0; offset < stream.size (); offset += readSize)
+        {
+          input.insert (input.end (), stream.begin () + offset, stream.begin () + min (offset + readSize, stream.size ()));
+          size_t length;
+          size_t consumed = 0;
+          while ((length = wire::Format::ndnb ()->findPacketEnd (reinterpret_cast<const unsigned char *> (input.buf ()) + consumed,
+                                                                 input.size () - consumed)) > 0)
+            {
+              consumed += length;
+              rescanned ++;
+            }
+          input.erase (input.begin (), input.begin () + consumed);
+        }
+    }
+  boost::posix_time::ptime rescan = boost::posix_time::microsec_clock::universal_time ();
+
+  size_t framed = 0;
+  for (int i = 0; i < iterations; i++)
+    {
+      wire::Framer framer (wire::Format::ndnb (), 65536);
+      wire::Framer::PacketList packets;
+      for (size_t offset = 0; offset < stream.size (); offset += readSize)
+        {
+          packets.clear ();
+          framer.append (stream.buf () + offset, min (readSize, stream.size () - offset), packets);
+          framed += packets.size ();
+        }
+    }
+  boost::posix_time::ptime incremental = boost::posix_time::microsec_clock::universal_time ();
+
+  BOOST_CHECK_EQUAL (rescanned, 10 * iterations);
+  BOOST_CHECK_EQUAL (framed, 10 * iterations);
+
+  cout << "Framing: " << stream.size () << " bytes in " << readSize << "-byte reads framed in "
+       << (rescan - start).total_microseconds () / iterations << "us by searching from the packet beginning, "
+       << (incremental - rescan).total_microseconds () / iterations << "us by the incremental framer" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (MockForwarder)
+{
+  test::MockListener listener ("transport-test");
+
+  list<Blob> received;
+  UnixTransport transport (listener.getPath ());
+  transport.connect (boost::bind (collect, &received, _1, _2));
+
+  Ptr<test::MockConnection> forwarder = listener.accept (1000);
+  BOOST_REQUIRE (forwarder);
+
+  // registration is requested with a special interest
+  transport.registerPrefix (Name ("/producer"));
+  BOOST_CHECK (transport.isOutputPending ());
+  transport.processEvents ();
+  BOOST_CHECK (!transport.isOutputPending ());
+  Ptr<Blob> packet = forwarder->receive (1000);
+  BOOST_REQUIRE (packet);
+  Ptr<Interest> registration = Interest::decodeFromWire (packet);
+  BOOST_CHECK_EQUAL (registration->getName (), Name (UnixTransport::REGISTER_PREFIX).append (Name ("/producer")));
+
+  // two packets in one write, second one split across two writes
+  Ptr<Blob> interest1 = Interest (Name ("/producer/1")).encodeToWire ();
+  Ptr<Blob> interest2 = Interest (Name ("/producer/2")).encodeToWire ();
+  Blob stream (*interest1);
+  stream.insert (stream.end (), interest2->begin (), interest2->end ());
+  stream.insert (stream.end (), interest1->begin (), interest1->end ());
+
+  BOOST_REQUIRE (forwarder->send (stream.buf (), stream.size () - 3));
+  transport.processEvents ();
+  BOOST_CHECK_EQUAL (received.size (), 2);
+
+  BOOST_REQUIRE (forwarder->send (stream.buf () + stream.size () - 3, 3));
+  transport.processEvents ();
+  BOOST_REQUIRE_EQUAL (received.size (), 3);
+  BOOST_CHECK (received.front () == *interest1);
+  BOOST_CHECK (*(++received.begin ()) == *interest2);
+
+  // forwarder is gone
+  forwarder.reset ();
+  BOOST_CHECK_THROW (transport.processEvents (), Error::ndnOperation);
+
+  transport.disconnect ();
+}
+
+BOOST_AUTO_TEST_CASE (PacketSizeLimit)
+{
+  test::MockListener listener ("transport-test", 2);
+
+  // segment with 1MB of payload is accepted by default
+  Ptr<Blob> large = encodeData (Name ("/test/large"), 1024 * 1024, wire::Format::ndnb ());
+
+  list<Blob> received;
+  UnixTransport transport (listener.getPath ());
+  transport.connect (boost::bind (collect, &received, _1, _2));
+  Ptr<test::MockConnection> forwarder = listener.accept (1000);
+  BOOST_REQUIRE (forwarder);
+
+  size_t written = 0;
+  while (written < large->size () || received.empty ())
+    {
+      if (written < large->size ())
+        {
+          ssize_t length = send (forwarder->getFd (), large->buf () + written, large->size () - written, MSG_DONTWAIT);
+          if (length > 0)
+            written += length;
+        }
+      transport.processEvents ();
+    }
+  BOOST_REQUIRE_EQUAL (received.size (), 1);
+  BOOST_CHECK (received.front () == *large);
+  forwarder.reset ();
+  transport.disconnect ();
+
+  // while a transport with a smaller limit drops the connection
+  UnixTransport limited (listener.getPath (), wire::Format::ndnb (), 65536);
+  limited.connect (boost::bind (collect, &received, _1, _2));
+  forwarder = listener.accept (1000);
+  BOOST_REQUIRE (forwarder);
+
+  BOOST_REQUIRE (forwarder->send (large->buf (), 1000));
+  BOOST_CHECK_THROW (limited.processEvents (), Error::ndnOperation);
+
+  limited.disconnect ();
+}
+
+BOOST_AUTO_TEST_CASE (Writev)
+{
+  test::MockListener listener ("transport-test");
+
+  list<Blob> received;
+  UnixTransport transport (listener.getPath ());
+  transport.connect (boost::bind (collect, &received, _1, _2));
+
+  Ptr<test::MockConnection> forwarder = listener.accept (1000);
+  BOOST_REQUIRE (forwarder);
+
+  // many packets with large referenced buffers, more than fits into the socket buffer
+  Blob payload;
+  payload.resize (1000000, 'p');
+  Blob expected;
+  for (int i = 0; i < 10; i++)
+    {
+      Ptr<wire::IovecList> packet = Create<wire::IovecList> ();
+      packet->getStream () << "header-" << i;
+      packet->appendReference (payload.buf (), payload.size () - i);
+      packet->appendCopy ("trailer", 7);
+      transport.send (packet);
+
+      Ptr<Blob> flat = packet->flatten ();
+      expected.insert (expected.end (), flat->begin (), flat->end ());
+    }
+
+  Blob stream;
+  char buf[65536];
+  while (stream.size () < expected.size ())
+    {
+      transport.processEvents ();
+      ssize_t length = read (forwarder->getFd (), buf, sizeof (buf));
+      BOOST_REQUIRE (length > 0);
+      stream.insert (stream.end (), buf, buf + length);
+    }
+  BOOST_CHECK (!transport.isOutputPending ());
+  BOOST_CHECK (stream == expected);
+
+  transport.disconnect ();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
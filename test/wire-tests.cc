@@ -12,15 +12,28 @@
 
 #include "ndn.cxx/interest.h"
 #include "ndn.cxx/data.h"
+#include "ndn.cxx/lazy-data.h"
 #include "ndn.cxx/error.h"
 
 #include "ndn.cxx/fields/content.h"
 #include "ndn.cxx/fields/blob.h"
 #include "ndn.cxx/fields/key-locator.h"
 #include "ndn.cxx/fields/signature-sha256-with-rsa.h"
+#include "ndn.cxx/wire/iovec-list.h"
+#include "ndn.cxx/wire/ndnb.h"
+#include "ndn.cxx/wire/ndnb/ndnb-reader.h"
+#include "ndn.cxx/wire/ndnb/ndnb-writer.h"
+#include "ndn.cxx/wire/ndnb/wire-ndnb-data.h"
+#include "ndn.cxx/wire/ndnb/wire-ndnb-interest.h"
 
 #include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 #include <fstream>
+#include <sstream>
 
 using namespace ndn;
 using namespace std;
@@ -96,4 +109,775 @@ BOOST_AUTO_TEST_CASE (DataTest)
   BOOST_CHECK_EQUAL (decodedContentStr, contentStr);
 }
 
+static Ptr<Data>
+createData (size_t payloadSize, size_t signatureSize)
+{
+  Ptr<Data> data = Create<Data> ();
+  data->setName (Name ("/ndn/data/iovec"));
+
+  Ptr<signature::Sha256WithRsa> sha256sig = Create<signature::Sha256WithRsa> ();
+  sha256sig->setSignatureBits (Blob (string (signatureSize, 's').c_str (), signatureSize));
+  sha256sig->setPublisherKeyDigest (Blob (string (32, 'd').c_str (), 32));
+
+  KeyLocator keyLocator;
+  keyLocator.setType (KeyLocator::KEYNAME);
+  keyLocator.setKeyName (Name ("/ndn/data/key/"));
+  sha256sig->setKeyLocator (keyLocator);
+  data->setSignature (sha256sig);
+
+  data->setContent (Content (0, 0, Content::DATA));
+  Blob &payload = data->content ();
+  payload.resize (payloadSize);
+  for (size_t i = 0; i < payloadSize; i++)
+    payload[i] = static_cast<char> (i);
+
+  return data;
+}
+
+static bool
+isReferenced (const wire::IovecList &list, const char *buf)
+{
+  const std::vector<iovec> &buffers = list.getIovec ();
+  for (std::vector<iovec>::const_iterator i = buffers.begin (); i != buffers.end (); i++)
+    {
+      if (i->iov_base == buf)
+        return true;
+    }
+  return false;
+}
+
+BOOST_AUTO_TEST_CASE (DataIovecTest)
+{
+  Ptr<Data> data = createData (100000, 256);
+
+  wire::IovecList list;
+  data->encodeToWire (list);
+  BOOST_CHECK (*list.flatten () == *data->encodeToWire ());
+  BOOST_CHECK_EQUAL (list.size (), data->encodeToWire ()->size ());
+
+  // payload and signature bits are referenced, not copied
+  BOOST_CHECK (isReferenced (list, data->content ().buf ()));
+  Ptr<signature::Sha256WithRsa> sha256sig = DynamicCast<signature::Sha256WithRsa> (data->getSignature ());
+  BOOST_CHECK (isReferenced (list, sha256sig->getSignatureBits ().buf ()));
+
+  wire::IovecList unsignedList;
+  data->encodeToUnsignedWire (unsignedList);
+  BOOST_CHECK (*unsignedList.flatten () == *data->encodeToUnsignedWire ());
+
+  // short signature is padded, small payload is copied
+  Ptr<Data> small = createData (10, 8);
+  wire::IovecList smallList;
+  small->encodeToWire (smallList);
+  BOOST_CHECK (*smallList.flatten () == *small->encodeToWire ());
+  BOOST_CHECK_EQUAL (smallList.getIovec ().size (), 1);
+
+  Ptr<Data> decoded = Data::decodeFromWire (list.flatten ());
+  BOOST_CHECK_EQUAL (decoded->getName (), data->getName ());
+  BOOST_CHECK (decoded->content () == data->content ());
+}
+
+BOOST_AUTO_TEST_CASE (DataFinalBlockIdTest)
+{
+  Ptr<Data> data = createData (1000, 256);
+  BOOST_CHECK (Data::decodeFromWire (data->encodeToWire ())->getContent ().getFinalBlockId () == Content::noFinalBlock);
+
+  data->getContent ().setFinalBlockId (name::Component::fromNumberWithMarker (42, 0x00));
+  data->resetWire ();
+
+  wire::IovecList list;
+  data->encodeToWire (list);
+  BOOST_CHECK (*list.flatten () == *data->encodeToWire ());
+
+  Ptr<Data> decoded = Data::decodeFromWire (data->encodeToWire ());
+  BOOST_CHECK_EQUAL (decoded->getContent ().getFinalBlockId ().toSeqNum (), 42);
+  BOOST_CHECK (decoded->content () == data->content ());
+}
+
+BOOST_AUTO_TEST_CASE (ParseNameTest)
+{
+  Name name ("/ndn/parse/name");
+  name.append (name::Component ()).appendSeqNum (7);
+
+  Interest interest (name);
+  Ptr<Blob> interestWire = interest.encodeToWire ();
+
+  Name parsed;
+  BOOST_REQUIRE (wire::Ndnb::parseName (reinterpret_cast<const unsigned char *> (interestWire->buf ()), interestWire->size (), parsed));
+  BOOST_CHECK_EQUAL (parsed, name);
+  BOOST_CHECK_EQUAL (Interest::decodeFromWire (interestWire->buf (), interestWire->size ())->getName (), name);
+
+  Ptr<Data> data = createData (1000, 256);
+  data->setName (name);
+  Ptr<Blob> dataWire = data->encodeToWire ();
+  const unsigned char *buf = reinterpret_cast<const unsigned char *> (dataWire->buf ());
+
+  parsed = Name ();
+  BOOST_REQUIRE (wire::Ndnb::parseName (buf, dataWire->size (), parsed));
+  BOOST_CHECK_EQUAL (parsed, name);
+
+  // decoded data does not reference the receive buffer
+  Blob received (*dataWire);
+  Ptr<Data> decoded = Data::decodeFromWire (received.buf (), received.size ());
+  std::fill (received.begin (), received.end (), 0);
+  BOOST_CHECK_EQUAL (decoded->getName (), name);
+  BOOST_CHECK (decoded->content () == data->content ());
+  BOOST_CHECK (*decoded->getSignedBlob () == *dataWire);
+
+  // packets truncated before the end of the name are rejected
+  for (size_t length = 0; length < dataWire->size (); length += 7)
+    {
+      Name truncated;
+      BOOST_CHECK (!wire::Ndnb::parseName (buf, length, truncated) || truncated == name);
+    }
+  BOOST_CHECK (!wire::Ndnb::parseName (buf, 100, parsed));
+
+  const int iterations = 10000;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Name peeked;
+      wire::Ndnb::parseName (buf, dataWire->size (), peeked);
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Data::decodeFromWire (buf, dataWire->size ());
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+  cout << "Name of 1000-byte data parsed in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns, full decode " << (end - middle).total_microseconds () * 1000 / iterations << "ns" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (ReaderTest)
+{
+  Interest interest (Name ("/ndn/reader").append (name::Component ()).appendSeqNum (3));
+  interest.setMinSuffixComponents (1);
+  interest.setMaxSuffixComponents (4);
+  interest.setChildSelector (Interest::CHILD_RIGHT);
+  interest.setScope (Interest::SCOPE_LOCAL_HOST);
+  interest.setInterestLifetime (time::Milliseconds (1500));
+  Ptr<Blob> interestWire = interest.encodeToWire ();
+
+  // tokens point into the buffer
+  wire::ndnb::Reader reader (interestWire->buf (), interestWire->size ());
+  wire::ndnb::Reader::Token token;
+  reader.next (token);
+  BOOST_CHECK_EQUAL (token.m_type, wire::NdnbParser::NDN_DTAG);
+  BOOST_CHECK_EQUAL (token.m_value, wire::NdnbParser::NDN_DTAG_Interest);
+  reader.readDtag (wire::NdnbParser::NDN_DTAG_Name);
+  reader.readDtag (wire::NdnbParser::NDN_DTAG_Component);
+  reader.peek (token);
+  BOOST_CHECK_EQUAL (token.m_type, wire::NdnbParser::NDN_BLOB);
+  reader.next (token);
+  BOOST_CHECK_EQUAL (string (reinterpret_cast<const char *> (token.m_data), token.m_size), "ndn");
+  BOOST_CHECK (token.m_data > reinterpret_cast<const unsigned char *> (interestWire->buf ()) &&
+               token.m_data < reinterpret_cast<const unsigned char *> (interestWire->buf ()) + interestWire->size ());
+  reader.skipRest (); // </Component>
+  reader.skipRest (); // rest of <Name>
+  while (!reader.atEnd ())
+    reader.next (token);
+  BOOST_CHECK_EQUAL (reader.getOffset (), interestWire->size ());
+
+  Ptr<Interest> decodedInterest = Interest::decodeFromWire (interestWire);
+  BOOST_CHECK (*decodedInterest == interest);
+
+  Ptr<Data> data = createData (1000, 256);
+  data->setName (Name ("/ndn/reader").appendSeqNum (5));
+  data->getContent ().setFinalBlockId (name::Component::fromNumberWithMarker (9, 0x00));
+  Ptr<Blob> dataWire = data->encodeToWire ();
+
+  Ptr<Data> decoded = Data::decodeFromWire (dataWire);
+  Ptr<signature::Sha256WithRsa> signature = DynamicCast<signature::Sha256WithRsa> (data->getSignature ());
+  Ptr<signature::Sha256WithRsa> decodedSignature = DynamicCast<signature::Sha256WithRsa> (decoded->getSignature ());
+  BOOST_REQUIRE (decodedSignature);
+  BOOST_CHECK_EQUAL (decoded->getName (), data->getName ());
+  BOOST_CHECK (decoded->content () == data->content ());
+  BOOST_CHECK_EQUAL (decoded->getContent ().getType (), Content::DATA);
+  BOOST_CHECK_EQUAL (decoded->getContent ().getFinalBlockId ().toSeqNum (), 9);
+  BOOST_CHECK (abs ((decoded->getContent ().getTimestamp () - data->getContent ().getTimestamp ()).total_microseconds ()) < 1000);
+  BOOST_CHECK (decodedSignature->getSignatureBits () == signature->getSignatureBits ());
+  BOOST_CHECK (decodedSignature->getPublisherKeyDigest () == signature->getPublisherKeyDigest ());
+  BOOST_CHECK_EQUAL (decodedSignature->getKeyLocator ().getKeyName (), signature->getKeyLocator ().getKeyName ());
+
+  // same result as the syntax-tree decoder
+  boost::iostreams::stream<boost::iostreams::array_source> is (dataWire->buf (), dataWire->size ());
+  Ptr<Data> treeDecoded = Create<Data> ();
+  treeDecoded->setSignature (Create<signature::Sha256WithRsa> ());
+  wire::ndnb::Data::Deserialize (treeDecoded, reinterpret_cast<ndn::InputIterator &> (is));
+  BOOST_CHECK_EQUAL (treeDecoded->getName (), decoded->getName ());
+  BOOST_CHECK (treeDecoded->content () == decoded->content ());
+  BOOST_CHECK (treeDecoded->getContent ().getFinalBlockId () == decoded->getContent ().getFinalBlockId ());
+  BOOST_CHECK (DynamicCast<signature::Sha256WithRsa> (treeDecoded->getSignature ())->getSignatureBits () ==
+               decodedSignature->getSignatureBits ());
+
+  // truncated and malformed packets are rejected
+  for (size_t length = 0; length < dataWire->size (); length++)
+    {
+      Data truncated;
+      BOOST_CHECK_THROW (wire::ndnb::Data::Decode (truncated, dataWire->buf (), length), wire::NdnbParser::NdnbDecodingException);
+    }
+  Blob malformed (*interestWire);
+  malformed[0] = 0;
+  BOOST_CHECK_THROW (Interest::decodeFromWire (malformed.buf (), malformed.size ()), wire::NdnbParser::NdnbDecodingException);
+
+  // benchmark against the syntax-tree decoder
+  const int iterations = 10000;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      boost::iostreams::stream<boost::iostreams::array_source> is (dataWire->buf (), dataWire->size ());
+      Ptr<Data> tree = Create<Data> ();
+      tree->setSignature (Create<signature::Sha256WithRsa> ());
+      wire::ndnb::Data::Deserialize (tree, reinterpret_cast<ndn::InputIterator &> (is));
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Data pulled;
+      wire::ndnb::Data::Decode (pulled, dataWire->buf (), dataWire->size ());
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+  cout << "1000-byte data decoded in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns by the syntax-tree decoder, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns by the pull parser" << endl;
+
+  start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      boost::iostreams::stream<boost::iostreams::array_source> is (interestWire->buf (), interestWire->size ());
+      wire::ndnb::Interest::Deserialize (Create<Interest> (), reinterpret_cast<ndn::InputIterator &> (is));
+    }
+  middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Interest pulled;
+      wire::ndnb::Interest::Decode (pulled, interestWire->buf (), interestWire->size ());
+    }
+  end = posix_time::microsec_clock::universal_time ();
+
+  cout << "Interest decoded in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns by the syntax-tree decoder, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns by the pull parser" << endl;
+}
+
+static Ptr<Blob>
+streamEncode (const Data &data)
+{
+  blob_stream os;
+  wire::ndnb::Data::Serialize (data, reinterpret_cast<ndn::OutputIterator &> (os));
+  return os.buf ();
+}
+
+static Ptr<Blob>
+writerEncode (const Data &data)
+{
+  Ptr<Blob> blob = Create<Blob> ();
+  blob->resize (wire::ndnb::Writer::EstimateData (data));
+  unsigned char *p = reinterpret_cast<unsigned char *> (&(*blob)[0]);
+  wire::ndnb::Writer::AppendData (p, data);
+  BOOST_CHECK_EQUAL (p - reinterpret_cast<unsigned char *> (&(*blob)[0]), blob->size ());
+  return blob;
+}
+
+static Ptr<Blob>
+writerEncode (const Interest &interest)
+{
+  Ptr<Blob> blob = Create<Blob> ();
+  blob->resize (wire::ndnb::Writer::EstimateInterest (interest));
+  unsigned char *p = reinterpret_cast<unsigned char *> (&(*blob)[0]);
+  wire::ndnb::Writer::AppendInterest (p, interest);
+  BOOST_CHECK_EQUAL (p - reinterpret_cast<unsigned char *> (&(*blob)[0]), blob->size ());
+  return blob;
+}
+
+BOOST_AUTO_TEST_CASE (WriterTest)
+{
+  uint32_t numbers[] = { 0, 7, 10, 99, 100, 12345, 1000000, 4294967295u };
+  for (size_t i = 0; i < sizeof (numbers) / sizeof (numbers[0]); i++)
+    {
+      unsigned char buf[16];
+      unsigned char *p = buf;
+      wire::ndnb::Writer::AppendNumber (p, numbers[i]);
+      BOOST_CHECK_EQUAL (p - buf, wire::ndnb::Writer::EstimateNumber (numbers[i]));
+      BOOST_CHECK_EQUAL (string (reinterpret_cast<char *> (buf) + 1, p - buf - 1), lexical_cast<string> (numbers[i]));
+    }
+
+  // same bytes as the stream-based encoders
+  Interest interest (Name ("/ndn/writer").append (name::Component ()).appendSeqNum (1000));
+  BOOST_CHECK (*writerEncode (interest) == *Interest (interest).encodeToWire ());
+  interest.setMinSuffixComponents (1);
+  interest.setMaxSuffixComponents (300);
+  interest.setChildSelector (Interest::CHILD_RIGHT);
+  interest.setAnswerOriginKind (Interest::AOK_STALE);
+  interest.setScope (Interest::SCOPE_LOCAL_HOST);
+  interest.setInterestLifetime (time::Milliseconds (1500));
+  blob_stream interestStream;
+  wire::ndnb::Interest::Serialize (interest, reinterpret_cast<ndn::OutputIterator &> (interestStream));
+  BOOST_CHECK (*writerEncode (interest) == *interestStream.buf ());
+
+  interest.getExclude ().excludeOne (name::Component ("a")).excludeAfter (name::Component ("z"));
+  blob_stream excludeStream;
+  wire::Ndnb::appendInterest (excludeStream, interest, true);
+  BOOST_CHECK (*writerEncode (interest) == *excludeStream.buf ());
+  BOOST_CHECK (*writerEncode (interest) == *interest.encodeToWire ());
+
+  size_t signatureSizes[] = { 0, 8, 16, 17, 256 };
+  for (size_t i = 0; i < sizeof (signatureSizes) / sizeof (signatureSizes[0]); i++)
+    {
+      Ptr<Data> data = createData (i * 500, signatureSizes[i]);
+      if (i % 2)
+        data->getContent ().setFinalBlockId (name::Component::fromNumberWithMarker (i, 0x00));
+      if (i % 3 == 1)
+        data->getContent ().setFreshness (posix_time::seconds (i * 10));
+      if (i % 3 == 2)
+        data->getContent ().setFreshness (Content::noFreshness);
+      if (i == 3)
+        data->getContent ().setType (Content::KEY);
+      BOOST_CHECK (*writerEncode (*data) == *streamEncode (*data));
+
+      // Type and FreshnessSeconds survive the round trip
+      Ptr<Data> decoded = Data::decodeFromWire (writerEncode (*data));
+      BOOST_CHECK_EQUAL (decoded->getContent ().getType (), data->getContent ().getType ());
+      BOOST_CHECK_EQUAL (decoded->getContent ().getFreshness (), data->getContent ().getFreshness ());
+
+      blob_stream unsignedStream;
+      wire::ndnb::Data::SerializeUnsigned (*data, reinterpret_cast<ndn::OutputIterator &> (unsignedStream));
+      BOOST_CHECK (*data->encodeToUnsignedWire () == *unsignedStream.buf ());
+
+      // signed portion is written as is
+      Ptr<Blob> unsignedData = data->encodeToUnsignedWire ();
+      Ptr<SignedBlob> signedBlob = Ptr<SignedBlob> (new SignedBlob (unsignedData->buf (), unsignedData->size ()));
+      signedBlob->setSignedPortion (0, unsignedData->size ());
+      data->setSignedBlob (signedBlob);
+      BOOST_CHECK (*writerEncode (*data) == *streamEncode (*data));
+      BOOST_CHECK (*data->encodeToWire () == *streamEncode (*data));
+    }
+
+  // benchmark against the stream-based encoders
+  Ptr<Data> data = createData (1000, 256);
+  const int iterations = 10000;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      streamEncode (*data);
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      writerEncode (*data); // encodeToWire would be served from the cached encoding
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+  cout << "1000-byte data encoded in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns by the stream encoder, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns by the single-allocation encoder" << endl;
+
+  start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      blob_stream os;
+      wire::Ndnb::appendInterest (os, interest, true);
+      os.buf ();
+    }
+  middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      interest.encodeToWire ();
+    }
+  end = posix_time::microsec_clock::universal_time ();
+
+  cout << "Interest encoded in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns by the stream encoder, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns by the single-allocation encoder" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (CachedWireTest)
+{
+  Ptr<Data> data = createData (100000, 256);
+  Ptr<Blob> fresh = writerEncode (*data);
+  Ptr<Blob> unsignedFresh = data->encodeToUnsignedWire ();
+
+  // const encodings do not fill the cache, so they can run in several threads at once
+  const Data &constData = *data;
+  BOOST_CHECK (*constData.encodeToWire () == *fresh);
+  wire::IovecList uncached;
+  constData.encodeToWire (uncached);
+  BOOST_CHECK (isReferenced (uncached, constData.content ().buf ()));
+
+  // first non-const encoding is cached, later encodings are served from it
+  Ptr<Blob> wire = data->encodeToWire ();
+  BOOST_CHECK (*wire == *fresh);
+  Ptr<Blob> again = data->encodeToWire ();
+  BOOST_CHECK (*again == *fresh);
+  BOOST_CHECK (again->buf () != wire->buf ()); // callers get their own copy
+  BOOST_CHECK (*data->encodeToUnsignedWire () == *unsignedFresh);
+
+  wire::IovecList list;
+  constData.encodeToWire (list);
+  BOOST_CHECK_EQUAL (list.getIovec ().size (), 1);
+  BOOST_CHECK (*list.flatten () == *fresh);
+  BOOST_CHECK (!isReferenced (list, constData.content ().buf ()));
+
+  wire::IovecList unsignedList;
+  constData.encodeToUnsignedWire (unsignedList);
+  BOOST_CHECK_EQUAL (unsignedList.getIovec ().size (), 1);
+  BOOST_CHECK (*unsignedList.flatten () == *unsignedFresh);
+
+  // setters drop the cached encoding, modifications through accessors need resetWire
+  data->setName (Name ("/ndn/data/renamed"));
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (data->encodeToWire ())->getName (), Name ("/ndn/data/renamed"));
+
+  data->content ()[0] = 'x';
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (data->encodeToWire ())->content ()[0], 0);
+  data->resetWire ();
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (data->encodeToWire ())->content ()[0], 'x');
+
+  data->getContent ().setFinalBlockId (name::Component::fromNumberWithMarker (3, 0x00));
+  data->resetWire ();
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (data->encodeToWire ())->getContent ().getFinalBlockId ().toSeqNum (), 3);
+
+  data->encodeToWire ();
+  Ptr<signature::Sha256WithRsa> signature = Create<signature::Sha256WithRsa> ();
+  signature->setSignatureBits (Blob (string (128, 'n').c_str (), 128));
+  signature->setKeyLocator (DynamicCast<signature::Sha256WithRsa> (data->getSignature ())->getKeyLocator ());
+  data->setSignature (signature);
+  BOOST_CHECK (*data->encodeToWire () == *writerEncode (*data));
+
+  // copies share the encoding until modified
+  Data copy (*data);
+  copy.setName (Name ("/ndn/data/copy"));
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (copy.encodeToWire ())->getName (), Name ("/ndn/data/copy"));
+  BOOST_CHECK_EQUAL (Data::decodeFromWire (data->encodeToWire ())->getName (), Name ("/ndn/data/renamed"));
+
+  const int iterations = 1000;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      wire::IovecList list;
+      wire::ndnb::Data::Serialize (constData, list);
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      wire::IovecList list;
+      constData.encodeToWire (list);
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+  cout << "100000-byte data re-sent in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns with encoding, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns from the cached encoding" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (SignedPortionTest)
+{
+  size_t sizes[] = { 0, 8, 16, 128, 256, 512 };
+  for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      Ptr<Data> data = createData (1000, sizes[i]);
+      Ptr<Blob> unsignedWire = data->encodeToUnsignedWire ();
+      Ptr<Blob> wire = data->encodeToWire ();
+
+      wire::ndnb::Data::Range signedPortion;
+      Data decodedData;
+      wire::ndnb::Data::Decode (decodedData, wire->buf (), wire->size (), signedPortion);
+      BOOST_CHECK (Blob (wire->buf () + signedPortion.m_offset, signedPortion.m_size) == *unsignedWire);
+
+      // signed portion of the received packet is located for any signature size
+      Ptr<const Data> decoded = Data::decodeFromWire (wire);
+      Ptr<const SignedBlob> signedBlob = decoded->getSignedBlob ();
+      BOOST_REQUIRE (signedBlob);
+      BOOST_CHECK (Blob (signedBlob->signed_begin (), signedBlob->signed_end ()) == *unsignedWire);
+      BOOST_CHECK (signedBlob->signed_buf () > signedBlob->buf () &&
+                   signedBlob->signed_buf () + signedBlob->signed_size () == signedBlob->buf () + signedBlob->size () - 1);
+
+      // received packet is re-sent as is, the signed portion is referenced from the same copy
+      wire::IovecList list;
+      decoded->encodeToWire (list);
+      BOOST_CHECK_EQUAL (list.getIovec ().size (), 1);
+      BOOST_CHECK (list.getIovec ()[0].iov_base == signedBlob->buf ());
+      BOOST_CHECK (*list.flatten () == *wire);
+
+      wire::IovecList unsignedList;
+      decoded->encodeToUnsignedWire (unsignedList);
+      BOOST_CHECK (unsignedList.getIovec ()[0].iov_base == signedBlob->signed_buf ());
+    }
+}
+
+static Ptr<Blob>
+fakeSign (const wire::IovecList &signedPortion, size_t size, Ptr<Blob> &seen)
+{
+  seen = signedPortion.flatten ();
+  BOOST_CHECK_EQUAL (signedPortion.getIovec ().size (), 1);
+
+  Ptr<Blob> bits = Create<Blob> ();
+  for (size_t i = 0; i < size; i++)
+    bits->push_back (static_cast<char> (seen->size () + i));
+  return bits;
+}
+
+BOOST_AUTO_TEST_CASE (SignInPlaceTest)
+{
+  size_t sizes[] = { 256, 128, 300, 8, 0 };
+  for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+      Ptr<Data> data = createData (10000, 0);
+      Ptr<Blob> unsignedWire = data->encodeToUnsignedWire ();
+
+      // signature is reserved for 256 bytes, other sizes are encoded again
+      Ptr<Blob> seen;
+      data->signInPlace (bind (fakeSign, _1, sizes[i], boost::ref (seen)), 256);
+      BOOST_REQUIRE (seen);
+      BOOST_CHECK (*seen == *unsignedWire);
+
+      // const access keeps the cached encoding
+      const Data &constData = *data;
+      Ptr<const signature::Sha256WithRsa> signature = DynamicCast<const signature::Sha256WithRsa> (constData.getSignature ());
+      BOOST_CHECK_EQUAL (signature->getSignatureBits ().size (), sizes[i]);
+
+      wire::IovecList list;
+      constData.encodeToWire (list);
+      BOOST_CHECK_EQUAL (list.getIovec ().size (), 1);
+      BOOST_CHECK (*list.flatten () == *writerEncode (constData));
+
+      Ptr<Data> decoded = Data::decodeFromWire (list.flatten ());
+      BOOST_CHECK (decoded->content () == constData.content ());
+      if (sizes[i] >= 16)
+        BOOST_CHECK (DynamicCast<signature::Sha256WithRsa> (decoded->getSignature ())->getSignatureBits () ==
+                     signature->getSignatureBits ());
+    }
+
+  // short signature fits the minimal (padded) space
+  Ptr<Data> data = createData (100, 0);
+  Ptr<Blob> seen;
+  data->signInPlace (bind (fakeSign, _1, 8, boost::ref (seen)), 0);
+  BOOST_CHECK (*data->encodeToWire () == *writerEncode (*data));
+
+  // one pass against signing the unsigned encoding and encoding again
+  data = createData (1000, 0);
+  const int iterations = 10000;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Ptr<Blob> unsignedWire = data->encodeToUnsignedWire ();
+      wire::IovecList signedPortion;
+      signedPortion.appendReference (unsignedWire->buf (), unsignedWire->size ());
+      DynamicCast<signature::Sha256WithRsa> (data->getSignature ())->setSignatureBits (*fakeSign (signedPortion, 256, seen));
+      writerEncode (*data);
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      data->signInPlace (bind (fakeSign, _1, 256, boost::ref (seen)), 256);
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+  cout << "1000-byte data signed and encoded in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns with two passes, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns in place (including the fake signer)" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (LazyDataTest)
+{
+  Ptr<Data> data = createData (1000, 256);
+  data->setName (Name ("/ndn/lazy").appendSeqNum (7));
+  data->getContent ().setFinalBlockId (name::Component::fromNumberWithMarker (9, 0x00));
+  Ptr<Blob> wire = data->encodeToWire ();
+
+  // field positions
+  wire::ndnb::Data::Layout layout;
+  wire::ndnb::Data::Scan (layout, wire->buf (), wire->size ());
+  BOOST_CHECK_EQUAL (layout.m_signatureBits.m_size, 256);
+  BOOST_CHECK (Blob (wire->buf () + layout.m_signatureBits.m_offset, layout.m_signatureBits.m_size) ==
+               DynamicCast<signature::Sha256WithRsa> (data->getSignature ())->getSignatureBits ());
+  BOOST_CHECK (Blob (wire->buf () + layout.m_content.m_offset, layout.m_content.m_size) == data->content ());
+  BOOST_CHECK_EQUAL (static_cast<size_t> (wire->buf ()[layout.m_signedPortion.m_offset + layout.m_signedPortion.m_size]),
+                     static_cast<size_t> (wire::NdnbParser::NDN_CLOSE));
+  BOOST_CHECK_EQUAL (layout.m_signedPortion.m_offset + layout.m_signedPortion.m_size + 1, wire->size ());
+  BOOST_CHECK_EQUAL (layout.m_signedPortion.m_offset, layout.m_name.m_offset);
+  BOOST_CHECK (layout.m_keyLocator.m_offset > layout.m_signedInfo.m_offset &&
+               layout.m_keyLocator.m_offset + layout.m_keyLocator.m_size < layout.m_signedInfo.m_offset + layout.m_signedInfo.m_size);
+
+  Ptr<Blob> unsignedWire = data->encodeToUnsignedWire ();
+  BOOST_CHECK (Blob (wire->buf () + layout.m_signedPortion.m_offset, layout.m_signedPortion.m_size) == *unsignedWire);
+
+  // fields are decoded independently, content bytes and wire need no decoding
+  Ptr<SignedBlob> signedWire = Ptr<SignedBlob> (new SignedBlob (wire->buf (), wire->size ()));
+  LazyData lazy (signedWire);
+  BOOST_CHECK (lazy.getWire () == signedWire);
+  BOOST_CHECK_EQUAL (lazy.contentSize (), 1000);
+  BOOST_CHECK (lazy.contentBuf () > signedWire->buf () && lazy.contentBuf () < signedWire->buf () + signedWire->size ());
+  BOOST_CHECK (Blob (lazy.contentBuf (), lazy.contentSize ()) == data->content ());
+  BOOST_CHECK_EQUAL (lazy.getName (), data->getName ());
+  BOOST_CHECK_EQUAL (lazy.getName (), data->getName ()); // decoded only once
+  BOOST_CHECK_EQUAL (lazy.getKeyLocator ().getKeyName (), Name ("/ndn/data/key/"));
+  BOOST_CHECK (lazy.getContent ().getContent () == data->content ());
+  BOOST_CHECK_EQUAL (lazy.getContent ().getFinalBlockId ().toSeqNum (), 9);
+
+  Ptr<const signature::Sha256WithRsa> signature = DynamicCast<const signature::Sha256WithRsa> (lazy.getSignature ());
+  BOOST_REQUIRE (signature);
+  BOOST_CHECK_EQUAL (signature->getPublisherKeyDigest ().size (), 32);
+  BOOST_CHECK_EQUAL (signature->getKeyLocator ().getKeyName (), Name ("/ndn/data/key/"));
+
+  // same result as the full decoder
+  Ptr<Data> decoded = Data::decodeFromWire (wire);
+  Ptr<Data> full = lazy.toData ();
+  BOOST_CHECK_EQUAL (full->getName (), decoded->getName ());
+  BOOST_CHECK (full->content () == decoded->content ());
+  BOOST_CHECK (full->getContent ().getTimestamp () == decoded->getContent ().getTimestamp ());
+  BOOST_CHECK_EQUAL (full->getContent ().getFinalBlockId ().toSeqNum (), decoded->getContent ().getFinalBlockId ().toSeqNum ());
+  BOOST_CHECK (DynamicCast<signature::Sha256WithRsa> (full->getSignature ())->getSignatureBits () ==
+               DynamicCast<signature::Sha256WithRsa> (decoded->getSignature ())->getSignatureBits ());
+  BOOST_CHECK (full->getSignedBlob () == signedWire); // shared, not copied
+  BOOST_CHECK (Blob (full->getSignedBlob ()->signed_begin (), full->getSignedBlob ()->signed_end ()) == *unsignedWire);
+  BOOST_CHECK (*full->encodeToWire () == *wire);
+
+  // every call returns a separate Data, modifications do not leak into the view or other copies
+  Ptr<Data> other = lazy.toData ();
+  BOOST_CHECK (other != full);
+  full->setName (Name ("/ndn/modified"));
+  DynamicCast<signature::Sha256WithRsa> (full->getSignature ())->getKeyLocator ().setKeyName (Name ("/modified/key"));
+  BOOST_CHECK_EQUAL (other->getName (), data->getName ());
+  BOOST_CHECK_EQUAL (lazy.getName (), data->getName ());
+  BOOST_CHECK_EQUAL (lazy.getKeyLocator ().getKeyName (), Name ("/ndn/data/key/"));
+  BOOST_CHECK (*other->encodeToWire () == *wire);
+
+  // malformed packets are rejected by the scan, not on access
+  BOOST_CHECK_THROW (LazyData (wire->buf (), wire->size () - 1), wire::NdnbParser::NdnbDecodingException);
+  BOOST_CHECK_THROW (LazyData (wire->buf (), 0), wire::NdnbParser::NdnbDecodingException);
+
+  // benchmark: name and content lookup against full decoding
+  const int iterations = 10000;
+  size_t total = 0;
+  posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Ptr<Data> copy = Data::decodeFromWire (wire);
+      total += copy->getName ().size () + copy->content ().size ();
+    }
+  posix_time::ptime middle = posix_time::microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      LazyData copy (signedWire);
+      total += copy.getName ().size () + copy.contentSize ();
+    }
+  posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+  BOOST_CHECK_EQUAL (total, 2 * iterations * (data->getName ().size () + 1000));
+
+  cout << "Name and content of 1000-byte data accessed in " << (middle - start).total_microseconds () * 1000 / iterations
+       << "ns after full decoding, " << (end - middle).total_microseconds () * 1000 / iterations
+       << "ns with lazy decoding" << endl;
+}
+
+BOOST_AUTO_TEST_CASE (StreamDecodeTest)
+{
+  Ptr<Data> data = createData (1000, 256);
+  Interest interest (Name ("/ndn/stream").appendSeqNum (1));
+  interest.setInterestLifetime (time::Milliseconds (1500));
+
+  // packets are read from the stream one by one, nothing past the end of the packet is consumed
+  stringstream stream;
+  interest.encodeToWire (stream);
+  data->encodeToWire (stream);
+  stream << "trailer";
+
+  Ptr<Interest> decodedInterest = Interest::decodeFromWire (stream);
+  BOOST_CHECK (*decodedInterest == interest);
+  Ptr<Data> decodedData = Data::decodeFromWire (stream);
+  BOOST_CHECK_EQUAL (decodedData->getName (), data->getName ());
+  BOOST_CHECK (decodedData->content () == data->content ());
+  BOOST_REQUIRE (decodedData->getSignedBlob ());
+  BOOST_CHECK (*decodedData->encodeToWire () == *data->encodeToWire ());
+
+  string rest;
+  stream >> rest;
+  BOOST_CHECK_EQUAL (rest, "trailer");
+
+  // stream ends in the middle of the packet
+  Ptr<Blob> wire = data->encodeToWire ();
+  stringstream truncated (string (wire->buf (), wire->size () - 1));
+  BOOST_CHECK_THROW (Data::decodeFromWire (truncated), error::wire::Framer);
+}
+
+struct DecodeJob
+{
+  const vector< Ptr<Blob> > *m_data;
+  const vector< Ptr<Blob> > *m_interests;
+  int m_iterations;
+  size_t m_components; // name components decoded by the thread
+};
+
+static void
+decodePackets (DecodeJob *job)
+{
+  // every thread decodes into its own objects, decoders share no state
+  for (int i = 0; i < job->m_iterations; i++)
+    {
+      for (size_t j = 0; j < job->m_data->size (); j++)
+        {
+          const Blob &dataWire = *(*job->m_data)[j];
+          Data data;
+          wire::ndnb::Data::Decode (data, dataWire.buf (), dataWire.size ());
+
+          const Blob &interestWire = *(*job->m_interests)[j];
+          Interest interest;
+          wire::ndnb::Interest::Decode (interest, interestWire.buf (), interestWire.size ());
+
+          job->m_components += data.getName ().size () + interest.getName ().size ();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE (ParallelDecodeBenchmark)
+{
+  vector< Ptr<Blob> > dataWires;
+  vector< Ptr<Blob> > interestWires;
+  size_t components = 0;
+  for (int i = 0; i < 100; i++)
+    {
+      Ptr<Data> data = createData (1000, 256);
+      data->setName (Name ("/ndn/parallel").appendSeqNum (i));
+      dataWires.push_back (data->encodeToWire ());
+
+      Interest interest (Name ("/ndn/parallel/interest").appendSeqNum (i));
+      interest.setInterestLifetime (time::Milliseconds (1500));
+      interestWires.push_back (interest.encodeToWire ());
+
+      components += data->getName ().size () + interest.getName ().size ();
+    }
+
+  // same amount of work per thread, so with linear scaling wall time stays the same
+  const int iterations = 100;
+  size_t threadCounts[] = { 1, 2, 4, 8 };
+  double singleThreadRate = 0;
+  for (size_t t = 0; t < sizeof (threadCounts) / sizeof (threadCounts[0]); t++)
+    {
+      vector<DecodeJob> jobs (threadCounts[t]);
+      thread_group threads;
+      posix_time::ptime start = posix_time::microsec_clock::universal_time ();
+      for (size_t i = 0; i < jobs.size (); i++)
+        {
+          DecodeJob job = { &dataWires, &interestWires, iterations, 0 };
+          jobs[i] = job;
+          threads.create_thread (boost::bind (decodePackets, &jobs[i]));
+        }
+      threads.join_all ();
+      posix_time::ptime end = posix_time::microsec_clock::universal_time ();
+
+      for (size_t i = 0; i < jobs.size (); i++)
+        BOOST_CHECK_EQUAL (jobs[i].m_components, iterations * components);
+
+      double rate = 2.0 * dataWires.size () * iterations * jobs.size () * 1000000 / max<int64_t> (1, (end - start).total_microseconds ());
+      if (t == 0)
+        singleThreadRate = rate;
+
+      cout << threadCounts[t] << " threads decoded " << 2 * dataWires.size () * iterations * jobs.size ()
+           << " packets in " << (end - start).total_milliseconds () << "ms (" << static_cast<int64_t> (rate)
+           << " packets/s, " << rate / singleThreadRate << "x of a single thread, "
+           << thread::hardware_concurrency () << " cores)" << endl;
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
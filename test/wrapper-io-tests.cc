@@ -0,0 +1,807 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *                     Alexander Afanasyev
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+
+#include "ndn.cxx/wrapper/wrapper.h"
+#include "ndn.cxx/wrapper/closure.h"
+#include "ndn.cxx/transport/unix-transport.h"
+#include "ndn.cxx/wire/ndnb.h"
+#include "mock-forwarder.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <sstream>
+
+using namespace ndn;
+using namespace std;
+using namespace boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE(WrapperIoTests)
+
+/**
+ * @brief Forwarder that answers every Interest with Data of the same name (followed by
+ *        dataSuffix) after answerDelay milliseconds, and counts received Interests and Data
+ */
+class MockForwarder
+{
+public:
+  MockForwarder (const Name &dataSuffix = Name (), int answerDelay = 0)
+    : m_listener ("wrapper-io-test")
+    , m_dataSuffix (dataSuffix)
+    , m_answerDelay (answerDelay)
+    , m_running (true)
+    , m_receivedInterests (0)
+    , m_receivedData (0)
+  {
+    m_thread = boost::thread (&MockForwarder::run, this);
+  }
+
+  ~MockForwarder ()
+  {
+    m_running = false;
+    m_thread.join ();
+  }
+
+  const string &
+  getPath () const
+  {
+    return m_listener.getPath ();
+  }
+
+  int
+  getReceivedInterests () const
+  {
+    return m_receivedInterests;
+  }
+
+  int
+  getReceivedData () const
+  {
+    return m_receivedData;
+  }
+
+private:
+  void
+  run ()
+  {
+    Ptr<test::MockConnection> client;
+    while (m_running && !client)
+      client = m_listener.accept (10);
+    if (!m_running)
+      return;
+
+    std::deque< std::pair<ptime, Ptr<Blob> > > answers;
+    wire::Framer::PacketList packets;
+    while (m_running)
+      {
+        // answers are written when they are due, without blocking the reading of interests
+        ptime now = microsec_clock::universal_time ();
+        while (!answers.empty () && answers.front ().first <= now)
+          {
+            if (!client->send (*answers.front ().second))
+              break;
+            answers.pop_front ();
+          }
+
+        packets.clear ();
+        if (!client->read (answers.empty () ? 10 : 1, packets))
+          break;
+
+        for (wire::Framer::PacketList::const_iterator packet = packets.begin (); packet != packets.end (); packet++)
+          {
+            if (wire::Format::ndnb ()->getPacketType (packet->m_buf, packet->m_size) == wire::Format::DATA_PACKET)
+              {
+                m_receivedData ++;
+                continue;
+              }
+
+            Ptr<Interest> interest = Interest::decodeFromWire (packet->m_buf, packet->m_size);
+            if (interest->getName ().size () >= UnixTransport::REGISTER_PREFIX.size () &&
+                interest->getName ().getPrefix (UnixTransport::REGISTER_PREFIX.size ()) == UnixTransport::REGISTER_PREFIX)
+              continue;
+
+            m_receivedInterests ++;
+            answers.push_back (std::make_pair (now + milliseconds (m_answerDelay),
+                                               test::makeData (Name (interest->getName ()).append (m_dataSuffix))));
+          }
+      }
+  }
+
+private:
+  test::MockListener m_listener;
+  Name m_dataSuffix;
+  int m_answerDelay;
+  volatile bool m_running;
+  volatile int m_receivedInterests;
+  volatile int m_receivedData;
+  boost::thread m_thread;
+};
+
+struct Consumer
+{
+  Consumer () : data (0), timeouts (0) { }
+
+  Ptr<Closure>
+  createClosure ()
+  {
+    return Ptr<Closure> (new Closure (boost::bind (&Consumer::onData, this, _1),
+                                      boost::bind (&Consumer::onTimeout, this, _1, _2),
+                                      boost::bind (&Consumer::onData, this, _1)));
+  }
+
+  void
+  onData (Ptr<Data> )
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    data ++;
+    cond.notify_all ();
+  }
+
+  void
+  onTimeout (Ptr<Closure>, Ptr<Interest>)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    timeouts ++;
+    cond.notify_all ();
+  }
+
+  bool
+  waitFor (int count, int timeoutMs)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    boost::system_time deadline = boost::get_system_time () + boost::posix_time::milliseconds (timeoutMs);
+    while (data + timeouts < count)
+      {
+        if (!cond.timed_wait (lock, deadline))
+          return false;
+      }
+    return true;
+  }
+
+  boost::mutex mutex;
+  boost::condition_variable cond;
+  int data;
+  int timeouts;
+};
+
+static double
+cpuSeconds ()
+{
+  rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+BOOST_AUTO_TEST_CASE (Latency)
+{
+  const int iterations = 1000;
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  Consumer consumer;
+  Ptr<Closure> closure (new Closure (boost::bind (&Consumer::onData, &consumer, _1),
+                                     boost::bind (&Consumer::onTimeout, &consumer, _1, _2),
+                                     boost::bind (&Consumer::onData, &consumer, _1)));
+
+  // one interest at a time, so every exchange includes a wakeup of the I/O thread
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      Ptr<Interest> interest (new Interest (Name ("/mock/latency")));
+      interest->getName ().appendSeqNum (i);
+      BOOST_REQUIRE_EQUAL (wrapper->sendInterest (interest, closure), 0);
+      BOOST_REQUIRE (consumer.waitFor (i + 1, 4000));
+    }
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK_EQUAL (consumer.data, iterations);
+  BOOST_CHECK_EQUAL (consumer.timeouts, 0);
+
+  cout << "Wrapper: " << iterations << " sequential Interest/Data exchanges, average round trip "
+       << duration.total_microseconds () / iterations << "us" << endl;
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (InterestTemplate)
+{
+  const int iterations = 1000;
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  Consumer consumer;
+  Ptr<Closure> closure (new Closure (boost::bind (&Consumer::onData, &consumer, _1),
+                                     boost::bind (&Consumer::onTimeout, &consumer, _1, _2),
+                                     boost::bind (&Consumer::onData, &consumer, _1)));
+
+  // prefix and selectors are encoded once, every send only writes the segment number
+  Interest prefix (Name ("/mock/template"));
+  prefix.setInterestLifetime (4.0);
+  Ptr<wire::InterestTemplate> interestTemplate = wrapper->createInterestTemplate (prefix);
+
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < iterations; i++)
+    {
+      BOOST_REQUIRE_EQUAL (wrapper->sendInterest (*interestTemplate, Name ().appendSeqNum (i), closure), 0);
+    }
+  BOOST_REQUIRE (consumer.waitFor (iterations, 8000));
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK_EQUAL (consumer.data, iterations);
+  BOOST_CHECK_EQUAL (consumer.timeouts, 0);
+
+  cout << "Wrapper: " << iterations << " pipelined Interests from a template answered in "
+       << duration.total_milliseconds () << "ms" << endl;
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Aggregation)
+{
+  // answers are delayed, so all interests are sent while the first one is still pending
+  MockForwarder forwarder (Name (), 200);
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Interest interest (Name ("/mock/aggregate"));
+  interest.setInterestLifetime (2.0);
+
+  Consumer consumers[6];
+
+  // identical interests (with different nonces) are sent upstream once
+  for (int i = 0; i < 3; i++)
+    {
+      BOOST_REQUIRE_EQUAL (wrapper->sendInterest (Ptr<Interest> (new Interest (interest)), consumers[i].createClosure ()), 0);
+    }
+  Ptr<wire::InterestTemplate> interestTemplate = wrapper->createInterestTemplate (interest);
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (*interestTemplate, Name (), consumers[3].createClosure ()), 0);
+
+  // interests with other selectors or lifetime are not merged
+  Ptr<Interest> otherSelectors (new Interest (interest));
+  otherSelectors->setMinSuffixComponents (1);
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (otherSelectors, consumers[4].createClosure ()), 0);
+
+  Ptr<Interest> otherLifetime (new Interest (interest));
+  otherLifetime->setInterestLifetime (3.0);
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (otherLifetime, consumers[5].createClosure ()), 0);
+
+  // every closure gets the data once
+  for (int i = 0; i < 6; i++)
+    {
+      BOOST_REQUIRE (consumers[i].waitFor (1, 4000));
+    }
+  // data for the other interests is dropped, as nothing is pending anymore
+  boost::this_thread::sleep (boost::posix_time::milliseconds (100));
+
+  BOOST_CHECK_EQUAL (forwarder.getReceivedInterests (), 3);
+  for (int i = 0; i < 6; i++)
+    {
+      BOOST_CHECK_EQUAL (consumers[i].data, 1);
+      BOOST_CHECK_EQUAL (consumers[i].timeouts, 0);
+    }
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (StaggeredLifetimes)
+{
+  // forwarder does not answer within the test, so both closures time out
+  MockForwarder forwarder (Name (), 10000);
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Interest interest (Name ("/mock/staggered"));
+  interest.setInterestLifetime (0.4);
+
+  Consumer early;
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (Ptr<Interest> (new Interest (interest)), early.createClosure ()), 0);
+  usleep (300000);
+
+  // identical interest sent later is aggregated, but still waits for its full lifetime
+  Consumer late;
+  ptime lateStart = microsec_clock::universal_time ();
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (Ptr<Interest> (new Interest (interest)), late.createClosure ()), 0);
+
+  BOOST_REQUIRE (early.waitFor (1, 2000));
+  BOOST_REQUIRE (late.waitFor (1, 2000));
+  time_duration lateWait = microsec_clock::universal_time () - lateStart;
+
+  BOOST_CHECK_EQUAL (early.timeouts, 1);
+  BOOST_CHECK_EQUAL (late.timeouts, 1);
+  BOOST_CHECK_GE (lateWait.total_milliseconds (), 350);
+  // the extended interest is expressed upstream again
+  BOOST_CHECK_EQUAL (forwarder.getReceivedInterests (), 2);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Selectors)
+{
+  MockForwarder forwarder (Name ("/v2"));
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  // interests differ only in Exclude, data /mock/selectors/v2 satisfies only the one without it
+  Consumer excluding;
+  Ptr<Interest> excludingInterest (new Interest (Name ("/mock/selectors")));
+  excludingInterest->setInterestLifetime (0.5);
+  excludingInterest->getExclude ().excludeOne (name::Component ("v2"));
+
+  Consumer accepting;
+  Ptr<Interest> acceptingInterest (new Interest (Name ("/mock/selectors")));
+  acceptingInterest->setInterestLifetime (0.5);
+
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (excludingInterest, excluding.createClosure ()), 0);
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (acceptingInterest, accepting.createClosure ()), 0);
+
+  BOOST_REQUIRE (accepting.waitFor (1, 2000));
+  BOOST_REQUIRE (excluding.waitFor (1, 2000));
+
+  BOOST_CHECK_EQUAL (accepting.data, 1);
+  BOOST_CHECK_EQUAL (accepting.timeouts, 0);
+  BOOST_CHECK_EQUAL (excluding.data, 0);
+  BOOST_CHECK_EQUAL (excluding.timeouts, 1);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (Timeout)
+{
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  Consumer consumer;
+  Ptr<Closure> closure (new Closure (boost::bind (&Consumer::onData, &consumer, _1),
+                                     boost::bind (&Consumer::onTimeout, &consumer, _1, _2),
+                                     boost::bind (&Consumer::onData, &consumer, _1)));
+
+  // mock forwarder does not answer registration requests
+  Ptr<Interest> interest (new Interest (Name (UnixTransport::REGISTER_PREFIX).append ("nothing")));
+  interest->setInterestLifetime (0.1);
+
+  // I/O thread sleeps until the expiration, so it has to be woken up for the new (earlier) deadline
+  ptime start = microsec_clock::universal_time ();
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (interest, closure), 0);
+  BOOST_REQUIRE (consumer.waitFor (1, 1000));
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  BOOST_CHECK_EQUAL (consumer.timeouts, 1);
+  BOOST_CHECK_LT (duration.total_milliseconds (), 500);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (IdleCpu)
+{
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  double start = cpuSeconds ();
+  usleep (1000000);
+  double used = cpuSeconds () - start;
+
+  // I/O thread should block while there is nothing to do (polling loop with 1ms timeout takes several percent of CPU)
+  cout << "Wrapper: " << used * 1000 << "ms of CPU time used in 1s of idling" << endl;
+  BOOST_CHECK_LT (used, 0.02);
+
+  wrapper->shutdown ();
+}
+
+static void
+publish (Ptr<Wrapper> wrapper, Ptr<Blob> data, int count, int *failures)
+{
+  for (int i = 0; i < count; i++)
+    {
+      if (wrapper->putToNdnd (*data) != 0)
+        (*failures) ++;
+    }
+}
+
+BOOST_AUTO_TEST_CASE (ConcurrentPut)
+{
+  const int threads = 4;
+  const int iterations = 20000;
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  Ptr<Blob> data = test::makeData (Name ("/mock/data"));
+
+  // producers do not take the wrapper lock, packets are queued and written out in batches by the I/O thread
+  int failures[threads] = { 0 };
+  ptime start = microsec_clock::universal_time ();
+  boost::thread_group producers;
+  for (int i = 0; i < threads; i++)
+    {
+      producers.create_thread (boost::bind (publish, wrapper, data, iterations, &failures[i]));
+    }
+  producers.join_all ();
+  time_duration queueing = microsec_clock::universal_time () - start;
+
+  for (int wait = 0; wait < 500 && forwarder.getReceivedData () < threads * iterations; wait++)
+    {
+      usleep (10000);
+    }
+  time_duration duration = microsec_clock::universal_time () - start;
+
+  for (int i = 0; i < threads; i++)
+    {
+      BOOST_CHECK_EQUAL (failures[i], 0);
+    }
+  BOOST_CHECK_EQUAL (forwarder.getReceivedData (), threads * iterations);
+
+  cout << "Wrapper: " << threads << " threads queued " << threads * iterations << " Data packets in "
+       << queueing.total_microseconds () << "us, delivered in " << duration.total_microseconds () << "us ("
+       << threads * iterations * 1000000.0 / std::max<int64_t> (duration.total_microseconds (), 1) << " packets/s)" << endl;
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (LargeData)
+{
+  const int count = 10; // stays below the default outbound limit
+  const size_t payloadSize = 1024 * 1024;
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+
+  Ptr<Signature> signature = Data::decodeFromWire (test::makeData (Name ("/mock/large")))->getSignature ();
+
+  // payload is referenced by the encoding and written to the socket directly from the Data
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < count; i++)
+    {
+      Ptr<Data> data = Create<Data> ();
+      data->setName (Name ("/mock/large"));
+      data->setSignature (signature);
+      data->setContent (Content (0, 0, Content::DATA));
+      data->content ().resize (payloadSize, 'x');
+
+      Ptr<wire::IovecList> packet = Create<wire::IovecList> ();
+      data->encodeToWire (*packet);
+      packet->keepAlive (data);
+      BOOST_CHECK_EQUAL (wrapper->putToNdnd (packet), 0);
+    }
+
+  for (int wait = 0; wait < 500 && forwarder.getReceivedData () < count; wait++)
+    {
+      usleep (10000);
+    }
+  time_duration duration = microsec_clock::universal_time () - start;
+  BOOST_CHECK_EQUAL (forwarder.getReceivedData (), count);
+
+  cout << "Wrapper: " << count << " Data packets with " << payloadSize << "-byte payload delivered in "
+       << duration.total_microseconds () << "us" << endl;
+
+  wrapper->shutdown ();
+}
+
+/**
+ * @brief Records order of Data callbacks of one closure, optionally spending some time in each
+ */
+struct OrderedConsumer
+{
+  OrderedConsumer (int delayUs) : delay (delayUs), running (0), overlapped (false) { }
+
+  void
+  onData (Ptr<Data> data)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock (mutex);
+      overlapped = overlapped || running > 0;
+      running ++;
+    }
+
+    usleep (delay);
+
+    boost::unique_lock<boost::mutex> lock (mutex);
+    running --;
+    received.push_back (data->getName ().get (-1).toSeqNum ());
+    finishedAt = microsec_clock::universal_time ();
+  }
+
+  int delay;
+  boost::mutex mutex;
+  int running;
+  bool overlapped;
+  vector<uint64_t> received;
+  ptime finishedAt;
+};
+
+BOOST_AUTO_TEST_CASE (Strands)
+{
+  const int count = 20;
+
+  MockForwarder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath (), 4);
+
+  OrderedConsumer slow (20000);
+  OrderedConsumer fast (0);
+  Ptr<Closure> slowClosure (new Closure (boost::bind (&OrderedConsumer::onData, &slow, _1), TimeoutCallback (), UnverifiedCallback ()));
+  Ptr<Closure> fastClosure (new Closure (boost::bind (&OrderedConsumer::onData, &fast, _1), TimeoutCallback (), UnverifiedCallback ()));
+
+  ptime start = microsec_clock::universal_time ();
+  for (int i = 0; i < count; i++)
+    {
+      BOOST_REQUIRE_EQUAL (wrapper->sendInterest (Ptr<Interest> (new Interest (Name ("/mock/slow").appendSeqNum (i))), slowClosure), 0);
+      BOOST_REQUIRE_EQUAL (wrapper->sendInterest (Ptr<Interest> (new Interest (Name ("/mock/fast").appendSeqNum (i))), fastClosure), 0);
+    }
+
+  for (int wait = 0; wait < 400; wait++)
+    {
+      {
+        boost::unique_lock<boost::mutex> lock (slow.mutex);
+        if (slow.received.size () == count)
+          break;
+      }
+      usleep (10000);
+    }
+
+  // callbacks of one closure are serialized and ordered, while the slow closure does not hold back the fast one
+  BOOST_REQUIRE_EQUAL (slow.received.size (), count);
+  BOOST_REQUIRE_EQUAL (fast.received.size (), count);
+  BOOST_CHECK (!slow.overlapped);
+  BOOST_CHECK (!fast.overlapped);
+  for (int i = 0; i < count; i++)
+    {
+      BOOST_CHECK_EQUAL (slow.received[i], i);
+      BOOST_CHECK_EQUAL (fast.received[i], i);
+    }
+  BOOST_CHECK_LT ((fast.finishedAt - start).total_milliseconds (), (slow.finishedAt - start).total_milliseconds () / 2);
+
+  cout << "Wrapper: fast flow finished in " << (fast.finishedAt - start).total_milliseconds ()
+       << "ms, slow flow in " << (slow.finishedAt - start).total_milliseconds () << "ms" << endl;
+
+  wrapper->shutdown ();
+}
+
+/**
+ * @brief Forwarder end of the connection that records prefix registrations of the wrapper
+ */
+class RegistrationRecorder
+{
+public:
+  RegistrationRecorder ()
+    : m_registrations (0)
+    , m_unregistrations (0)
+    , m_listener ("wrapper-io-test")
+  {
+  }
+
+  const string &
+  getPath () const
+  {
+    return m_listener.getPath ();
+  }
+
+  void
+  accept (int timeoutMs)
+  {
+    m_client = m_listener.accept (timeoutMs);
+    BOOST_REQUIRE (m_client);
+  }
+
+  void
+  disconnect ()
+  {
+    m_client.reset ();
+  }
+
+  /**
+   * @brief Read registrations until the connection is idle for timeoutMs
+   */
+  void
+  collect (int timeoutMs)
+  {
+    Ptr<Blob> packet;
+    while ((packet = m_client->receive (timeoutMs)))
+      {
+        Name name = Interest::decodeFromWire (packet->buf (), packet->size ())->getName ();
+        if (name.getPrefix (UnixTransport::REGISTER_PREFIX.size ()) == UnixTransport::REGISTER_PREFIX)
+          {
+            m_registrations ++;
+            m_registered.insert (name.getPrefix (name.size () - UnixTransport::REGISTER_PREFIX.size (), UnixTransport::REGISTER_PREFIX.size ()));
+          }
+        else if (name.getPrefix (UnixTransport::UNREGISTER_PREFIX.size ()) == UnixTransport::UNREGISTER_PREFIX)
+          {
+            m_unregistrations ++;
+            m_registered.erase (name.getPrefix (name.size () - UnixTransport::UNREGISTER_PREFIX.size (), UnixTransport::UNREGISTER_PREFIX.size ()));
+          }
+      }
+  }
+
+  void
+  sendInterest (const Name &name)
+  {
+    Interest interest (name);
+    send (*interest.encodeToWire ());
+  }
+
+  void
+  send (const Blob &wire)
+  {
+    BOOST_REQUIRE (m_client->send (wire));
+  }
+
+public:
+  set<Name> m_registered;
+  int m_registrations;
+  int m_unregistrations;
+
+private:
+  test::MockListener m_listener;
+  Ptr<test::MockConnection> m_client;
+};
+
+struct FilterLog
+{
+  void
+  onInterest (const string &filter, Ptr<Interest> interest)
+  {
+    boost::unique_lock<boost::mutex> lock (mutex);
+    received.push_back (filter + " " + interest->getName ().toUri ());
+  }
+
+  vector<string>
+  wait (size_t count, int timeoutMs)
+  {
+    for (int wait = 0; wait < timeoutMs / 10; wait++)
+      {
+        {
+          boost::unique_lock<boost::mutex> lock (mutex);
+          if (received.size () >= count)
+            break;
+        }
+        usleep (10000);
+      }
+    boost::unique_lock<boost::mutex> lock (mutex);
+    vector<string> result;
+    result.swap (received);
+    sort (result.begin (), result.end ());
+    return result;
+  }
+
+  boost::mutex mutex;
+  vector<string> received;
+};
+
+BOOST_AUTO_TEST_CASE (CoveringPrefix)
+{
+  const int count = 1000;
+
+  RegistrationRecorder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  forwarder.accept (2000);
+
+  FilterLog log;
+  BOOST_REQUIRE_EQUAL (wrapper->setCoveringPrefix (Name ("/svc")), 0);
+  for (int i = 0; i < count; i++)
+    {
+      Name prefix = Name ("/svc").appendSeqNum (i);
+      BOOST_REQUIRE_EQUAL (wrapper->setInterestFilter (prefix, boost::bind (&FilterLog::onInterest, &log, prefix.toUri (), _1)), 0);
+    }
+  wrapper->setInterestFilter (Name ("/svc/nested/deep"), boost::bind (&FilterLog::onInterest, &log, string ("deep"), _1));
+  wrapper->setInterestFilter (Name ("/svc/nested"), boost::bind (&FilterLog::onInterest, &log, string ("nested"), _1));
+  wrapper->setInterestFilter (Name ("/other"), boost::bind (&FilterLog::onInterest, &log, string ("other"), _1));
+  forwarder.collect (200);
+
+  // only the covering prefix and the filter outside of it are registered with the forwarder
+  BOOST_CHECK_EQUAL (forwarder.m_registrations, 2);
+  BOOST_CHECK (forwarder.m_registered.count (Name ("/svc")) > 0);
+  BOOST_CHECK (forwarder.m_registered.count (Name ("/other")) > 0);
+
+  // interests are dispatched locally to all matching filters, interests that match nothing are dropped
+  forwarder.sendInterest (Name ("/svc").appendSeqNum (7).append ("x"));
+  forwarder.sendInterest (Name ("/svc/nested/deep/x"));
+  forwarder.sendInterest (Name ("/svc/unknown"));
+  forwarder.sendInterest (Name ("/other/y"));
+  vector<string> received = log.wait (4, 2000);
+  BOOST_REQUIRE_EQUAL (received.size (), 4);
+  BOOST_CHECK_EQUAL (received[0], Name ("/svc").appendSeqNum (7).toUri () + " " + Name ("/svc").appendSeqNum (7).append ("x").toUri ());
+  BOOST_CHECK_EQUAL (received[1], "deep /svc/nested/deep/x");
+  BOOST_CHECK_EQUAL (received[2], "nested /svc/nested/deep/x");
+  BOOST_CHECK_EQUAL (received[3], "other /other/y");
+
+  // after reconnect only two registrations are restored
+  forwarder.disconnect ();
+  forwarder.m_registrations = 0;
+  forwarder.accept (5000);
+  forwarder.collect (200);
+  BOOST_CHECK_EQUAL (forwarder.m_registrations, 2);
+
+  forwarder.sendInterest (Name ("/svc").appendSeqNum (999));
+  BOOST_CHECK_EQUAL (log.wait (1, 2000).size (), 1);
+
+  // without the covering prefix, filters under it are registered individually
+  forwarder.m_registrations = 0;
+  wrapper->clearCoveringPrefix (Name ("/svc"));
+  forwarder.collect (200);
+  BOOST_CHECK_EQUAL (forwarder.m_registrations, count + 2);
+  BOOST_CHECK_EQUAL (forwarder.m_unregistrations, 1);
+  BOOST_CHECK_EQUAL (forwarder.m_registered.size (), count + 3);
+  BOOST_CHECK (forwarder.m_registered.count (Name ("/svc")) == 0);
+
+  // and are covered again
+  wrapper->setCoveringPrefix (Name ("/svc"));
+  forwarder.collect (200);
+  BOOST_CHECK_EQUAL (forwarder.m_registered.size (), 2);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_CASE (MalformedData)
+{
+  RegistrationRecorder forwarder;
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  forwarder.accept (2000);
+
+  Consumer consumer;
+  Ptr<Interest> interest (new Interest (Name ("/mock/malformed")));
+  interest->setInterestLifetime (1.0);
+  BOOST_REQUIRE_EQUAL (wrapper->sendInterest (interest, consumer.createClosure ()), 0);
+  forwarder.collect (200);
+
+  // Data with a valid name, but unknown content type is followed by good Data in the same read
+  Ptr<Blob> good = test::makeData (Name ("/mock/malformed"));
+  ostringstream os;
+  wire::Ndnb ().appendData (os, *Data::decodeFromWire (good));
+  string malformed = os.str ();
+  size_t type = malformed.find (string ("\x9D\x0C\x04\xC0", 4)); // BLOB with the type of DATA
+  BOOST_REQUIRE (type != string::npos);
+  malformed.replace (type + 1, 3, "\xFF\xFF\xFF");
+
+  Blob packets (malformed.data (), malformed.size ());
+  packets.insert (packets.end (), good->begin (), good->end ());
+  forwarder.send (packets);
+
+  // malformed packet is dropped, the next one satisfies the interest
+  BOOST_REQUIRE (consumer.waitFor (1, 2000));
+  BOOST_CHECK_EQUAL (consumer.data, 1);
+  BOOST_CHECK_EQUAL (consumer.timeouts, 0);
+
+  wrapper->shutdown ();
+}
+
+static void
+onBackpressure (size_t *reported, size_t queuedBytes)
+{
+  *reported = queuedBytes;
+}
+
+BOOST_AUTO_TEST_CASE (Backpressure)
+{
+  // forwarder that accepts connection, but never reads from it
+  test::MockListener forwarder ("wrapper-io-test");
+
+  Ptr<Wrapper> wrapper = test::createWrapper (forwarder.getPath ());
+  size_t reported = 0;
+  wrapper->setOutboundLimit (64 * 1024, boost::bind (onBackpressure, &reported, _1));
+
+  Ptr<Blob> data = test::makeData (Name ("/mock/data"));
+
+  // once socket buffer is full, the queue grows up to the limit
+  int accepted = 0;
+  while (accepted < 100000 && wrapper->putToNdnd (*data) == 0)
+    {
+      accepted ++;
+    }
+
+  BOOST_CHECK_LT (accepted, 100000);
+  BOOST_CHECK_GT (reported, 0);
+  BOOST_CHECK_LE (reported, 64 * 1024);
+
+  wrapper->shutdown ();
+}
+
+BOOST_AUTO_TEST_SUITE_END()